@@ -7,6 +7,8 @@
 #include <filesystem>
 #include <scip/scip.h>
 #include <scip/scipdefplugins.h>
+#include "mipworkshop2024/IO.h"
+#include "mipworkshop2024/BinaryProblem.h"
 SCIP_RETCODE runSCIP(const std::filesystem::path& inFile){
 	SCIP* scip = NULL;
 	/*********
@@ -55,11 +57,25 @@ bool doPresolve(const std::string& problemPath,
 	return true;
 }
 
+/// Converts a (compressed) MPS file to the binary problem format, so that later runs can skip parsing the text
+bool convertToBinary(const std::filesystem::path& problemPath, const std::filesystem::path& binaryPath){
+	auto problem = readMPSFile(problemPath);
+	if(!problem.has_value()){
+		std::cerr<<"Could not read problem file: "<<problemPath<<"\n";
+		return false;
+	}
+	return writeBinaryProblemFile(problem.value(),binaryPath);
+}
+
 int main(int argc, char** argv) {
 	std::vector<std::string> args(argv,argv+argc);
+	if(args.size() == 3 && std::filesystem::path(args[2]).extension() == BINARY_PROBLEM_EXTENSION){
+		return convertToBinary(args[1],args[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
 	if(args.size() != 4)
 	{
-		std::cerr<<"Not enough paths specified. Please specify an .mps.gz file, a filename to write the presolved model to and a folder for additional data!\n";
+		std::cerr<<"Not enough paths specified. Please specify an .mps.gz file, a filename to write the presolved model to and a folder for additional data!\n"
+		            "To convert a problem to the binary format, specify an .mps(.gz) file and a .bprob file to write to.\n";
 		return EXIT_FAILURE;
 	}
 	const std::string& fileName = args[1];
@@ -16,13 +16,13 @@ struct Configuration{
     std::string name;
     std::optional<TUSettings> settings;
 };
-std::optional<Problem> readProblem(const std::string &path) {
+std::optional<Problem> readProblem(const std::string &path, const MPSReadSettings& settings) {
 
     if (!std::filesystem::exists(path) || !std::filesystem::is_regular_file(path)) {
         std::cerr << "Input file: " << path << " does not exist!\n";
         return std::nullopt;
     }
-    auto problem = readMPSFile(path);
+    auto problem = readMPSFile(path, settings);
     if (!problem.has_value()) {
         std::cerr << "Could not read MPS file: " << path << "\n";
         return std::nullopt;
@@ -30,7 +30,25 @@ std::optional<Problem> readProblem(const std::string &path) {
     return problem;
 }
 
-bool processProblem(const Problem& problem, const std::filesystem::path& path, const Configuration& config){
+/// Writes the solution with the original column names; for problems read without names, these are loaded from the name file
+bool writeSolution(const Problem& problem, const Solution& solution, const std::filesystem::path& nameFile,
+                   const std::filesystem::path& solPath){
+    ExternalSolution external;
+    if(problem.hasNames()){
+        external = problem.convertSolution(solution);
+    }else{
+        auto names = readNameFile(nameFile);
+        if(!names.has_value()){
+            return false;
+        }
+        external = problem.convertSolution(solution, names->colNames);
+    }
+    std::ofstream logFile(solPath);
+    return solToStream(external, logFile);
+}
+
+bool processProblem(const Problem& problem, const std::filesystem::path& path, const Configuration& config,
+                    const std::filesystem::path& nameFile){
     double totalTimeLimit = 3600.0;
     ProblemLogData logData;
     if(!config.settings.has_value()){
@@ -59,8 +77,7 @@ bool processProblem(const Problem& problem, const std::filesystem::path& path, c
             solPath += "_";
             solPath += config.name;
             solPath += ".sol";
-            std::ofstream logFile(solPath);
-            if(!solToStream(normalSCIP->solution, logFile)){
+            if(!writeSolution(problem, convertedSol.value(), nameFile, solPath)){
                 std::cout << "Could not write solution!\n";
                 return false;
             }
@@ -75,7 +92,10 @@ bool processProblem(const Problem& problem, const std::filesystem::path& path, c
     }else{
         auto presolveStart = std::chrono::high_resolution_clock::now();
         Presolver presolver;
-        auto detectionStats = presolver.doPresolve(problem, config.settings.value());
+        //Bound the detection time, so that a difficult detection can not use up most of the time for solving
+        TUSettings settings = config.settings.value();
+        settings.timeLimit = std::min(settings.timeLimit, 0.1 * totalTimeLimit);
+        auto detectionStats = presolver.doPresolve(problem, settings);
         auto presolvedProblem = presolver.presolvedProblem();
         std::size_t numFoundColumns = 0;
         for(const auto& reduction : presolver.postSolveStack().reductions){
@@ -129,15 +149,13 @@ bool processProblem(const Problem& problem, const std::filesystem::path& path, c
                 result->statistics.primalBound = problem.computeObjective(convertedSol.value());
                 std::cout << "Recovered solution with objective: " << result->statistics.primalBound << "\n";
             }
-            auto convertedSoLExternal = problem.convertSolution(*convertedSol);
             auto solPath = path;
             solPath += "integratedSolutions/";
             solPath += problem.name;
             solPath += "_";
             solPath += config.name;
             solPath += ".sol";
-            std::ofstream logFile(solPath);
-            if (!solToStream(convertedSoLExternal, logFile)) {
+            if (!writeSolution(problem, convertedSol.value(), nameFile, solPath)) {
                 std::cout << "Could not write solution!\n";
                 return false;
             }
@@ -162,15 +180,22 @@ bool processProblem(const Problem& problem, const std::filesystem::path& path, c
 int main(int argc, char **argv) {
     std::vector<std::string> args(argv, argv + argc);
 
-    if (args.size() != 3) {
+    //With --nameless, the names are only kept in a name file in the output directory while solving
+    bool nameless = args.size() == 4 && args[3] == "--nameless";
+    if (args.size() != 3 && !nameless) {
         std::cerr << "Wrong number of arguments!\n";
         return EXIT_FAILURE;
     }
-    auto problem = readProblem(args[1]);
+	std::filesystem::path path(args[2]);
+    std::filesystem::path nameFile;
+    if (nameless) {
+        nameFile = path / std::filesystem::path(args[1]).filename();
+        nameFile += ".names";
+    }
+    auto problem = readProblem(args[1], MPSReadSettings{.keepNames = !nameless, .nameFile = nameFile});
     if (!problem.has_value()) {
         return EXIT_FAILURE;
     }
-	std::filesystem::path path(args[2]);
 
     std::vector<Configuration> configs = {
 //            Configuration{
@@ -222,7 +247,7 @@ int main(int argc, char **argv) {
     std::cout<<"Problem: "<<problem->name<<"\n";
     bool good = true;
     for(const auto& config : configs){
-        if(!processProblem(problem.value(),path,config)){
+        if(!processProblem(problem.value(),path,config,nameFile)){
             good = false;
         }
     }
@@ -0,0 +1,19 @@
+//
+// Created by rolf on 17-10-26.
+//
+
+#ifndef MIPWORKSHOP2024_BENCHMARKTIMING_H
+#define MIPWORKSHOP2024_BENCHMARKTIMING_H
+
+#include <chrono>
+
+/// Returns the wall-clock time in seconds taken by calling function once
+template<typename Function>
+double timeSeconds(Function&& function){
+  auto start = std::chrono::high_resolution_clock::now();
+  function();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+#endif //MIPWORKSHOP2024_BENCHMARKTIMING_H
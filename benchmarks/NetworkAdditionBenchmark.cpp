@@ -0,0 +1,239 @@
+//
+// Created by rolf on 17-10-26.
+//
+// Times the column additions of the network decomposition on the network matrices of random Erdos-Renyi digraphs,
+// and on Linux also counts the cache misses per column addition.
+// Usage: networkAdditionBenchmark [numNodes] [density] [repetitions] [seed]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include <mipworkshop2024/presolve/NetworkAdditionComplete.hpp>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+struct NetworkMatrix{
+  index_t numRows = 0;
+  std::vector<std::vector<spqr_row>> columnRows;
+  std::vector<std::vector<double>> columnValues;
+};
+
+/// The network matrix of a random digraph in which every arc is present with the given probability, with respect
+/// to a random spanning forest: every tree arc is a row, and every other arc is a column holding the signed path
+/// between its endpoints. The rows and columns are shuffled, so that the additions do not follow the tree.
+NetworkMatrix erdosRenyiNetworkMatrix(index_t numNodes, double density, std::uint64_t seed){
+  std::mt19937_64 generator(seed);
+  std::bernoulli_distribution present(density);
+  std::vector<std::pair<index_t,index_t>> arcs;
+  for(index_t head = 1; head < numNodes; ++head){
+    for(index_t tail = 0; tail < head; ++tail){
+      if(present(generator)){
+        arcs.emplace_back(generator() % 2 == 0 ? std::make_pair(head,tail) : std::make_pair(tail,head));
+      }
+    }
+  }
+  std::shuffle(arcs.begin(),arcs.end(),generator);
+
+  //Pick the spanning forest with union-find, and orient it away from the roots by a depth-first search
+  std::vector<index_t> representative(numNodes);
+  std::iota(representative.begin(),representative.end(),0);
+  auto find = [&](index_t node){
+    while(representative[node] != node){
+      node = representative[node] = representative[representative[node]];
+    }
+    return node;
+  };
+  std::vector<std::vector<std::pair<index_t,index_t>>> treeNeighbours(numNodes); //node and tree arc index
+  std::vector<std::pair<index_t,index_t>> nonTreeArcs;
+  NetworkMatrix matrix;
+  for(const auto& [head,tail] : arcs){
+    index_t headRoot = find(head);
+    index_t tailRoot = find(tail);
+    if(headRoot == tailRoot){
+      nonTreeArcs.emplace_back(head,tail);
+      continue;
+    }
+    representative[headRoot] = tailRoot;
+    treeNeighbours[head].emplace_back(tail,matrix.numRows);
+    treeNeighbours[tail].emplace_back(head,matrix.numRows);
+    ++matrix.numRows;
+  }
+  std::vector<index_t> rowPermutation(matrix.numRows);
+  std::iota(rowPermutation.begin(),rowPermutation.end(),0);
+  std::shuffle(rowPermutation.begin(),rowPermutation.end(),generator);
+
+  //The arc of the tree arcs is given by the arc to the parent; its orientation is chosen at random
+  std::vector<index_t> parent(numNodes,numNodes);
+  std::vector<index_t> parentRow(numNodes);
+  std::vector<bool> parentArcUp(numNodes);
+  std::vector<index_t> depth(numNodes,0);
+  std::vector<index_t> stack;
+  for(index_t root = 0; root < numNodes; ++root){
+    if(parent[root] != numNodes){
+      continue;
+    }
+    parent[root] = root;
+    stack.push_back(root);
+    while(!stack.empty()){
+      index_t node = stack.back();
+      stack.pop_back();
+      for(const auto& [neighbour,row] : treeNeighbours[node]){
+        if(parent[neighbour] != numNodes){
+          continue;
+        }
+        parent[neighbour] = node;
+        parentRow[neighbour] = rowPermutation[row];
+        parentArcUp[neighbour] = generator() % 2 == 0;
+        depth[neighbour] = depth[node] + 1;
+        stack.push_back(neighbour);
+      }
+    }
+  }
+
+  std::shuffle(nonTreeArcs.begin(),nonTreeArcs.end(),generator);
+  for(auto [head,tail] : nonTreeArcs){
+    //The path from the tail to the head: tree arcs pointing along it get +1, the others -1
+    std::vector<spqr_row> rows;
+    std::vector<double> values;
+    while(tail != head){
+      if(depth[tail] >= depth[head]){
+        rows.push_back(parentRow[tail]);
+        values.push_back(parentArcUp[tail] ? 1.0 : -1.0);
+        tail = parent[tail];
+      }else{
+        rows.push_back(parentRow[head]);
+        values.push_back(parentArcUp[head] ? -1.0 : 1.0);
+        head = parent[head];
+      }
+    }
+    matrix.columnRows.push_back(std::move(rows));
+    matrix.columnValues.push_back(std::move(values));
+  }
+  return matrix;
+}
+
+#ifdef __linux__
+/// Counts the hardware cache misses of the calling thread, if the kernel allows it
+class CacheMissCounter{
+public:
+  CacheMissCounter(){
+    perf_event_attr attributes{};
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.size = sizeof(attributes);
+    attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    descriptor = static_cast<int>(syscall(SYS_perf_event_open,&attributes,0,-1,-1,0));
+  }
+  ~CacheMissCounter(){
+    if(descriptor >= 0){
+      close(descriptor);
+    }
+  }
+  [[nodiscard]] bool available() const{
+    return descriptor >= 0;
+  }
+  void start(){
+    ioctl(descriptor,PERF_EVENT_IOC_RESET,0);
+    ioctl(descriptor,PERF_EVENT_IOC_ENABLE,0);
+  }
+  std::uint64_t stop(){
+    ioctl(descriptor,PERF_EVENT_IOC_DISABLE,0);
+    std::uint64_t count = 0;
+    if(read(descriptor,&count,sizeof(count)) != sizeof(count)){
+      return 0;
+    }
+    return count;
+  }
+private:
+  int descriptor;
+};
+#else
+class CacheMissCounter{
+public:
+  [[nodiscard]] bool available() const{
+    return false;
+  }
+  void start(){}
+  std::uint64_t stop(){
+    return 0;
+  }
+};
+#endif
+
+/// Adds all columns to a new decomposition, and returns the number of columns which were accepted
+index_t addColumns(const NetworkMatrix& matrix){
+  SPQR * env = NULL;
+  SPQRNetworkDecomposition * dec = NULL;
+  SPQRNetworkColumnAddition * colAddition = NULL;
+  SPQR_CALL_THROW(SPQRcreateEnvironment(&env));
+  SPQR_CALL_THROW(SPQRNetworkDecompositionCreate(env,&dec,(int) matrix.numRows,(int) matrix.columnRows.size()));
+  SPQR_CALL_THROW(SPQRcreateNetworkColumnAddition(env,&colAddition));
+  index_t numAccepted = 0;
+  for(index_t col = 0; col < matrix.columnRows.size(); ++col){
+    SPQR_CALL_THROW(SPQRNetworkColumnAdditionCheck(dec,colAddition,col,matrix.columnRows[col].data(),
+                                                   matrix.columnValues[col].data(),matrix.columnRows[col].size()));
+    if(SPQRNetworkColumnAdditionRemainsNetwork(colAddition)){
+      SPQR_CALL_THROW(SPQRNetworkColumnAdditionAdd(dec,colAddition));
+      ++numAccepted;
+    }
+  }
+  SPQRfreeNetworkColumnAddition(env,&colAddition);
+  SPQRNetworkDecompositionFree(&dec);
+  SPQRfreeEnvironment(&env);
+  return numAccepted;
+}
+}
+
+int main(int argc, char** argv){
+  index_t numNodes = argc > 1 ? std::stoull(argv[1]) : 2000;
+  double density = argc > 2 ? std::stod(argv[2]) : 0.005;
+  int repetitions = argc > 3 ? std::stoi(argv[3]) : 5;
+  std::uint64_t seed = argc > 4 ? std::stoull(argv[4]) : 1;
+
+  NetworkMatrix matrix = erdosRenyiNetworkMatrix(numNodes,density,seed);
+  index_t numColumns = matrix.columnRows.size();
+  index_t numNonzeros = 0;
+  for(const auto& rows : matrix.columnRows){
+    numNonzeros += rows.size();
+  }
+  std::cout<<"Matrix: "<<matrix.numRows<<" x "<<numColumns<<", "<<numNonzeros<<" nonzeros\n";
+
+  CacheMissCounter counter;
+  std::uint64_t cacheMisses = 0;
+  index_t numAccepted = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+  for(int i = 0; i < repetitions; ++i){
+    if(counter.available()){
+      counter.start();
+    }
+    numAccepted = addColumns(matrix);
+    if(counter.available()){
+      cacheMisses += counter.stop();
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double additions = static_cast<double>(repetitions) * static_cast<double>(std::max<index_t>(numColumns,1));
+
+  std::cout<<"Accepted columns: "<<numAccepted<<" of "<<numColumns<<"\n";
+  std::cout<<"Time: "<<1e9 * std::chrono::duration<double>(end - start).count() / additions
+           <<" ns per column addition\n";
+  if(counter.available()){
+    std::cout<<"Cache misses: "<<static_cast<double>(cacheMisses) / additions<<" per column addition\n";
+  }else{
+    std::cout<<"Cache misses: not available\n";
+  }
+  return numAccepted == numColumns ? EXIT_SUCCESS : EXIT_FAILURE;
+}
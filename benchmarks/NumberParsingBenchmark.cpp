@@ -0,0 +1,106 @@
+//
+// Created by rolf on 17-10-26.
+//
+// Compares parseDouble() against the std::stod path the readers used before, on all numbers in the test instances.
+// Usage: numberParsingBenchmark [dataDirectory] [repetitions]
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mipworkshop2024/IO.h>
+#include <mipworkshop2024/Shared.h>
+#include "BenchmarkTiming.h"
+
+namespace {
+/// Returns the length of the prefix of the token which std::stod parses, or 0 if it is not a number
+std::size_t stodLength(const std::string& token){
+  try{
+    std::size_t end = 0;
+    std::stod(token,&end);
+    return end;
+  }catch(const std::exception&){
+    return 0;
+  }
+}
+
+/// Returns all words in the MPS files of the directory which are numbers; names starting with a digit are skipped
+std::vector<std::string> collectNumberTokens(const std::filesystem::path& directory){
+  std::vector<std::string> tokens;
+  for(const auto& entry : std::filesystem::directory_iterator(directory)){
+    if(!entry.is_regular_file() || entry.path().extension() != ".mps"){
+      continue;
+    }
+    std::ifstream stream(entry.path());
+    std::string word;
+    while(stream >> word){
+      char first = word.front();
+      if(((first >= '0' && first <= '9') || first == '-' || first == '+' || first == '.') &&
+         stodLength(word) == word.size()){
+        tokens.push_back(word);
+      }
+    }
+  }
+  return tokens;
+}
+}
+
+int main(int argc, char** argv){
+  std::filesystem::path directory = argc > 1 ? argv[1] : MIPWORKSHOP2024_BENCHMARK_DATA_DIR;
+  int repetitions = argc > 2 ? std::stoi(argv[2]) : 20;
+
+  auto tokens = collectNumberTokens(directory);
+  if(tokens.empty()){
+    std::cerr<<"No numbers found in "<<directory<<"\n";
+    return EXIT_FAILURE;
+  }
+  std::vector<std::string_view> views(tokens.begin(),tokens.end());
+
+  std::size_t numMismatches = 0;
+  for(const auto& token : tokens){
+    auto parsed = parseDouble(token);
+    if(!parsed.has_value() || parsed.value() != std::stod(token)){
+      ++numMismatches;
+    }
+  }
+
+  double stodSum = 0.0;
+  double stodTime = timeSeconds([&](){
+    for(int i = 0; i < repetitions; ++i){
+      for(std::string_view view : views){
+        stodSum += std::stod(std::string(view));
+      }
+    }
+  });
+  double parseSum = 0.0;
+  double parseTime = timeSeconds([&](){
+    for(int i = 0; i < repetitions; ++i){
+      for(std::string_view view : views){
+        parseSum += parseDouble(view).value_or(0.0);
+      }
+    }
+  });
+
+  double numParsed = static_cast<double>(tokens.size()) * repetitions;
+  std::cout<<"Numbers: "<<tokens.size()<<" x "<<repetitions<<" repetitions, mismatches: "<<numMismatches<<"\n";
+  std::cout<<"std::stod(std::string): "<<stodTime<<" s, "<<1e9 * stodTime / numParsed<<" ns/number\n";
+  std::cout<<"parseDouble:            "<<parseTime<<" s, "<<1e9 * parseTime / numParsed<<" ns/number\n";
+  std::cout<<"Speedup: "<<stodTime / parseTime<<" (checksums "<<stodSum<<", "<<parseSum<<")\n";
+
+  //End-to-end reading times of the instances, which include the number parsing
+  for(const auto& entry : std::filesystem::directory_iterator(directory)){
+    if(!entry.is_regular_file() || entry.path().extension() != ".mps"){
+      continue;
+    }
+    bool good = true;
+    double readTime = timeSeconds([&](){
+      for(int i = 0; i < repetitions; ++i){
+        good = readMPSFile(entry.path()).has_value() && good;
+      }
+    });
+    std::cout<<entry.path().filename().string()<<": "<<1e3 * readTime / repetitions<<" ms per read"
+             <<(good ? "" : " (unsupported)")<<"\n";
+  }
+  return numMismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,113 @@
+//
+// Created by rolf on 17-10-26.
+//
+// Compares the compressed, interleaved and sign pattern matrix layouts on the hot loops of the TU detection, and times
+// the complete detection, on all test instances.
+// Usage: tuDetectionBenchmark [dataDirectory] [repetitions]
+
+#include <filesystem>
+#include <iostream>
+#include <mipworkshop2024/IO.h>
+#include <mipworkshop2024/presolve/IncidenceAddition.h>
+#include <mipworkshop2024/presolve/TUColumnSubmatrix.h>
+#include "BenchmarkTiming.h"
+
+namespace {
+/// The column scan of TUColumnSubmatrixFinder::computeRowAndColumnTypes(): counts the +-1 columns which do not
+/// occur in a row with fractional coefficients
+template<typename Matrix>
+index_t countPlusMinusOneColumns(const Matrix& matrix, std::vector<bool>& isNonIntegralRow){
+  index_t count = 0;
+  for(index_t col = 0; col < matrix.numCols(); ++col){
+    bool isPlusMinusOne = true;
+    bool occursInBadRow = false;
+    for(const auto& nonzero : matrix.getPrimaryVector(col)){
+      isPlusMinusOne = isPlusMinusOne && fabs(nonzero.value()) == 1.0;
+      if(!isFeasIntegral(nonzero.value())){
+        isNonIntegralRow[nonzero.index()] = true;
+      }
+      occursInBadRow = occursInBadRow || isNonIntegralRow[nonzero.index()];
+    }
+    count += isPlusMinusOne && !occursInBadRow;
+  }
+  return count;
+}
+
+/// Greedily grows an incidence submatrix from the columns, as the incidence detection strategy does
+template<typename Matrix>
+index_t addIncidenceColumns(const Matrix& matrix){
+  IncidenceAddition addition(matrix.numRows(),matrix.numCols());
+  index_t numAdded = 0;
+  for(index_t col = 0; col < matrix.numCols(); ++col){
+    numAdded += addition.tryAddCol(col,matrix.getPrimaryVector(col));
+  }
+  return numAdded;
+}
+}
+
+int main(int argc, char** argv){
+  std::filesystem::path directory = argc > 1 ? argv[1] : MIPWORKSHOP2024_BENCHMARK_DATA_DIR;
+  int repetitions = argc > 2 ? std::stoi(argv[2]) : 20;
+
+  bool good = true;
+  for(const auto& entry : std::filesystem::directory_iterator(directory)){
+    if(!entry.is_regular_file() || entry.path().extension() != ".mps"){
+      continue;
+    }
+    auto problem = readMPSFile(entry.path());
+    if(!problem.has_value()){
+      continue;
+    }
+    const SparseMatrix& matrix = problem->matrix;
+    InterleavedSparseMatrix interleaved;
+    double interleavedCopyTime = timeSeconds([&](){ interleaved = InterleavedSparseMatrix(matrix);});
+    SignPatternMatrix signPattern;
+    double signPatternCopyTime = timeSeconds([&](){ signPattern = SignPatternMatrix(matrix);});
+
+    //Mark the fractional rows up front, so that every repetition does the same work
+    std::vector<bool> isNonIntegralRow(matrix.numRows(),false);
+    countPlusMinusOneColumns(matrix,isNonIntegralRow);
+    index_t compressedCount = 0;
+    index_t interleavedCount = 0;
+    double compressedScan = timeSeconds([&](){
+      for(int i = 0; i < repetitions; ++i) compressedCount += countPlusMinusOneColumns(matrix,isNonIntegralRow);
+    });
+    double interleavedScan = timeSeconds([&](){
+      for(int i = 0; i < repetitions; ++i) interleavedCount += countPlusMinusOneColumns(interleaved,isNonIntegralRow);
+    });
+
+    index_t compressedAdded = 0;
+    index_t interleavedAdded = 0;
+    index_t signPatternAdded = 0;
+    double compressedIncidence = timeSeconds([&](){
+      for(int i = 0; i < repetitions; ++i) compressedAdded += addIncidenceColumns(matrix);
+    });
+    double interleavedIncidence = timeSeconds([&](){
+      for(int i = 0; i < repetitions; ++i) interleavedAdded += addIncidenceColumns(interleaved);
+    });
+    double signPatternIncidence = timeSeconds([&](){
+      for(int i = 0; i < repetitions; ++i) signPatternAdded += addIncidenceColumns(signPattern);
+    });
+    bool same = compressedCount == interleavedCount && compressedAdded == interleavedAdded &&
+        compressedAdded == signPatternAdded;
+    good = good && same;
+
+    TUSettings settings{.doDowngrade = true, .writeType = VariableType::IMPLIED_INTEGER, .dynamic = false};
+    double detectionTime = timeSeconds([&](){
+      TUColumnSubmatrixFinder finder(problem.value(),settings);
+      finder.computeTUSubmatrices();
+    });
+
+    std::cout<<entry.path().filename().string()<<" ("<<matrix.getValues().size()<<" nonzeros)"
+             <<(same ? "" : " results differ!")<<"\n"
+             <<"  copies:            "<<1e3 * interleavedCopyTime<<" ms interleaved, "
+             <<1e3 * signPatternCopyTime<<" ms sign pattern\n"
+             <<"  column scan:       "<<1e3 * compressedScan / repetitions<<" ms compressed, "
+             <<1e3 * interleavedScan / repetitions<<" ms interleaved\n"
+             <<"  incidence columns: "<<1e3 * compressedIncidence / repetitions<<" ms compressed, "
+             <<1e3 * interleavedIncidence / repetitions<<" ms interleaved, "
+             <<1e3 * signPatternIncidence / repetitions<<" ms sign pattern\n"
+             <<"  TU detection:      "<<1e3 * detectionTime<<" ms\n";
+  }
+  return good ? EXIT_SUCCESS : EXIT_FAILURE;
+}
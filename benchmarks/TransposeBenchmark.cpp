@@ -0,0 +1,73 @@
+//
+// Created by rolf on 17-10-26.
+//
+// Compares the serial transpose of SparseMatrix against the blocked parallel transpose on synthetic matrices.
+// Usage: transposeBenchmark [numNonzeros] [numThreads] [repetitions]
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <mipworkshop2024/Parallel.h>
+#include <mipworkshop2024/SparseMatrix.h>
+#include "BenchmarkTiming.h"
+
+namespace {
+/// Column-wise matrix with roughly numNonzeros entries, and 20 entries per row and per column on average.
+/// The row indices are uniformly random, which is the worst case for the locality of the scatter.
+SparseMatrix syntheticMatrix(index_t numNonzeros){
+  index_t numRows = std::max<index_t>(numNonzeros / 20,1);
+  index_t numCols = std::max<index_t>(numNonzeros / 20,1);
+  std::mt19937_64 generator(42);
+  std::uniform_int_distribution<index_t> columnSize(1,39);
+  std::uniform_int_distribution<index_t> row(0,numRows - 1);
+  std::vector<index_t> rows;
+
+  SparseMatrix matrix;
+  matrix.setNumSecondary(numRows);
+  matrix.reserve(numCols,numNonzeros + 40);
+  for(index_t col = 0; col < numCols; ++col){
+    rows.resize(columnSize(generator));
+    for(index_t& entry : rows){
+      entry = row(generator);
+    }
+    std::sort(rows.begin(),rows.end());
+    rows.erase(std::unique(rows.begin(),rows.end()),rows.end());
+    for(index_t entry : rows){
+      matrix.appendNonzero(entry,static_cast<double>(entry % 97) - 48.0);
+    }
+    matrix.finishPrimaryVector();
+  }
+  return matrix;
+}
+}
+
+int main(int argc, char** argv){
+  index_t numNonzeros = argc > 1 ? std::stoull(argv[1]) : 10'000'000;
+  index_t numThreads = resolveNumThreads(argc > 2 ? std::stoull(argv[2]) : 0);
+  int repetitions = argc > 3 ? std::stoi(argv[3]) : 3;
+
+  SparseMatrix matrix = syntheticMatrix(numNonzeros);
+  std::cout<<"Matrix: "<<matrix.numRows()<<" x "<<matrix.numCols()<<", "<<matrix.getValues().size()<<" nonzeros\n";
+
+  SparseMatrix serial;
+  double serialTime = timeSeconds([&](){
+    for(int i = 0; i < repetitions; ++i){
+      serial = matrix.transposedFormat(1);
+    }
+  });
+  SparseMatrix parallel;
+  double parallelTime = timeSeconds([&](){
+    for(int i = 0; i < repetitions; ++i){
+      parallel = matrix.transposedFormat(numThreads);
+    }
+  });
+  bool equal = serial.getPrimaryStart() == parallel.getPrimaryStart() &&
+      serial.getSecondaryIndex() == parallel.getSecondaryIndex() &&
+      serial.getValues() == parallel.getValues();
+
+  std::cout<<"Serial:              "<<1e3 * serialTime / repetitions<<" ms per transpose\n";
+  std::cout<<"Parallel ("<<numThreads<<" threads): "<<1e3 * parallelTime / repetitions<<" ms per transpose\n";
+  std::cout<<"Speedup: "<<serialTime / parallelTime<<(equal ? "" : " (results differ!)")<<"\n";
+  return equal ? EXIT_SUCCESS : EXIT_FAILURE;
+}
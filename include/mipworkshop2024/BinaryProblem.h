@@ -0,0 +1,99 @@
+//
+// Created by rolf on 17-10-26.
+//
+
+#ifndef MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_BINARYPROBLEM_H
+#define MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_BINARYPROBLEM_H
+
+#include "Problem.h"
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+/// Binary problem files store the arrays of a Problem as they are laid out in memory, so that they can be
+/// memory-mapped and used directly rather than being parsed.
+/// The file consists of a BinaryProblemHeader followed by the sections listed in BinaryProblemSection,
+/// each of which starts at an 8-byte aligned offset. The names are stored as one NUL-terminated string per name,
+/// in the order: problem name, column names, row names.
+constexpr std::string_view BINARY_PROBLEM_EXTENSION = ".bprob";
+constexpr std::array<char,8> BINARY_PROBLEM_MAGIC = {'M','I','P','W','B','P','R','B'};
+constexpr std::uint32_t BINARY_PROBLEM_VERSION = 1;
+constexpr std::uint32_t BINARY_PROBLEM_BYTE_ORDER_MARK = 0x01020304;
+
+enum class BinaryProblemSection{
+  PRIMARY_START = 0, //index_t, numCols+1
+  SECONDARY_INDEX = 1, //index_t, numNonzeros
+  VALUES = 2, //double, numNonzeros
+  OBJECTIVE = 3, //double, numCols
+  LOWER_BOUND = 4, //double, numCols
+  UPPER_BOUND = 5, //double, numCols
+  COLUMN_TYPE = 6, //uint8_t, numCols
+  LHS = 7, //double, numRows
+  RHS = 8, //double, numRows
+  NAME_OFFSETS = 9, //uint64_t, numNames+1
+  NAME_CHARS = 10, //char, nameBytes
+  NUM_SECTIONS = 11
+};
+
+struct BinaryProblemSectionLocation{
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+struct BinaryProblemHeader{
+  std::array<char,8> magic;
+  std::uint32_t version;
+  std::uint32_t byteOrderMark;
+  std::uint32_t indexSize;
+  std::uint32_t sense;
+  std::uint64_t numRows;
+  std::uint64_t numCols;
+  std::uint64_t numNonzeros;
+  double objectiveOffset;
+  std::array<BinaryProblemSectionLocation,static_cast<std::size_t>(BinaryProblemSection::NUM_SECTIONS)> sections;
+};
+static_assert(sizeof(BinaryProblemHeader) % 8 == 0);
+
+bool writeBinaryProblemFile(const Problem& problem, const std::filesystem::path& path);
+
+/// Read-only view of a memory-mapped binary problem file. All accessors point directly into the mapped file.
+class BinaryProblemView{
+public:
+  /// Maps and validates the file; returns std::nullopt if it is not a valid binary problem file for this build
+  static std::optional<BinaryProblemView> open(const std::filesystem::path& path);
+
+  [[nodiscard]] index_t numRows() const;
+  [[nodiscard]] index_t numCols() const;
+  [[nodiscard]] index_t numNonzeros() const;
+
+  [[nodiscard]] MatrixSlice<CompressedSlice> column(index_t col) const;
+  [[nodiscard]] std::span<const double> objective() const;
+  [[nodiscard]] std::span<const double> lowerBounds() const;
+  [[nodiscard]] std::span<const double> upperBounds() const;
+  [[nodiscard]] VariableType columnType(index_t col) const;
+  [[nodiscard]] std::span<const double> lhs() const;
+  [[nodiscard]] std::span<const double> rhs() const;
+
+  [[nodiscard]] ObjSense sense() const;
+  [[nodiscard]] double objectiveOffset() const;
+  [[nodiscard]] std::string_view problemName() const;
+  [[nodiscard]] std::string_view columnName(index_t col) const;
+  [[nodiscard]] std::string_view rowName(index_t row) const;
+
+  /// Copies the contents of the file into an ordinary Problem; if withNames is false, the names are not copied
+  [[nodiscard]] Problem toProblem(bool withNames = true) const;
+private:
+  BinaryProblemView() = default;
+  template<typename T>
+  [[nodiscard]] std::span<const T> section(BinaryProblemSection section) const;
+  [[nodiscard]] std::string_view name(index_t index) const;
+  [[nodiscard]] const BinaryProblemHeader& header() const;
+
+  boost::iostreams::mapped_file_source file;
+};
+
+#endif //MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_BINARYPROBLEM_H
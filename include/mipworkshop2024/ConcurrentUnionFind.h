@@ -0,0 +1,66 @@
+//
+// Created by rolf on 17-10-26.
+//
+
+#ifndef MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_CONCURRENTUNIONFIND_H
+#define MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_CONCURRENTUNIONFIND_H
+
+#include "Shared.h"
+#include <atomic>
+#include <utility>
+#include <vector>
+
+/// Lock-free union-find on the elements [0,size), which may be merged from multiple threads concurrently.
+/// A root is always linked below the smaller root, so the representative of every set is its smallest element,
+/// regardless of the order in which the threads perform their unions.
+class ConcurrentUnionFind{
+public:
+  explicit ConcurrentUnionFind(index_t size) : parent(size){
+    for(index_t i = 0; i < size; ++i){
+      parent[i].store(i,std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] index_t size() const{
+    return parent.size();
+  }
+
+  /// Returns the smallest element of the set containing element
+  index_t find(index_t element){
+    while(true){
+      index_t next = parent[element].load(std::memory_order_acquire);
+      if(next == element){
+        return element;
+      }
+      //Path halving; parent links only ever decrease, so a failed exchange can safely be ignored
+      index_t grandParent = parent[next].load(std::memory_order_acquire);
+      if(grandParent != next){
+        parent[element].compare_exchange_weak(next,grandParent,std::memory_order_release,std::memory_order_relaxed);
+      }
+      element = grandParent;
+    }
+  }
+
+  /// Merges the sets containing first and second
+  void unite(index_t first, index_t second){
+    while(true){
+      first = find(first);
+      second = find(second);
+      if(first == second){
+        return;
+      }
+      if(first < second){
+        std::swap(first,second);
+      }
+      //Fails if another thread linked first in the meantime, in which case we retry from the new roots
+      index_t expected = first;
+      if(parent[first].compare_exchange_strong(expected,second,std::memory_order_acq_rel)){
+        return;
+      }
+    }
+  }
+private:
+  std::vector<std::atomic<index_t>> parent;
+};
+
+#endif //MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_CONCURRENTUNIONFIND_H
@@ -0,0 +1,31 @@
+//
+// Created by rolf on 17-10-26.
+//
+
+#ifndef MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_GZIPREADER_H
+#define MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_GZIPREADER_H
+
+#include "Shared.h"
+#include <filesystem>
+#include <functional>
+#include <string_view>
+
+struct GzipReadSettings{
+  /// Size of the blocks of decompressed data which are handed to the consumer
+  std::size_t blockSize = std::size_t(4) << 20;
+  /// Number of blocks that can be in flight; decompression stalls if the consumer is this many blocks behind
+  index_t numBlocks = 4;
+  /// Number of threads that decompress gzip members in parallel. This is only possible if the member boundaries
+  /// are stored in the file, as is done by BGZF (bgzip). Other files are decompressed by a single thread.
+  index_t numThreads = 1;
+};
+
+/// Decompresses a (possibly multi-member) gzip file on background threads, and passes the decompressed data to the
+/// consumer in order, one block at a time. Lines may be split over consecutive blocks.
+/// The consumer can return false to stop reading early.
+/// Returns false if the file could not be read or decompressed.
+bool readGzipFileBlocks(const std::filesystem::path& path,
+                        const GzipReadSettings& settings,
+                        const std::function<bool(std::string_view)>& consumer);
+
+#endif //MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_GZIPREADER_H
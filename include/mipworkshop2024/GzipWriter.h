@@ -0,0 +1,44 @@
+//
+// Created by rolf on 17-10-26.
+//
+
+#ifndef MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_GZIPWRITER_H
+#define MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_GZIPWRITER_H
+
+#include "Shared.h"
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+struct GzipWriteSettings{
+  /// Number of threads that compress the data; 0 uses all hardware threads.
+  /// With a single thread, the file is compressed as one gzip member on a background thread while the caller keeps
+  /// writing. With more threads, the file is written as independent BGZF members which are compressed in parallel,
+  /// and which can also be decompressed in parallel (see GzipReadSettings).
+  index_t numThreads = 1;
+  /// zlib compression level, from 1 (fastest) to 9 (smallest)
+  int compressionLevel = 6;
+  /// Size of the blocks of uncompressed data which are handed to the compression threads
+  std::size_t blockSize = std::size_t(1) << 20;
+  /// Number of blocks that can be in flight; writing stalls if compression is this many blocks behind
+  index_t numBlocks = 4;
+};
+
+/// Writes a gzip file, compressing the data on background threads.
+class GzipFileWriter{
+public:
+  GzipFileWriter(const std::filesystem::path& path, const GzipWriteSettings& settings = {});
+  ~GzipFileWriter();
+  GzipFileWriter(const GzipFileWriter&) = delete;
+  GzipFileWriter& operator=(const GzipFileWriter&) = delete;
+
+  /// Returns false if the file could not be opened or an earlier write failed
+  bool write(std::string_view data);
+  /// Compresses the remaining data and finishes the file. Returns false if anything could not be written.
+  bool close();
+private:
+  struct Implementation;
+  std::unique_ptr<Implementation> implementation;
+};
+
+#endif //MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_GZIPWRITER_H
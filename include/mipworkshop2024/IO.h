@@ -11,6 +11,7 @@
 #include <optional>
 #include <fstream>
 #include <filesystem>
+#include <string_view>
 
 bool solToStream(const ExternalSolution& solution, std::ostream& stream);
 
@@ -18,16 +19,58 @@ std::optional<ExternalSolution> readSolFile(const std::filesystem::path& path);
 std::optional<ExternalSolution> solFromStream(std::istream& stream);
 std::optional<ExternalSolution> solFromCompressedStream(std::istream& stream);
 
-std::optional<Problem> readMPSFile(const std::filesystem::path& path);
+struct MPSReadSettings{
+  /// Memory-map uncompressed files and parse them in place, rather than reading them line by line through a stream
+  bool memoryMap = true;
+  /// Number of threads used to parse the COLUMNS section of memory-mapped files; 0 uses all hardware threads
+  index_t numThreads = 1;
+  /// Decompress .mps.gz files on a separate thread while parsing, rather than through a boost::iostreams filter.
+  /// If the file is in BGZF format, numThreads threads are used to decompress it.
+  bool pipelineDecompression = true;
+  std::size_t decompressionBlockSize = std::size_t(4) << 20;
+  index_t numDecompressionBlocks = 4;
+  /// Drop the row and column names once the problem is read; it then uses generated names (see Problem::hasNames())
+  bool keepNames = true;
+  /// If the names are dropped and this is non-empty, they are first written to this name file
+  std::filesystem::path nameFile;
+};
+
+std::optional<Problem> readMPSFile(const std::filesystem::path& path, const MPSReadSettings& settings = {});
 std::optional<Problem> problemFromMPSstream(std::istream& stream);
+/// Parses an MPS file that is stored in memory; no copies of the names or numbers are made while tokenizing
+std::optional<Problem> problemFromMPSMemory(std::string_view contents, const MPSReadSettings& settings = {});
+std::optional<Problem> problemFromMappedMPSFile(const std::filesystem::path& path, const MPSReadSettings& settings = {});
 std::optional<Problem> problemFromCompressedMPSStream(std::istream& stream);
+std::optional<Problem> problemFromCompressedMPSFile(const std::filesystem::path& path, const MPSReadSettings& settings = {});
+
+/// Name files store only the row and column names of a problem in a compact binary form, so that problems can be
+/// solved without their names and the solutions can be translated back to the original names afterwards
+bool writeNameFile(const Problem& problem, const std::filesystem::path& path);
+std::optional<ProblemNames> readNameFile(const std::filesystem::path& path);
+
+struct MPSWriteSettings{
+  /// Compress the file with gzip; otherwise the MPS text is written as is
+  bool compress = true;
+  /// Number of threads used for compression; see GzipWriteSettings::numThreads
+  index_t numCompressionThreads = 1;
+  int compressionLevel = 6;
+  /// Size of the buffer in which the output is formatted before it is written or compressed
+  std::size_t bufferSize = std::size_t(1) << 20;
+};
 
-bool writeMPSFile(const Problem& problem,const std::filesystem::path& path);
+bool writeMPSFile(const Problem& problem,const std::filesystem::path& path, const MPSWriteSettings& settings = {});
 bool problemToStream(const Problem& problem,std::ostream& stream);
 bool problemToStreamCompressed(const Problem&, std::ostream& stream);
 
-bool writePostSolveStackFile(const PostSolveStack& stack, const std::filesystem::path& path);
-bool postSolveStackToStream(const PostSolveStack& stack, std::ostream& stream);
+enum class PostSolveStackFormat{
+  BINARY, //Compact, see postSolveToBinary()
+  JSON //Human-readable, for debugging
+};
+bool writePostSolveStackFile(const PostSolveStack& stack, const std::filesystem::path& path,
+                             PostSolveStackFormat format = PostSolveStackFormat::BINARY);
+bool postSolveStackToStream(const PostSolveStack& stack, std::ostream& stream,
+                            PostSolveStackFormat format = PostSolveStackFormat::BINARY);
+/// Reads a postsolve stack in either format
 std::optional<PostSolveStack> postSolveStackFromStream(std::istream& stream);
 
 #endif //MIPWORKSHOP2024_SRC_IO_H
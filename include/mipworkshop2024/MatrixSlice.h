@@ -6,6 +6,8 @@
 #define MIPWORKSHOP2024_SRC_MATRIXSLICE_H
 
 #include "Shared.h"
+#include <cstdint>
+#include <iterator>
 
 template <typename Storage>
 class MatrixSlice;
@@ -98,6 +100,163 @@ struct CompressedSlice : public MatrixSlice<CompressedSlice> {
 };
 
 
+/// A nonzero which stores its index and value next to each other, as used by InterleavedSlice
+class InterleavedNonzero{
+public:
+  InterleavedNonzero() = default;
+  InterleavedNonzero(index_t index, double value) : entryIndex{index}, entryValue{value}{}
+  [[nodiscard]] index_t index() const {
+    return entryIndex;
+  }
+  [[nodiscard]] double value() const{
+    return entryValue;
+  }
+private:
+  index_t entryIndex;
+  double entryValue;
+};
+
+/// Use InterleavedSlice to iterate over a single array of {index, value} pairs, so that loops which read both
+/// the index and the value of every nonzero only touch one stream of memory
+struct InterleavedSlice;
+template <>
+class MatrixSlice<InterleavedSlice> {
+  const InterleavedNonzero* entries;
+  index_t len;
+
+public:
+  using iterator = const InterleavedNonzero*;
+
+  MatrixSlice(const InterleavedNonzero* entries_, index_t len_) : entries(entries_), len(len_) {}
+  [[nodiscard]] iterator begin() const { return entries; }
+  [[nodiscard]] iterator end() const { return entries + len; }
+};
+
+struct InterleavedSlice : public MatrixSlice<InterleavedSlice> {
+  using MatrixSlice<InterleavedSlice>::MatrixSlice;
+};
+
+
+/// A nonzero of a sign pattern, which only tells whether the entry is +1, -1 or something else
+class SignNonzero{
+public:
+  SignNonzero() = default;
+  SignNonzero(index_t index, bool negative, bool unit) : entryIndex{index}, negative{negative}, unit{unit}{}
+  [[nodiscard]] index_t index() const {
+    return entryIndex;
+  }
+  [[nodiscard]] bool isNegative() const{
+    return negative;
+  }
+  /// Whether the entry is +1 or -1
+  [[nodiscard]] bool isUnit() const{
+    return unit;
+  }
+private:
+  index_t entryIndex;
+  bool negative;
+  bool unit;
+};
+
+/// Use SignSlice to iterate over a vector of a sign pattern matrix. The signs are stored as a bitset, in which the
+/// entries of the slice occupy the bits [firstBit(),firstBit()+size()).
+struct SignSlice;
+template <>
+class MatrixSlice<SignSlice> {
+  const index_t* index;
+  const std::uint64_t* negative;
+  const std::uint64_t* nonUnit;
+  index_t first;
+  index_t len;
+  bool unit;
+
+  static bool bit(const std::uint64_t* bits, index_t position){
+    return (bits[position / 64] >> (position % 64)) & 1u;
+  }
+public:
+  class iterator {
+    const index_t* index;
+    const std::uint64_t* negative;
+    const std::uint64_t* nonUnit;
+    index_t position; //bit of the current entry
+    bool unit;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = SignNonzero;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = SignNonzero;
+
+    iterator(const index_t* index, const std::uint64_t* negative, const std::uint64_t* nonUnit,
+             index_t position, bool unit)
+        : index(index), negative(negative), nonUnit(nonUnit), position(position), unit(unit) {}
+    iterator() = default;
+
+    iterator operator++(int) {
+      iterator prev = *this;
+      ++(*this);
+      return prev;
+    }
+    iterator& operator++() {
+      ++index;
+      ++position;
+      return *this;
+    }
+    reference operator*() const {
+      return {*index, bit(negative,position), unit || !bit(nonUnit,position)};
+    }
+    iterator operator+(difference_type v) const {
+      iterator i = *this;
+      i.index += v;
+      i.position += v;
+      return i;
+    }
+
+    bool operator==(const iterator& rhs) const {
+      return index == rhs.index;
+    }
+    bool operator!=(const iterator& rhs) const {
+      return index != rhs.index;
+    }
+  };
+
+  MatrixSlice(const index_t* index_, const std::uint64_t* negative_, const std::uint64_t* nonUnit_,
+              index_t first_, index_t len_, bool unit_)
+      : index(index_), negative(negative_), nonUnit(nonUnit_), first(first_), len(len_), unit(unit_) {}
+  [[nodiscard]] iterator begin() const { return iterator{index, negative, nonUnit, first, unit}; }
+  [[nodiscard]] iterator end() const { return iterator{index + len, negative, nonUnit, first + len, unit}; }
+
+  [[nodiscard]] const index_t* indices() const { return index; }
+  [[nodiscard]] const std::uint64_t* negativeBits() const { return negative; }
+  [[nodiscard]] index_t firstBit() const { return first; }
+  [[nodiscard]] index_t size() const { return len; }
+  /// Whether every entry is +1 or -1; this is precomputed, so it takes constant time
+  [[nodiscard]] bool allUnit() const { return unit; }
+};
+
+struct SignSlice : public MatrixSlice<SignSlice> {
+  using MatrixSlice<SignSlice>::MatrixSlice;
+};
+
+/// The TU detection only needs to know whether entries are +1, -1 or something else.
+/// These overloads answer that for the nonzeros of every storage type.
+template<typename Entry>
+bool isUnitEntry(const Entry& entry){
+  return fabs(entry.value()) == 1.0;
+}
+inline bool isUnitEntry(const SignNonzero& entry){
+  return entry.isUnit();
+}
+template<typename Entry>
+bool isNegativeEntry(const Entry& entry){
+  return entry.value() < 0.0;
+}
+inline bool isNegativeEntry(const SignNonzero& entry){
+  return entry.isNegative();
+}
+
+
 struct ListSlice;
 
 template <>
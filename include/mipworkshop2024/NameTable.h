@@ -0,0 +1,72 @@
+//
+// Created by rolf on 17-10-26.
+//
+
+#ifndef MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_NAMETABLE_H
+#define MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_NAMETABLE_H
+
+#include "Shared.h"
+#include <iosfwd>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+/// Transparent hash so that maps keyed by std::string can be queried with a std::string_view
+struct NameHash{
+  using is_transparent = void;
+  std::size_t operator()(std::string_view name) const{
+    return std::hash<std::string_view>{}(name);
+  }
+};
+
+/// Interned, indexed set of names, such as the row or column names of a problem.
+/// All names are stored NUL-terminated in a single contiguous arena, and are looked up using
+/// an open-addressing hash table which stores only the index of each name.
+class NameTable{
+public:
+  NameTable();
+
+  [[nodiscard]] index_t size() const{
+    return static_cast<index_t>(offsets.size() - 1);
+  }
+  [[nodiscard]] bool empty() const{
+    return size() == 0;
+  }
+  [[nodiscard]] std::string_view operator[](index_t index) const{
+    return {chars.data() + offsets[index],offsets[index+1] - offsets[index] - 1};
+  }
+  /// Returns the name as a NUL-terminated string, e.g. for passing to C APIs
+  [[nodiscard]] const char * c_str(index_t index) const{
+    return chars.data() + offsets[index];
+  }
+
+  /// Adds a name, which receives index size(). Returns INVALID and does not add the name if it is already present.
+  index_t add(std::string_view name);
+  /// Returns the index of the name, or INVALID if the table does not contain it
+  [[nodiscard]] index_t find(std::string_view name) const;
+  [[nodiscard]] bool contains(std::string_view name) const{
+    return find(name) != INVALID;
+  }
+
+  void reserve(index_t numNames, std::size_t numChars);
+  void clear();
+  [[nodiscard]] std::size_t numChars() const{
+    return chars.size();
+  }
+
+  /// Two tables are equal if they contain the same names with the same indices
+  bool operator==(const NameTable& other) const;
+
+  /// Writes the names in a compact binary form: the number of names and characters, the offsets and the arena
+  bool writeTo(std::ostream& stream) const;
+  static std::optional<NameTable> readFrom(std::istream& stream);
+private:
+  [[nodiscard]] std::size_t findSlot(std::string_view name, std::size_t hash) const;
+  void rehash(std::size_t numSlots);
+
+  std::vector<char> chars;
+  std::vector<std::size_t> offsets; //not index_t, as the arena may outgrow 32-bit indices
+  std::vector<index_t> slots; //size is a power of two; INVALID marks an empty slot
+};
+
+#endif //MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_NAMETABLE_H
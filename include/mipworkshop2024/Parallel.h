@@ -0,0 +1,51 @@
+//
+// Created by rolf on 17-10-26.
+//
+
+#ifndef MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_PARALLEL_H
+#define MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_PARALLEL_H
+
+#include "Shared.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/// Resolves a requested number of threads; 0 means that all hardware threads are used
+inline index_t resolveNumThreads(index_t requested){
+  if(requested != 0){
+    return requested;
+  }
+  return std::max<index_t>(1,std::thread::hardware_concurrency());
+}
+
+/// Calls function(task) for every task in [0,numTasks) using at most numThreads threads.
+/// Tasks are handed out dynamically, so function must not depend on which thread executes it.
+/// If only a single thread is used, the tasks are executed in order on the calling thread.
+template<typename Function>
+void parallelFor(index_t numTasks, index_t numThreads, Function&& function){
+  numThreads = std::min(resolveNumThreads(numThreads),numTasks);
+  if(numThreads <= 1){
+    for(index_t task = 0; task < numTasks; ++task){
+      function(task);
+    }
+    return;
+  }
+  std::atomic<index_t> nextTask{0};
+  auto worker = [&](){
+    for(index_t task = nextTask.fetch_add(1,std::memory_order_relaxed); task < numTasks;
+        task = nextTask.fetch_add(1,std::memory_order_relaxed)){
+      function(task);
+    }
+  };
+  {
+    std::vector<std::jthread> threads;
+    threads.reserve(numThreads-1);
+    for(index_t i = 1; i < numThreads; ++i){
+      threads.emplace_back(worker);
+    }
+    worker();
+  }//jthreads join here
+}
+
+#endif //MIPWORKSHOP2024_INCLUDE_MIPWORKSHOP2024_PARALLEL_H
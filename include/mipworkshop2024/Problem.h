@@ -8,9 +8,14 @@
 #include <vector>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include "SparseMatrix.h"
+#include "NameTable.h"
 #include "Shared.h"
 #include "Solution.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <optional>
 
 enum class ObjSense{
@@ -25,26 +30,77 @@ enum class VariableType{
 };
 class ExternalSolution;
 
+/// The row and column names of a problem, which can be stored separately from the problem itself
+struct ProblemNames{
+  NameTable colNames;
+  NameTable rowNames;
+};
+
+/// Lazily built row-wise copy of a column-wise matrix. Copies share the row-wise matrix,
+/// which is rebuilt once the contents of the original matrix change.
+class RowMatrixCache{
+public:
+  RowMatrixCache() = default;
+  RowMatrixCache(const RowMatrixCache& other);
+  RowMatrixCache& operator=(const RowMatrixCache& other);
+
+  /// Returns the row-wise matrix, transposing the matrix with numThreads threads if it is not cached
+  std::shared_ptr<const SparseMatrix> get(const SparseMatrix& matrix, index_t numThreads = 1) const;
+private:
+  mutable std::mutex mutex;
+  mutable std::shared_ptr<const SparseMatrix> rowMatrix;
+  mutable std::uint64_t matrixStamp = 0;
+};
+
 struct Problem {
   Problem();
 
-  std::size_t numRows() const;
-  std::size_t numCols() const;
+  index_t numRows() const;
+  index_t numCols() const;
 
-  void addRow(const std::string& rowName,double rowLHS, double rowRHS);
-  void addColumn(const std::string &colName,
+  /// The names of the rows and of the columns must be unique; adding a name a second time throws std::invalid_argument
+  /// and leaves the problem unchanged
+  void addRow(std::string_view rowName,double rowLHS, double rowRHS);
+  void addColumn(std::string_view colName,
                  const std::vector<index_t>& entryRows,
                  const std::vector<double>& entryValues,
                  VariableType type,
                  double lowerBound,
                  double upperBound);
 
+  /// Reserves storage for a total of numRows rows, numCols columns and numNonzeros nonzeros, so that a problem of
+  /// known size can be built without reallocations
+  void reserve(index_t numRows, index_t numCols, index_t numNonzeros);
+  /// Builder interface for columns, which appends the nonzeros of a new column directly to the matrix.
+  /// The column is completed by finishColumn(), which returns its index. If finishColumn() throws because the name is
+  /// already present, the appended nonzeros are kept for the next column.
+  void appendColumnNonzero(index_t row, double value){
+    matrix.appendNonzero(row,value);
+  }
+  index_t finishColumn(std::string_view colName, VariableType type, double lowerBound, double upperBound);
+
+  /// Problems without names (see releaseNames()) use generated names instead: x<index> for columns and c<index> for rows
+  [[nodiscard]] bool hasNames() const;
+  /// Removes the row and column names from the problem and returns them, so that they can be stored elsewhere
+  ProblemNames releaseNames();
+  /// Restores names released earlier; returns false if the number of names does not match the problem
+  bool setNames(ProblemNames names);
+  [[nodiscard]] std::string columnName(index_t col) const;
+  [[nodiscard]] std::string rowName(index_t row) const;
+  /// Looks up a column by its name or its generated name; returns INVALID if there is no such column
+  [[nodiscard]] index_t findColumn(std::string_view colName) const;
+
   std::optional<Solution> convertExternalSolution(const ExternalSolution& solution) const;
   ExternalSolution convertSolution(const Solution& solution) const;
+  /// Converts the solution using the given column names, e.g. those of a problem which was read without names
+  ExternalSolution convertSolution(const Solution& solution, const NameTable& names) const;
   bool isFeasible(const Solution& solution) const;
   double computeObjective(const Solution& solution) const;
   void scale(const std::vector<double>& rowScale, const std::vector<double>& colScale);
 
+  /// The matrix in row-wise format. It is built on first use and shared (also with copies of the problem)
+  /// until the matrix is modified. The returned matrix stays valid as long as it is held, even if the problem changes.
+  [[nodiscard]] std::shared_ptr<const SparseMatrix> rowMatrix(index_t numThreads = 1) const;
 
   SparseMatrix matrix;
   //TODO: rename below so that col/row attribution is clearer
@@ -60,11 +116,10 @@ struct Problem {
   double objectiveOffset;
 
   std::string name;
-  std::vector<std::string> colNames;
-  std::vector<std::string> rowNames;
-
-  std::unordered_map<std::string,index_t> colToIndex;
-  std::unordered_map<std::string,index_t> rowToIndex;
+  NameTable colNames;
+  NameTable rowNames;
+private:
+  RowMatrixCache rowMatrixCache;
 };
 
 #endif //MIPWORKSHOP2024_SRC_PROBLEM_H
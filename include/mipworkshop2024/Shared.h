@@ -6,12 +6,24 @@
 #define MIPWORKSHOP2024_SRC_SHARED_H
 
 #include <string>
+#include <string_view>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 #include <optional>
 #include <vector>
 
+#ifdef MIPWORKSHOP2024_32BIT_INDICES
+using index_t = std::uint32_t;
+#else
 using index_t = std::size_t;
-static constexpr index_t INVALID = std::numeric_limits<std::size_t>::max();
+#endif
+static constexpr index_t INVALID = std::numeric_limits<index_t>::max();
+
+/// Returns true if count elements can be indexed by index_t; INVALID is never a valid index
+constexpr bool fitsInIndex(std::uint64_t count){
+  return count < static_cast<std::uint64_t>(INVALID);
+}
 
 constexpr double infinity = 1e100;
 constexpr double sumFeasTol = 1e-4;
@@ -40,6 +52,11 @@ inline bool isFeasLessOrEqualSum(double value, double other){
   return value-sumFeasTol <= other;
 }
 
+/// Parses a floating point number which makes up the entire token, using std::from_chars so that no std::string
+/// is allocated and the result does not depend on the locale. A leading '+' is accepted, as are inf and infinity.
+/// Out of range values overflow to infinity or underflow to zero, like std::strtod.
+std::optional<double> parseDouble(std::string_view token);
+
 struct Rat64{
     long int nominator;
     long int denominator;
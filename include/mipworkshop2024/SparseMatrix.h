@@ -6,7 +6,9 @@
 #define MIPWORKSHOP2024_SRC_SPARSEMATRIX_H
 
 #include "Shared.h"
+#include <cstdint>
 #include <vector>
+#include <span>
 #include "MatrixSlice.h"
 #include <cassert>
 
@@ -14,6 +16,18 @@ enum class SparseMatrixFormat{
   ROW_WISE,
   COLUMN_WISE
 };
+/// A number of consecutive primary vectors in compressed format, which can be built independently of the matrix
+/// (e.g. by one thread of a parallel reader) and be appended to it later.
+struct CompressedBlock{
+  std::vector<index_t> primaryStart{0};
+  std::vector<index_t> secondaryIndex;
+  std::vector<double> values;
+
+  [[nodiscard]] index_t numPrimary() const{
+    return primaryStart.size() - 1;
+  }
+};
+
 class SparseMatrix{
 public:
   SparseMatrix();
@@ -33,7 +47,7 @@ public:
   index_t addPrimaryVector(const MatrixSlice<StorageType>& slice){
 	  //TODO: check if sorted and if no double coefficients
 #ifndef NDEBUG
-	  for(const Nonzero& entry : slice){
+	  for(const auto& entry : slice){
 		  if(format == SparseMatrixFormat::ROW_WISE){
 			  assert(entry.index() >= 0 &&  entry.index() < num_cols );
 		  }else{
@@ -50,32 +64,141 @@ public:
 		  ++num_cols;
 	  }
 	  std::size_t numEntries = 0;
-	  for(const Nonzero& entry : slice){
+	  for(const auto& entry : slice){
 		  secondaryIndex.push_back(entry.index());
 		  values.push_back(entry.value());
 		  ++numEntries;
 	  }
 	  primaryStart.push_back(primaryStart.back() + numEntries);
+	  stamp = 0;
 	  return primary;
   }
   index_t addPrimaryVector(const std::vector<index_t>& secondaryEntries,
                      const std::vector<double>& values);
 
+  /// Reserves storage for a total of numPrimary primary vectors and numNonzeros entries
+  void reserve(index_t numPrimary, index_t numNonzeros);
+  /// Builder interface, which appends the entries of a new primary vector directly to the matrix storage.
+  /// The entries are only part of the matrix once finishPrimaryVector() is called, which returns the new vector's index.
+  void appendNonzero(index_t secondary, double value){
+    assert(secondary < (format == SparseMatrixFormat::ROW_WISE ? num_cols : num_rows));
+    secondaryIndex.push_back(secondary);
+    values.push_back(value);
+  }
+  index_t finishPrimaryVector();
+
+  /// Appends primary vectors given in compressed format, where blockStart has one more entry than the number of vectors
+  void appendPrimaryVectors(std::span<const index_t> blockStart,
+                            std::span<const index_t> blockIndex,
+                            std::span<const double> blockValues);
+  /// Appends the primary vectors of all blocks, in order. The blocks are copied into the matrix in parallel.
+  void appendPrimaryBlocks(const std::vector<CompressedBlock>& blocks, index_t numThreads = 1);
+
   [[nodiscard]] MatrixSlice<CompressedSlice> getPrimaryVector(index_t index) const;
 
-  [[nodiscard]] SparseMatrix transposedFormat() const;
+  /// Returns the matrix in the other format. With multiple threads, the primary vectors are split into blocks which are
+  /// counted and scattered in parallel; the result is identical to the serial transpose.
+  [[nodiscard]] SparseMatrix transposedFormat(index_t numThreads = 1) const;
 
   [[nodiscard]] index_t numSecondarySliceEntries(index_t primary) const{
 	  return primaryStart[primary+1] - primaryStart[primary];
   }
 
+  /// The underlying compressed storage; the entries of primary vector i are stored in [start[i],start[i+1])
+  [[nodiscard]] const std::vector<index_t>& getPrimaryStart() const{
+	  return primaryStart;
+  }
+  [[nodiscard]] const std::vector<index_t>& getSecondaryIndex() const{
+	  return secondaryIndex;
+  }
+  [[nodiscard]] const std::vector<double>& getValues() const{
+	  return values;
+  }
+
+  /// Identifies the current contents of the matrix, e.g. for caching data derived from it. Copies share the stamp of
+  /// the original, and every modification invalidates it. Assigning a new stamp modifies the matrix internally,
+  /// so this must not be called concurrently for the same matrix.
+  [[nodiscard]] std::uint64_t contentStamp() const;
+
 private:
+  void transposeSerial(SparseMatrix& transposed, index_t numPrimary, index_t numSecondary) const;
+  void transposeBlocked(SparseMatrix& transposed, index_t numPrimary, index_t numSecondary, index_t numBlocks) const;
+
   SparseMatrixFormat format;
   index_t num_rows;
   index_t num_cols;
   std::vector<index_t> primaryStart;
   std::vector<index_t> secondaryIndex;
   std::vector<double> values;
+  mutable std::uint64_t stamp = 0; //0 if no stamp was assigned since the last modification
+};
+
+/// Read-only copy of a SparseMatrix which stores the index and value of every nonzero next to each other.
+/// Loops which read both, such as the TU detection, then only touch a single array.
+class InterleavedSparseMatrix{
+public:
+  InterleavedSparseMatrix() = default;
+  explicit InterleavedSparseMatrix(const SparseMatrix& matrix);
+
+  [[nodiscard]] index_t numRows() const{
+    return num_rows;
+  }
+  [[nodiscard]] index_t numCols() const{
+    return num_cols;
+  }
+  [[nodiscard]] MatrixSlice<InterleavedSlice> getPrimaryVector(index_t index) const{
+    return {entries.data() + primaryStart[index], primaryStart[index+1] - primaryStart[index]};
+  }
+  [[nodiscard]] index_t numSecondarySliceEntries(index_t primary) const{
+    return primaryStart[primary+1] - primaryStart[primary];
+  }
+private:
+  index_t num_rows = 0;
+  index_t num_cols = 0;
+  std::vector<index_t> primaryStart{0};
+  std::vector<InterleavedNonzero> entries;
+};
+
+/// Read-only sign pattern of a SparseMatrix, which stores for every nonzero only its index and whether it is +1, -1
+/// or something else, the latter two as bitsets. Whether a primary vector consists of only +1 and -1 entries is
+/// precomputed, so that the TU detection can reject other vectors without reading their entries.
+class SignPatternMatrix{
+public:
+  SignPatternMatrix() = default;
+  explicit SignPatternMatrix(const SparseMatrix& matrix);
+
+  [[nodiscard]] index_t numRows() const{
+    return num_rows;
+  }
+  [[nodiscard]] index_t numCols() const{
+    return num_cols;
+  }
+  [[nodiscard]] MatrixSlice<SignSlice> getPrimaryVector(index_t index) const{
+    index_t start = primaryStart[index];
+    return {secondaryIndex.data() + start, negativeBits.data(), nonUnitBits.data(), start,
+            primaryStart[index+1] - start, allUnit[index]};
+  }
+  [[nodiscard]] index_t numSecondarySliceEntries(index_t primary) const{
+    return primaryStart[primary+1] - primaryStart[primary];
+  }
+  [[nodiscard]] const std::vector<index_t>& getPrimaryStart() const{
+    return primaryStart;
+  }
+  [[nodiscard]] const std::vector<index_t>& getSecondaryIndex() const{
+    return secondaryIndex;
+  }
+  /// Bit i % 64 of word i / 64 is set if nonzero i is negative
+  [[nodiscard]] const std::vector<std::uint64_t>& getNegativeBits() const{
+    return negativeBits;
+  }
+private:
+  index_t num_rows = 0;
+  index_t num_cols = 0;
+  std::vector<index_t> primaryStart{0};
+  std::vector<index_t> secondaryIndex;
+  std::vector<std::uint64_t> negativeBits;
+  std::vector<std::uint64_t> nonUnitBits;
+  std::vector<bool> allUnit;
 };
 
 
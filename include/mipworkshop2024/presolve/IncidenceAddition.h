@@ -55,10 +55,10 @@ private:
 
 		int signSum = 0;
 		int numEntries = 0;
-		for(const Nonzero& nonzero : slice){
+		for(const auto& nonzero : slice){
 			index_t secondaryIndex = nonzero.index();
 			if(!containsDense[secondaryIndex]) continue;
-			if (fabs(nonzero.value()) != 1.0) return false;
+			if (!isUnitEntry(nonzero)) return false;
 			if(numEntries >= 2){
 				return false; //A third entry means we have no way to add it
 			}
@@ -66,7 +66,7 @@ private:
 			entryRepresentatives[numEntries] = info.representative;
 			assert(info.representative >= 0);
 			assert(info.edgeSign == 1 || info.edgeSign == -1);
-			int sign = nonzero.value() > 0.0 ? 1 : -1;
+			int sign = isNegativeEntry(nonzero) ? -1 : 1;
 			signSum += info.edgeSign * sign;
 
 			entryIndex = secondaryIndex;
@@ -112,12 +112,12 @@ private:
 	{
 		assert(!containsDense[index]);
 		cleanupComponents();
-		for (const Nonzero& nonzero : slice)
+		for (const auto& nonzero : slice)
 		{
 			//There can be at most two nonzeros in each of the contained submatrices columns
 			index_t secondary = nonzero.index();
 			if (!containsSparse[secondary]) continue;
-			if (fabs(nonzero.value()) != 1.0) return false;
+			if (!isUnitEntry(nonzero)) return false;
 			if (sparseDimNumNonzeros[secondary] >= 2) return false;
 			assert((sparseDimNumNonzeros[secondary] == 0) == (sparseDimInfo[secondary].lastDimRow == -1));
 			int componentPrimary = sparseDimInfo[secondary].lastDimRow;
@@ -133,7 +133,7 @@ private:
 				int value = sparseDimInfo[secondary].lastDimSign * info.edgeSign;
 				assert(value == 1 || value == -1);
 				//Row needs to be reflected if the entries are the same sign, unreflected otherwise
-				if ((nonzero.value() > 0) == (value > 0))
+				if (!isNegativeEntry(nonzero) == (value > 0))
 				{
 					++components[info.representative].numReflected;
 				}
@@ -175,14 +175,14 @@ private:
 		int thisDenseIndex = index;
 		containsDense[index] = true;
 
-		for (const Nonzero& nonzero : slice)
+		for (const auto& nonzero : slice)
 		{
 			index_t sparseIndex = nonzero.index();
 			if (!containsSparse[sparseIndex]) continue;
 			if (sparseDimNumNonzeros[sparseIndex] == 0)
 			{ //TODO: can we remove this if branch?
 				sparseDimInfo[sparseIndex].lastDimRow = thisDenseIndex;
-				sparseDimInfo[sparseIndex].lastDimSign = nonzero.value() > 0.0 ? 1 : -1;
+				sparseDimInfo[sparseIndex].lastDimSign = isNegativeEntry(nonzero) ? -1 : 1;
 			}
 			++sparseDimNumNonzeros[sparseIndex];
 		}
@@ -39,6 +39,43 @@ bool SPQRNetworkDecompositionIsMinimal(const SPQRNetworkDecomposition * decompos
 void SPQRNetworkDecompositionRemoveComponents(SPQRNetworkDecomposition *dec, const spqr_row * componentRows,
                                              size_t numRows, const spqr_col  * componentCols, size_t numCols);
 
+/**
+ * Makes sure that the decomposition can hold at least the given number of arcs, members and nodes without having to
+ * grow its arrays. May not be called while a checkpoint is active.
+ */
+SPQR_ERROR SPQRNetworkDecompositionReserve(SPQRNetworkDecomposition *dec, int numArcs, int numMembers, int numNodes);
+
+/**
+ * Copies all members, nodes and arcs of other into dec, so that dec afterwards represents the direct sum of both matrices.
+ * Both decompositions must have the same dimensions and may not share any rows or columns. Other is not changed.
+ */
+SPQR_ERROR SPQRNetworkDecompositionMerge(SPQRNetworkDecomposition *dec, const SPQRNetworkDecomposition *other);
+
+/**
+ * Marks a checkpoint to which the decomposition can be restored. All changes made after the checkpoint, e.g. by row
+ * and column additions, are recorded in an undo log until SPQRNetworkDecompositionCommit() or
+ * SPQRNetworkDecompositionRollback() is called. Checkpoints can not be nested, and the decomposition may not be
+ * merged into while a checkpoint is active.
+ */
+void SPQRNetworkDecompositionCheckpoint(SPQRNetworkDecomposition *dec);
+
+/**
+ * Keeps all changes made since the checkpoint, and discards the undo log.
+ */
+void SPQRNetworkDecompositionCommit(SPQRNetworkDecomposition *dec);
+
+/**
+ * Restores the decomposition to the state it had at the checkpoint, in time proportional to the number of changes
+ * made since. Returns SPQR_ERROR_MEMORY if the undo log could not be stored, in which case the decomposition is left
+ * as is. The checkpoint is removed in either case.
+ */
+SPQR_ERROR SPQRNetworkDecompositionRollback(SPQRNetworkDecomposition *dec);
+
+/**
+ * Returns if a checkpoint is active
+ */
+bool SPQRNetworkDecompositionHasCheckpoint(const SPQRNetworkDecomposition *dec);
+
 typedef struct {
     size_t numComponents; //number of SPQR trees
     size_t numSkeletonsTypeS;
@@ -49,7 +86,18 @@ typedef struct {
     size_t numArcsTotalR;
 } SPQRNetworkDecompositionStatistics;
 SPQRNetworkDecompositionStatistics SPQRNetworkDecompositionGetStatistics(SPQRNetworkDecomposition *dec);
-//TODO: method to convert decomposition into a realization
+
+/**
+ * Computes a directed graph which realizes the decomposition. Every row and column of the decomposition becomes an arc
+ * from its tail to its head; the row arcs form a spanning forest of the graph. The entry of a column in a row is +1
+ * if the path from the tail to the head of the column in the forest traverses the row arc forwards, -1 if it
+ * traverses it backwards, and 0 otherwise. The nodes are numbered from 0 to *numNodes - 1.
+ * The row arrays must have room for numRows entries and the column arrays for numColumns entries, as passed to
+ * SPQRNetworkDecompositionCreate(). Rows and columns which are not in the decomposition get SPQR_INVALID_NODE.
+ */
+SPQR_ERROR SPQRNetworkDecompositionCreateRealization(const SPQRNetworkDecomposition *dec, int * numNodes,
+                                                     spqr_node * rowTails, spqr_node * rowHeads,
+                                                     spqr_node * columnTails, spqr_node * columnHeads);
 
 /**
  * A method to check if the cycle stored in the SPQR cycle matches the given array. Mostly useful in testing.
@@ -84,6 +132,13 @@ void SPQRfreeNetworkColumnAddition(SPQR* env, SPQRNetworkColumnAddition ** pNewC
  */
 SPQR_ERROR SPQRNetworkColumnAdditionCheck(SPQRNetworkDecomposition * dec, SPQRNetworkColumnAddition * newCol, spqr_col column,
                                           const spqr_row * nonzeroRows, const double * nonzeroValues, size_t numNonzeros);
+/**
+ * Like SPQRNetworkColumnAdditionCheck(), for a column whose entries are all +1 or -1. The sign of entry i is given by
+ * bit firstBit + i of negativeBits (bit b is bit b % 64 of word b / 64), which is set for -1 entries.
+ */
+SPQR_ERROR SPQRNetworkColumnAdditionCheckSigns(SPQRNetworkDecomposition * dec, SPQRNetworkColumnAddition * newCol,
+                                               spqr_col column, const spqr_row * nonzeroRows,
+                                               const uint64_t * negativeBits, size_t firstBit, size_t numNonzeros);
 /**
  * @brief Adds the most recently checked column from checkNewRow() to the Decomposition.
  * //TODO: specify (and implement) behavior in special cases (e.g. zero columns, columns with a single entry)
@@ -102,6 +157,23 @@ SPQR_ERROR SPQRNetworkColumnAdditionAdd(SPQRNetworkDecomposition *dec, SPQRNetwo
  */
 bool SPQRNetworkColumnAdditionRemainsNetwork(SPQRNetworkColumnAddition *newCol);
 
+/**
+ * Greedily adds a batch of columns: the candidates are checked one after the other, and every candidate which keeps
+ * the matrix network is added before the next one is checked.
+ * The columns are given in compressed sparse column format; column c has the nonzero rows
+ * nonzeroRows[columnStart[c]], ..., nonzeroRows[columnStart[c+1]-1]. The signs are given by nonzeroValues at the
+ * same positions or, if nonzeroValues is NULL, by the same bits of negativeBits as in
+ * SPQRNetworkColumnAdditionCheckSigns(). All entries of the candidates must be +1 or -1.
+ * @param candidates The columns to try, in order. None of them may be in the decomposition already.
+ * @param accepted Array of (numCandidates + 63) / 64 words, in which bit i % 64 of word i / 64 is set if candidates[i]
+ * was added, and cleared otherwise.
+ */
+SPQR_ERROR SPQRNetworkColumnAdditionBatch(SPQRNetworkDecomposition *dec, SPQRNetworkColumnAddition *newCol,
+                                          const spqr_col * candidates, size_t numCandidates,
+                                          const spqr_matrix_size * columnStart, const spqr_row * nonzeroRows,
+                                          const double * nonzeroValues, const uint64_t * negativeBits,
+                                          uint64_t * accepted);
+
 
 /**
  * This class stores all data for performing sequential row-additions to a matrix and checking if it is network or not.
@@ -128,6 +200,13 @@ void SPQRfreeNetworkRowAddition(SPQR* env, SPQRNetworkRowAddition ** pNewRow);
  */
 SPQR_ERROR SPQRNetworkRowAdditionCheck(SPQRNetworkDecomposition * dec, SPQRNetworkRowAddition * newRow, spqr_row row,
                                        const spqr_col * nonzeroCols, const double * nonzeroValues, size_t numNonzeros);
+/**
+ * Like SPQRNetworkRowAdditionCheck(), for a row whose entries are all +1 or -1, with signs given as in
+ * SPQRNetworkColumnAdditionCheckSigns().
+ */
+SPQR_ERROR SPQRNetworkRowAdditionCheckSigns(SPQRNetworkDecomposition * dec, SPQRNetworkRowAddition * newRow, spqr_row row,
+                                            const spqr_col * nonzeroCols, const uint64_t * negativeBits,
+                                            size_t firstBit, size_t numNonzeros);
 /**
  * @brief Adds the most recently checked column from checkNewRow() to the Decomposition.
  * //TODO: specify (and implement) behavior in special cases (e.g. zero rows, rows with a single entry?)
@@ -146,6 +225,15 @@ SPQR_ERROR SPQRNetworkRowAdditionAdd(SPQRNetworkDecomposition *dec, SPQRNetworkR
  */
 bool SPQRNetworkRowAdditionRemainsNetwork(const SPQRNetworkRowAddition *newRow);
 
+/**
+ * Like SPQRNetworkColumnAdditionBatch(), for a batch of rows which are given in compressed sparse row format.
+ */
+SPQR_ERROR SPQRNetworkRowAdditionBatch(SPQRNetworkDecomposition *dec, SPQRNetworkRowAddition *newRow,
+                                       const spqr_row * candidates, size_t numCandidates,
+                                       const spqr_matrix_size * rowStart, const spqr_col * nonzeroCols,
+                                       const double * nonzeroValues, const uint64_t * negativeBits,
+                                       uint64_t * accepted);
+
 
 #ifdef __cplusplus
 }
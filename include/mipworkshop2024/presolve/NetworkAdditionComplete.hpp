@@ -8,9 +8,15 @@
 
 #include <cassert>
 #include "mipworkshop2024/MatrixSlice.h"
+#include "mipworkshop2024/SparseMatrix.h"
 #include "mipworkshop2024/Submatrix.h"
 #include "mipworkshop2024/presolve/Network.h"
+#include <cstdint>
+#include <mutex>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 #define SPQR_CALL_THROW(x) \
    do                                                                                                   \
@@ -21,10 +27,44 @@
    }                                                                                                    \
    while( false )          \
 
+/// A directed graph realizing a network matrix. Every row and every column of the matrix is an arc from its tail to its
+/// head. If transposed is false, the row arcs form a spanning forest, and the entry of a column in a row is +1 or -1 if
+/// the path in the forest from the tail to the head of the column traverses the row arc forwards or backwards.
+/// If transposed is true, the roles of the rows and columns are swapped. Rows and columns which are not part of the
+/// network matrix have INVALID endpoints.
+struct NetworkRealization{
+    index_t numNodes = 0;
+    bool transposed = false;
+    std::vector<index_t> rowTails;
+    std::vector<index_t> rowHeads;
+    std::vector<index_t> columnTails;
+    std::vector<index_t> columnHeads;
+};
+
+/// Keeps SPQR environments, and with them the memory of the decompositions that were freed in them, so that
+/// later decompositions can reuse it. Environments can be acquired and released from multiple threads.
+class SPQREnvironmentPool
+{
+public:
+    SPQREnvironmentPool() = default;
+    SPQREnvironmentPool(const SPQREnvironmentPool&) = delete;
+    SPQREnvironmentPool& operator=(const SPQREnvironmentPool&) = delete;
+    ~SPQREnvironmentPool();
+
+    [[nodiscard]] SPQR * acquire();
+    void release(SPQR * env);
+    /// Frees the memory kept by all environments which are currently not acquired
+    void releaseMemory();
+private:
+    std::mutex mutex;
+    std::vector<SPQR *> environments;
+};
+
 /// This class contains the methods for an algorithm which tries to detect if a matrix has a network submatrix
 class NetworkAddition
 {
 private:
+    SPQREnvironmentPool * pool = nullptr;
     SPQR * env = NULL;
     SPQRNetworkDecomposition * dec = NULL;
     SPQRNetworkRowAddition * rowAddition = NULL;
@@ -37,17 +77,31 @@ private:
     template<typename Storage>
     bool tryAddNetworkRow(index_t index, const MatrixSlice<Storage>& slice)
     {
-        sliceBuffer.clear();
-        valueBuffer.clear();
-        for(const auto& nonzero : slice){
-            sliceBuffer.push_back(nonzero.index());
-            valueBuffer.push_back(nonzero.value());
-            if(fabs(nonzero.value()) != 1.0){
+        if constexpr (std::is_same_v<Storage,SignSlice>){
+            //The sign pattern can be passed as is, without copying it into the buffers
+            if(!slice.allUnit()){
                 return false;
             }
+            SPQR_CALL_THROW(SPQRNetworkRowAdditionCheckSigns(dec,rowAddition,index,slice.indices(),
+                                                             slice.negativeBits(),slice.firstBit(),slice.size()));
+            return addCheckedRow();
+        }else{
+            sliceBuffer.clear();
+            valueBuffer.clear();
+            for(const auto& nonzero : slice){
+                sliceBuffer.push_back(nonzero.index());
+                valueBuffer.push_back(nonzero.value());
+                if(fabs(nonzero.value()) != 1.0){
+                    return false;
+                }
+            }
+            SPQR_CALL_THROW(SPQRNetworkRowAdditionCheck(dec,rowAddition,index,sliceBuffer.data(),
+                                                        valueBuffer.data(),sliceBuffer.size()));
+            return addCheckedRow();
         }
-        SPQR_CALL_THROW(SPQRNetworkRowAdditionCheck(dec,rowAddition,index,sliceBuffer.data(),
-                                                    valueBuffer.data(),sliceBuffer.size()));
+    }
+    bool addCheckedRow()
+    {
         if(SPQRNetworkRowAdditionRemainsNetwork(rowAddition)){
             SPQR_CALL_THROW(SPQRNetworkRowAdditionAdd(dec,rowAddition));
             return true;
@@ -58,17 +112,30 @@ private:
     template<typename Storage>
     bool tryAddNetworkCol(index_t index, const MatrixSlice<Storage>& slice)
     {
-        sliceBuffer.clear();
-        valueBuffer.clear();
-        for(const auto& nonzero : slice){
-            sliceBuffer.push_back(nonzero.index());
-            valueBuffer.push_back(nonzero.value());
-            if(fabs(nonzero.value()) != 1.0){
+        if constexpr (std::is_same_v<Storage,SignSlice>){
+            if(!slice.allUnit()){
                 return false;
             }
+            SPQR_CALL_THROW(SPQRNetworkColumnAdditionCheckSigns(dec,colAddition,index,slice.indices(),
+                                                                slice.negativeBits(),slice.firstBit(),slice.size()));
+            return addCheckedColumn();
+        }else{
+            sliceBuffer.clear();
+            valueBuffer.clear();
+            for(const auto& nonzero : slice){
+                sliceBuffer.push_back(nonzero.index());
+                valueBuffer.push_back(nonzero.value());
+                if(fabs(nonzero.value()) != 1.0){
+                    return false;
+                }
+            }
+            SPQR_CALL_THROW(SPQRNetworkColumnAdditionCheck(dec,colAddition,index,sliceBuffer.data(),
+                                                           valueBuffer.data(),sliceBuffer.size()));
+            return addCheckedColumn();
         }
-        SPQR_CALL_THROW(SPQRNetworkColumnAdditionCheck(dec,colAddition,index,sliceBuffer.data(),
-                                                       valueBuffer.data(),sliceBuffer.size()));
+    }
+    bool addCheckedColumn()
+    {
         if(SPQRNetworkColumnAdditionRemainsNetwork(colAddition)){
             SPQR_CALL_THROW(SPQRNetworkColumnAdditionAdd(dec,colAddition));
             return true;
@@ -78,11 +145,16 @@ private:
 
 public:
 
+    /// If a pool is given, the decomposition is allocated in an environment from it, which is returned on destruction
     NetworkAddition(index_t numRows, index_t numCols,
                     Submatrix::Initialization init = Submatrix::INIT_NONE,
-                    bool transposed = false);
+                    bool transposed = false,
+                    SPQREnvironmentPool * pool = nullptr);
     ~NetworkAddition();
 
+    /// Preallocates the decomposition for a network submatrix with the given number of rows and columns
+    void reserve(index_t numRows, index_t numCols);
+
     template<typename Storage>
     bool tryAddCol(index_t col, const MatrixSlice<Storage>& colSlice)
     {
@@ -110,11 +182,26 @@ public:
     }
 
 
+    /// Tries to add the given columns of columnMatrix one after another, and keeps every column for which the
+    /// submatrix remains network. This is equivalent to calling tryAddCol() for every candidate, but passes the whole
+    /// batch to the decomposition at once. All entries of the candidates must be +1 or -1.
+    /// Bit i % 64 of accepted[i / 64] is set if candidates[i] was added. Returns the number of added columns.
+    index_t tryAddCols(const SignPatternMatrix& columnMatrix, std::span<const index_t> candidates,
+                       std::vector<std::uint64_t>& accepted);
+
     [[nodiscard]] bool containsColumn(index_t col) const;
     [[nodiscard]] bool containsRow(index_t row) const;
-    //Hacky method to remove. Assumes that the given rows/columns form one connected component in the current decomposition
-    void removeComponent(const std::vector<index_t>& rows, const std::vector<index_t>& columns);
+    /// Marks a checkpoint; all later additions are undone by rollback(), or kept by commit()
+    void checkpoint();
+    void commit();
+    /// Restores the decomposition to the checkpoint, in time proportional to the changes made since
+    void rollback();
     [[nodiscard]] Submatrix createSubmatrix(index_t numRows, index_t numCols) const;
+    /// Returns a directed graph realizing the submatrix given by createSubmatrix()
+    [[nodiscard]] NetworkRealization createRealization(index_t numRows, index_t numCols) const;
+    /// Adds the decomposition of other to this one. Both must have the same dimensions and orientation,
+    /// and may not contain any common rows or columns.
+    void merge(const NetworkAddition& other);
 
     [[nodiscard]] SPQRNetworkDecompositionStatistics statistics() const;
 };
@@ -0,0 +1,22 @@
+//
+// Created by rolf on 17-10-26.
+//
+
+#ifndef MIPWORKSHOP2024_NETWORKPOSTSOLVE_H
+#define MIPWORKSHOP2024_NETWORKPOSTSOLVE_H
+
+#include "mipworkshop2024/Problem.h"
+#include "mipworkshop2024/Solution.h"
+#include "mipworkshop2024/presolve/PostSolveStack.h"
+
+/// Makes the submatColumns of the given reduction integral by solving the LP over the submatrix as a minimum cost flow
+/// problem if the submatrix is a network matrix, or as the dual problem over node potentials if its transpose is a
+/// network matrix. The implyingColumns must already be integral in currentSol.
+/// Returns false without changing currentSol if neither the submatrix nor its transpose is a network matrix, if its
+/// bounds are not integral or too large, or if the flow problem has no optimal solution; the LP then needs to be solved
+/// by a general LP solver.
+bool solveNetworkTUSubmatrix(const Problem& problem,
+                             const TotallyUnimodularColumnSubmatrix& submatrix,
+                             Solution& currentSol);
+
+#endif //MIPWORKSHOP2024_NETWORKPOSTSOLVE_H
@@ -0,0 +1,165 @@
+//
+// Created by rolf on 17-10-26.
+//
+// The spanning tree method of this class (the thread-based tree representation, the block search pivot rule and the
+// tree and potential updates) is adapted from the NetworkSimplex class of LEMON, a generic C++ optimization library
+// (https://lemon.cs.elte.hu), which is distributed under the following notice:
+//
+//  Copyright (C) 2003-2013
+//  Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+//  (Egervary Research Group on Combinatorial Optimization, EGRES).
+//
+//  Permission to use, modify and distribute this software is granted
+//  provided that this copyright notice appears in all copies. For
+//  precise terms see the accompanying LICENSE file.
+//
+//  This software is provided "AS IS" with no warranty of any kind,
+//  express or implied, and with no claim as to its suitability for any
+//  purpose.
+//
+// The LICENSE file of LEMON is the Boost Software License, Version 1.0:
+//
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef MIPWORKSHOP2024_NETWORKSIMPLEX_H
+#define MIPWORKSHOP2024_NETWORKSIMPLEX_H
+
+#include "mipworkshop2024/Shared.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/// Finds a minimum cost flow with the primal network simplex method. With integral flows, the optimal flow is integral,
+/// which is exactly what is needed to make the columns of a network submatrix integral. Floating point flows are used
+/// for transposed network submatrices, where the integral solution is given by the optimal node potentials instead.
+/// Instantiated for std::int64_t and double.
+template<typename Value>
+class NetworkSimplex
+{
+public:
+    using Flow = Value;
+    static constexpr Flow INFINITE_BOUND = std::numeric_limits<Flow>::max();
+    /// Largest absolute value of a finite bound and supply of integral flows, which keeps all intermediate flows far
+    /// away from overflowing
+    static constexpr Flow MAX_BOUND = static_cast<Flow>(std::int64_t(1) << 40);
+
+    enum class Status{
+        OPTIMAL,
+        INFEASIBLE,
+        UNBOUNDED,
+        TOO_LARGE //the bounds are so large that the flows might not fit in a Flow
+    };
+
+    explicit NetworkSimplex(index_t numNodes);
+
+    /// Adds an arc from tail to head with the given flow bounds and cost per unit of flow, and returns its index.
+    /// The lower bound may be -INFINITE_BOUND and the upper bound INFINITE_BOUND; for integral flows, finite bounds may
+    /// not exceed MAX_BOUND in absolute value.
+    index_t addArc(index_t tail, index_t head, Flow lower, Flow upper, double cost);
+    /// Increases the supply of the node, which is the amount by which the flow leaving it must exceed the flow entering
+    /// it. All supplies are zero initially, so that solve() finds a circulation.
+    void addSupply(index_t node, Flow amount);
+
+    /// Computes a flow of minimum cost, which satisfies the supply of every node
+    Status solve();
+    /// Returns the flow on the given arc in the flow found by solve()
+    [[nodiscard]] Flow flow(index_t arc) const;
+    [[nodiscard]] double totalCost() const;
+    /// Returns the potential of the node in the optimal dual solution found by solve(): the reduced cost
+    /// cost + potential(tail) - potential(head) of every arc is nonnegative if its flow is below its upper bound, and
+    /// nonpositive if its flow is above its lower bound. The potentials are integral and exact if all costs are integers
+    /// and 2 * (max |cost| + 1) * (numNodes + 1) is below 2^53.
+    [[nodiscard]] double potential(index_t node) const;
+
+private:
+    struct InputArc{
+        index_t tail;
+        index_t head;
+        Flow lower;
+        Flow upper;
+        double cost;
+    };
+    index_t numNodes;
+    std::vector<InputArc> inputArcs;
+    std::vector<Flow> inputSupply;
+    std::vector<Flow> inputFlows;
+
+    //The arrays of the spanning tree method, in which the real arcs are followed by one artificial arc for every node,
+    //which connects it to the artificial root node
+    enum ArcState : signed char{
+        STATE_UPPER = -1,
+        STATE_TREE = 0,
+        STATE_LOWER = 1
+    };
+    enum Direction : signed char{
+        DIR_DOWN = -1,
+        DIR_UP = 1
+    };
+    index_t numArcs = 0;
+    index_t root = 0;
+    std::vector<index_t> source;
+    std::vector<index_t> target;
+    std::vector<Flow> lowerBound; //the internal arcs have lower bound 0, the flows are shifted by these bounds
+    std::vector<Flow> capacity;
+    std::vector<double> cost;
+    std::vector<Flow> flows;
+    std::vector<ArcState> state;
+    std::vector<Flow> supply;
+
+    std::vector<double> potentials;
+    std::vector<index_t> parent;
+    std::vector<index_t> pred;
+    std::vector<Direction> predDir;
+    std::vector<index_t> thread;
+    std::vector<index_t> revThread;
+    std::vector<index_t> succNum;
+    std::vector<index_t> lastSucc;
+    std::vector<index_t> dirtyRevs;
+
+    index_t inArc = 0;
+    index_t joinNode = 0;
+    index_t uIn = 0;
+    index_t vIn = 0;
+    index_t uOut = 0;
+    Flow delta = 0;
+    index_t nextSearchArc = 0;
+    double tolerance = 0.0;
+    Flow flowTolerance = 0; //zero for integral flows
+
+    void addInternalArc(index_t tail, index_t head, Flow lower, Flow upper, double arcCost);
+    void initializeTree();
+    bool findEnteringArc(index_t blockSize);
+    void findJoinNode();
+    bool findLeavingArc();
+    void changeFlow(bool change);
+    void updateTreeStructure();
+    void updatePotential();
+};
+
+extern template class NetworkSimplex<std::int64_t>;
+extern template class NetworkSimplex<double>;
+
+#endif //MIPWORKSHOP2024_NETWORKSIMPLEX_H
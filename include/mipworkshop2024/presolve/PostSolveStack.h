@@ -7,6 +7,10 @@
 
 #include "mipworkshop2024/Shared.h"
 #include "mipworkshop2024/Solution.h"
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
 #include <vector>
 #include <variant>
 #include "mipworkshop2024/json.hpp"
@@ -41,4 +45,15 @@ public:
 nlohmann::json postSolveToJson(const PostSolveStack& stack);
 
 PostSolveStack postSolveFromJson(const nlohmann::json& json);
+
+/// The binary postsolve format starts with the magic bytes, a version, flags, the number of reductions, and the size
+/// and crc32 checksum of the payload, all little-endian. For each reduction, the payload stores the lists submatRows,
+/// implyingColumns and submatColumns, each as a varint count followed by the zigzag varint encoded differences between
+/// consecutive indices. Sorted lists thus take one or two bytes per index, but any order is preserved.
+constexpr std::array<char,8> POSTSOLVE_BINARY_MAGIC = {'M','I','P','W','P','S','T','K'};
+constexpr std::uint32_t POSTSOLVE_BINARY_VERSION = 1;
+
+bool postSolveToBinary(const PostSolveStack& stack, std::ostream& stream);
+/// Reads a stack in the binary format, including the magic bytes. Returns std::nullopt if the data is corrupted.
+std::optional<PostSolveStack> postSolveFromBinary(std::istream& stream);
 #endif //MIPWORKSHOP2024_SRC_PRESOLVE_POSTSOLVESTACK_H
@@ -10,6 +10,7 @@
 #include <assert.h>
 #include <stdbool.h> //defines bool when c++ is not defined
 #include <limits.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C"{
@@ -46,14 +47,28 @@ do                                                  \
 
 
 
+///Number of freed block arrays which an environment keeps for reuse
+#define SPQR_MAX_CACHED_BLOCKS 64
+
+/**
+ * The environment acts as an arena for block arrays: arrays which are freed are kept, and are handed out again by
+ * later allocations which fit in them. Decompositions which are created one after the other in the same environment
+ * therefore reuse each others memory. An environment may only be used by one thread at a time.
+ */
 struct SPQR_ENVIRONMENT{
     FILE * output;
+    void * cachedBlocks[SPQR_MAX_CACHED_BLOCKS];
+    int numCachedBlocks;
 };
 
 typedef struct SPQR_ENVIRONMENT SPQR;
 
 SPQR_ERROR SPQRcreateEnvironment(SPQR** pSpqr);
 SPQR_ERROR SPQRfreeEnvironment(SPQR** pSpqr);
+/**
+ * Frees all block arrays which are kept for reuse. Arrays which are still in use are not affected.
+ */
+void SPQRreleaseEnvironmentMemory(SPQR * env);
 //TODO: rename these impl() to SPQRimpl
 
 #define SPQRallocBlockArray(spqr, ptr, length) \
@@ -83,11 +98,17 @@ void implSPQRfreeBlock(SPQR * env, void **ptr);
 ///Types which define matrix sizes
 ///Aliased so that switching is much easier if ever desired
 
+///Follows index_t (see Shared.h), so that rows and columns can be passed without conversion
+#ifdef MIPWORKSHOP2024_32BIT_INDICES
+typedef uint32_t spqr_matrix_size;
+#define SPQR_INVALID UINT32_MAX
+#else
 typedef size_t spqr_matrix_size;
+#define SPQR_INVALID ULLONG_MAX //TODO: this should maybe be ULLONG_MAX or SSIZE_MAX? Check...
+#endif
 typedef spqr_matrix_size spqr_row;
 typedef spqr_matrix_size spqr_col;
 
-#define SPQR_INVALID ULLONG_MAX //TODO: this should maybe be ULLONG_MAX or SSIZE_MAX? Check...
 #define SPQR_INVALID_ROW SPQR_INVALID
 #define SPQR_INVALID_COL SPQR_INVALID
 
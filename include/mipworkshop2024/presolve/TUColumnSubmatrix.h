@@ -8,12 +8,21 @@
 #include "mipworkshop2024/Problem.h"
 #include "mipworkshop2024/Submatrix.h"
 #include "mipworkshop2024/presolve/PostSolveStack.h"
+#include "mipworkshop2024/presolve/NetworkAdditionComplete.hpp"
 #include "mipworkshop2024/Logging.h"
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <optional>
 
 struct TUSettings{
     bool doDowngrade; //downgrade binary/integer variables to implied integers?
     VariableType writeType; //What type to write the implied integers as?
     bool dynamic; //Dynamically decide if we should up/downgrade to
+    index_t numThreads = 0; //Threads used for finding components and running the detection strategies; 0 uses all hardware threads
+    index_t targetColumns = 0; //Cancel the remaining strategies once one finds a submatrix with this many columns; 0 never cancels
+    double timeLimit = std::numeric_limits<double>::infinity(); //Seconds after which detection keeps the submatrices found so far
 };
 
 enum class TUColumnType{
@@ -31,7 +40,9 @@ public:
 private:
     TUSettings settings;
 	Problem& problem;
-	SparseMatrix rowMatrix;
+	//Apart from the column types, the detection only needs to know which entries are +1 or -1
+	SignPatternMatrix columnMatrix;
+	SignPatternMatrix rowMatrix;
 
 	index_t numContinuousRequired;
 	index_t numContinuousDisconnected;
@@ -43,6 +54,9 @@ private:
 	std::vector<index_t> nonIntegralRows;
 
     std::vector<DetectionStatistics> detectionStatistics;
+	std::chrono::steady_clock::time_point deadline; //set from settings.timeLimit when detection starts
+	//The network decompositions of all strategies and their tasks reuse the memory of earlier decompositions
+	mutable SPQREnvironmentPool environmentPool;
 
 	void computeRowAndColumnTypes();
 	[[nodiscard]] TotallyUnimodularColumnSubmatrix computeImplyingColumns(const Submatrix& submatrix) const;
@@ -52,20 +66,36 @@ private:
 		std::vector<index_t> rows;
 		std::vector<index_t> cols;
 	};
-	[[nodiscard]] Submatrix computeIncidenceSubmatrix(bool transposed,
+	/// Returns, in increasing order, the smallest continuous column of every connected component of the
+	/// continuous columns, which is the column from which the serial search discovers the component
+	[[nodiscard]] std::vector<index_t> findContinuousComponentStarts() const;
+	/// Collects the rows and continuous columns of the component containing startColumn by depth-first search,
+	/// labeling them with the given component and counting their entries in the continuous submatrix.
+	/// Components are disjoint, so different components may be traversed concurrently.
+	void traverseContinuousComponent(index_t startColumn, long componentLabel, Component& component,
+			std::vector<long>& rowComponent, std::vector<long>& colComponent,
+			std::vector<long>& nRowEntries, std::vector<long>& nColEntries) const;
+	/// The detection strategies only read the finder, so that they can run concurrently.
+	/// They return std::nullopt if they notice that cancelled was set before they finished.
+	[[nodiscard]] std::optional<Submatrix> computeIncidenceSubmatrix(bool transposed,
 			const std::vector<Component>& components,
 			const std::vector<bool>& componentValid,
 			const std::vector<long>& nRowEntries,
 			const std::vector<long>& nColEntries,
-			const std::vector<long>& rowComponents);
-    [[nodiscard]] Submatrix computeNetworkSubmatrix(
+			const std::vector<long>& rowComponents,
+			const std::atomic<bool>& cancelled,
+			DetectionStatistics& stats) const;
+    [[nodiscard]] std::optional<Submatrix> computeNetworkSubmatrix(
             bool transposed,
             const std::vector<Component>& components,
             const std::vector<bool>& componentValid,
-            const std::vector<long>& rowComponents);
+            const std::vector<long>& rowComponents,
+            index_t numThreads,
+            const std::atomic<bool>& cancelled,
+            DetectionStatistics& stats) const;
 
-	[[nodiscard]] MatrixSlice<CompressedSlice> getRowVector(index_t index) const;
-	[[nodiscard]] MatrixSlice<CompressedSlice> getColumnVector(index_t index) const;
+	[[nodiscard]] MatrixSlice<SignSlice> getRowVector(index_t index) const;
+	[[nodiscard]] MatrixSlice<SignSlice> getColumnVector(index_t index) const;
 
 };
 
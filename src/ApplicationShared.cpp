@@ -74,7 +74,12 @@ bool doPresolve(const std::string &problemPath,
 
     {
         start = std::chrono::high_resolution_clock::now();
-        if (!writeMPSFile(presolver.presolvedProblem(), presolvedProblemPath)) {
+        //Paths without a .gz extension are asked to be written uncompressed
+        MPSWriteSettings writeSettings{
+                .compress = std::filesystem::path(presolvedProblemPath).extension() == ".gz",
+                .numCompressionThreads = 0
+        };
+        if (!writeMPSFile(presolver.presolvedProblem(), presolvedProblemPath, writeSettings)) {
             std::cerr << "Could not write to: " << presolvedProblemPath << "\n";
             return false;
         }
@@ -139,7 +144,7 @@ bool doPostsolve(const std::string &problemPath,
         return false;
     }
 
-    auto postSolveStream = std::ifstream(postSolvePath);
+    auto postSolveStream = std::ifstream(postSolvePath, std::ios::binary);
     auto postSolveStack = postSolveStackFromStream(postSolveStream);
     if(!postSolveStack.has_value()){
         std::cerr << "Error reading postsolve file at: " << postSolvePath << "\n";
@@ -0,0 +1,313 @@
+//
+// Created by rolf on 17-10-26.
+//
+
+#include "mipworkshop2024/BinaryProblem.h"
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_set>
+
+namespace {
+
+constexpr std::size_t SECTION_ALIGNMENT = 8;
+
+std::uint64_t alignSection(std::uint64_t offset){
+  return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+constexpr std::size_t sectionIndex(BinaryProblemSection section){
+  return static_cast<std::size_t>(section);
+}
+
+std::size_t elementSize(BinaryProblemSection section){
+  switch(section){
+  case BinaryProblemSection::PRIMARY_START:
+  case BinaryProblemSection::SECONDARY_INDEX: return sizeof(index_t);
+  case BinaryProblemSection::COLUMN_TYPE: return sizeof(std::uint8_t);
+  case BinaryProblemSection::NAME_OFFSETS: return sizeof(std::uint64_t);
+  case BinaryProblemSection::NAME_CHARS: return sizeof(char);
+  default: return sizeof(double);
+  }
+}
+
+class SectionWriter{
+public:
+  explicit SectionWriter(std::ofstream& stream) : stream{stream}, position{sizeof(BinaryProblemHeader)}{}
+
+  template<typename T>
+  BinaryProblemSectionLocation write(const T * data, std::size_t numElements){
+    pad();
+    BinaryProblemSectionLocation location{position,numElements};
+    std::size_t numBytes = numElements * sizeof(T);
+    if(numBytes != 0){
+      stream.write(reinterpret_cast<const char*>(data),static_cast<std::streamsize>(numBytes));
+    }
+    position += numBytes;
+    return location;
+  }
+  void pad(){
+    static constexpr char zeros[SECTION_ALIGNMENT] = {};
+    std::uint64_t aligned = alignSection(position);
+    stream.write(zeros,static_cast<std::streamsize>(aligned-position));
+    position = aligned;
+  }
+private:
+  std::ofstream& stream;
+  std::uint64_t position;
+};
+
+}
+
+bool writeBinaryProblemFile(const Problem& problem, const std::filesystem::path& path){
+  std::ofstream stream(path,std::ios::binary | std::ios::trunc);
+  if(!stream.is_open()){
+    std::cerr<<"Could not open file: "<<path<<" for writing\n";
+    return false;
+  }
+  const SparseMatrix& matrix = problem.matrix;
+
+  BinaryProblemHeader header{};
+  header.magic = BINARY_PROBLEM_MAGIC;
+  header.version = BINARY_PROBLEM_VERSION;
+  header.byteOrderMark = BINARY_PROBLEM_BYTE_ORDER_MARK;
+  header.indexSize = sizeof(index_t);
+  header.sense = problem.sense == ObjSense::MAXIMIZE ? 1 : 0;
+  header.numRows = problem.numRows();
+  header.numCols = problem.numCols();
+  header.numNonzeros = matrix.getValues().size();
+  header.objectiveOffset = problem.objectiveOffset;
+  //The header is written last, once all section locations are known
+  stream.write(reinterpret_cast<const char*>(&header),sizeof(header));
+
+  std::vector<std::uint8_t> colTypes(problem.numCols());
+  for(index_t i = 0; i < problem.numCols(); ++i){
+    colTypes[i] = static_cast<std::uint8_t>(problem.colType[i]);
+  }
+  std::vector<std::uint64_t> nameOffsets;
+  nameOffsets.reserve(1 + problem.numCols() + problem.numRows() + 1);
+  std::string nameChars;
+  auto addName = [&](std::string_view name){
+    nameOffsets.push_back(nameChars.size());
+    nameChars.append(name);
+    nameChars.push_back('\0');
+  };
+  addName(problem.name);
+  for(index_t col = 0; col < problem.numCols(); ++col){
+    addName(problem.columnName(col));
+  }
+  for(index_t row = 0; row < problem.numRows(); ++row){
+    addName(problem.rowName(row));
+  }
+  nameOffsets.push_back(nameChars.size());
+
+  SectionWriter writer(stream);
+  auto& sections = header.sections;
+  using Section = BinaryProblemSection;
+  sections[sectionIndex(Section::PRIMARY_START)] = writer.write(matrix.getPrimaryStart().data(),matrix.getPrimaryStart().size());
+  sections[sectionIndex(Section::SECONDARY_INDEX)] = writer.write(matrix.getSecondaryIndex().data(),matrix.getSecondaryIndex().size());
+  sections[sectionIndex(Section::VALUES)] = writer.write(matrix.getValues().data(),matrix.getValues().size());
+  sections[sectionIndex(Section::OBJECTIVE)] = writer.write(problem.obj.data(),problem.obj.size());
+  sections[sectionIndex(Section::LOWER_BOUND)] = writer.write(problem.lb.data(),problem.lb.size());
+  sections[sectionIndex(Section::UPPER_BOUND)] = writer.write(problem.ub.data(),problem.ub.size());
+  sections[sectionIndex(Section::COLUMN_TYPE)] = writer.write(colTypes.data(),colTypes.size());
+  sections[sectionIndex(Section::LHS)] = writer.write(problem.lhs.data(),problem.lhs.size());
+  sections[sectionIndex(Section::RHS)] = writer.write(problem.rhs.data(),problem.rhs.size());
+  sections[sectionIndex(Section::NAME_OFFSETS)] = writer.write(nameOffsets.data(),nameOffsets.size());
+  sections[sectionIndex(Section::NAME_CHARS)] = writer.write(nameChars.data(),nameChars.size());
+  writer.pad();
+
+  stream.seekp(0);
+  stream.write(reinterpret_cast<const char*>(&header),sizeof(header));
+  stream.close();
+  if(!stream){
+    std::cerr<<"Could not write binary problem file: "<<path<<"\n";
+    return false;
+  }
+  return true;
+}
+
+std::optional<BinaryProblemView> BinaryProblemView::open(const std::filesystem::path& path){
+  BinaryProblemView view;
+  try{
+    view.file.open(path.string());
+  }catch(const std::ios_base::failure& failure){
+    std::cerr<<"Could not memory-map file: "<<path<<", "<<failure.what()<<"\n";
+    return std::nullopt;
+  }
+  if(view.file.size() < sizeof(BinaryProblemHeader)){
+    std::cerr<<"File "<<path<<" is too small to be a binary problem file\n";
+    return std::nullopt;
+  }
+  const BinaryProblemHeader& header = view.header();
+  if(header.magic != BINARY_PROBLEM_MAGIC){
+    std::cerr<<"File "<<path<<" is not a binary problem file\n";
+    return std::nullopt;
+  }
+  if(header.version != BINARY_PROBLEM_VERSION){
+    std::cerr<<"Binary problem file "<<path<<" has version "<<header.version<<", but only version "
+             <<BINARY_PROBLEM_VERSION<<" is supported\n";
+    return std::nullopt;
+  }
+  if(header.byteOrderMark != BINARY_PROBLEM_BYTE_ORDER_MARK || header.indexSize != sizeof(index_t)){
+    std::cerr<<"Binary problem file "<<path<<" was written on a platform with a different byte order or index size\n";
+    return std::nullopt;
+  }
+  std::uint64_t numNames = 1 + header.numCols + header.numRows;
+  std::array<std::uint64_t,sectionIndex(BinaryProblemSection::NUM_SECTIONS)> expectedSizes = {
+      header.numCols + 1, header.numNonzeros, header.numNonzeros,
+      header.numCols, header.numCols, header.numCols, header.numCols,
+      header.numRows, header.numRows,
+      numNames + 1, header.sections[sectionIndex(BinaryProblemSection::NAME_CHARS)].size
+  };
+  for(std::size_t i = 0; i < header.sections.size(); ++i){
+    const auto& location = header.sections[i];
+    std::uint64_t numBytes = location.size * elementSize(static_cast<BinaryProblemSection>(i));
+    if(location.size != expectedSizes[i] || location.offset % SECTION_ALIGNMENT != 0 ||
+       location.offset > view.file.size() || numBytes > view.file.size() - location.offset){
+      std::cerr<<"Binary problem file "<<path<<" is corrupted\n";
+      return std::nullopt;
+    }
+  }
+  //Check the contents which are used for indexing, so that corrupted files can not cause out of bounds accesses
+  auto primaryStart = view.section<index_t>(BinaryProblemSection::PRIMARY_START);
+  bool good = primaryStart.front() == 0 && primaryStart.back() == header.numNonzeros;
+  for(std::size_t i = 1; i < primaryStart.size() && good; ++i){
+    good = primaryStart[i-1] <= primaryStart[i];
+  }
+  for(index_t index : view.section<index_t>(BinaryProblemSection::SECONDARY_INDEX)){
+    good = good && index < header.numRows;
+  }
+  auto nameOffsets = view.section<std::uint64_t>(BinaryProblemSection::NAME_OFFSETS);
+  auto nameChars = view.section<char>(BinaryProblemSection::NAME_CHARS);
+  good = good && nameOffsets.front() == 0 && nameOffsets.back() == nameChars.size();
+  for(std::size_t i = 1; i < nameOffsets.size() && good; ++i){
+    good = nameOffsets[i-1] < nameOffsets[i] && nameChars[nameOffsets[i]-1] == '\0';
+  }
+  for(std::uint8_t type : view.section<std::uint8_t>(BinaryProblemSection::COLUMN_TYPE)){
+    good = good && type <= static_cast<std::uint8_t>(VariableType::IMPLIED_INTEGER);
+  }
+  //Duplicate names can not be interned in a NameTable by toProblem()
+  auto hasUniqueNames = [&view](index_t first, index_t numNames){
+    std::unordered_set<std::string_view,NameHash,std::equal_to<>> names;
+    names.reserve(numNames);
+    for(index_t i = first; i < first + numNames; ++i){
+      if(!names.insert(view.name(i)).second){
+        return false;
+      }
+    }
+    return true;
+  };
+  good = good && hasUniqueNames(1,view.numCols()) && hasUniqueNames(1 + view.numCols(),view.numRows());
+  if(!good){
+    std::cerr<<"Binary problem file "<<path<<" is corrupted\n";
+    return std::nullopt;
+  }
+  return view;
+}
+
+const BinaryProblemHeader& BinaryProblemView::header() const{
+  return *reinterpret_cast<const BinaryProblemHeader*>(file.data());
+}
+
+template<typename T>
+std::span<const T> BinaryProblemView::section(BinaryProblemSection section) const{
+  const auto& location = header().sections[sectionIndex(section)];
+  return {reinterpret_cast<const T*>(file.data() + location.offset),location.size};
+}
+
+index_t BinaryProblemView::numRows() const{
+  return header().numRows;
+}
+index_t BinaryProblemView::numCols() const{
+  return header().numCols;
+}
+index_t BinaryProblemView::numNonzeros() const{
+  return header().numNonzeros;
+}
+MatrixSlice<CompressedSlice> BinaryProblemView::column(index_t col) const{
+  auto primaryStart = section<index_t>(BinaryProblemSection::PRIMARY_START);
+  index_t start = primaryStart[col];
+  index_t end = primaryStart[col+1];
+  return {section<index_t>(BinaryProblemSection::SECONDARY_INDEX).data() + start,
+          section<double>(BinaryProblemSection::VALUES).data() + start,
+          end - start};
+}
+std::span<const double> BinaryProblemView::objective() const{
+  return section<double>(BinaryProblemSection::OBJECTIVE);
+}
+std::span<const double> BinaryProblemView::lowerBounds() const{
+  return section<double>(BinaryProblemSection::LOWER_BOUND);
+}
+std::span<const double> BinaryProblemView::upperBounds() const{
+  return section<double>(BinaryProblemSection::UPPER_BOUND);
+}
+VariableType BinaryProblemView::columnType(index_t col) const{
+  return static_cast<VariableType>(section<std::uint8_t>(BinaryProblemSection::COLUMN_TYPE)[col]);
+}
+std::span<const double> BinaryProblemView::lhs() const{
+  return section<double>(BinaryProblemSection::LHS);
+}
+std::span<const double> BinaryProblemView::rhs() const{
+  return section<double>(BinaryProblemSection::RHS);
+}
+ObjSense BinaryProblemView::sense() const{
+  return header().sense == 1 ? ObjSense::MAXIMIZE : ObjSense::MINIMIZE;
+}
+double BinaryProblemView::objectiveOffset() const{
+  return header().objectiveOffset;
+}
+std::string_view BinaryProblemView::name(index_t index) const{
+  auto nameOffsets = section<std::uint64_t>(BinaryProblemSection::NAME_OFFSETS);
+  auto nameChars = section<char>(BinaryProblemSection::NAME_CHARS);
+  //Exclude the NUL terminator
+  return {nameChars.data() + nameOffsets[index], nameOffsets[index+1] - nameOffsets[index] - 1};
+}
+std::string_view BinaryProblemView::problemName() const{
+  return name(0);
+}
+std::string_view BinaryProblemView::columnName(index_t col) const{
+  return name(1 + col);
+}
+std::string_view BinaryProblemView::rowName(index_t row) const{
+  return name(1 + numCols() + row);
+}
+
+Problem BinaryProblemView::toProblem(bool withNames) const{
+  Problem problem;
+  problem.name = problemName();
+  problem.sense = sense();
+  problem.objectiveOffset = objectiveOffset();
+
+  problem.lhs.assign(lhs().begin(),lhs().end());
+  problem.rhs.assign(rhs().begin(),rhs().end());
+  auto nameOffsets = section<std::uint64_t>(BinaryProblemSection::NAME_OFFSETS);
+  if(withNames){
+    problem.rowNames.reserve(numRows(),nameOffsets.back() - nameOffsets[1 + numCols()]);
+    for(index_t row = 0; row < numRows(); ++row){
+      [[maybe_unused]] index_t index = problem.rowNames.add(rowName(row));
+      assert(index == row); //open() rejects duplicate names
+    }
+  }
+  problem.matrix.setNumSecondary(numRows());
+  problem.matrix.appendPrimaryVectors(section<index_t>(BinaryProblemSection::PRIMARY_START),
+                                      section<index_t>(BinaryProblemSection::SECONDARY_INDEX),
+                                      section<double>(BinaryProblemSection::VALUES));
+
+  problem.obj.assign(objective().begin(),objective().end());
+  problem.lb.assign(lowerBounds().begin(),lowerBounds().end());
+  problem.ub.assign(upperBounds().begin(),upperBounds().end());
+  problem.colType.reserve(numCols());
+  for(index_t col = 0; col < numCols(); ++col){
+    problem.colType.push_back(columnType(col));
+  }
+  if(withNames){
+    problem.colNames.reserve(numCols(),nameOffsets[1 + numCols()] - nameOffsets[1]);
+    for(index_t col = 0; col < numCols(); ++col){
+      [[maybe_unused]] index_t index = problem.colNames.add(columnName(col));
+      assert(index == col);
+    }
+  }
+  return problem;
+}
@@ -0,0 +1,331 @@
+//
+// Created by rolf on 17-10-26.
+//
+
+#include "mipworkshop2024/GzipReader.h"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Block{
+  std::unique_ptr<char[]> data;
+  std::size_t capacity = 0;
+  std::size_t size = 0;
+
+  void reserve(std::size_t numBytes){
+    if(numBytes > capacity){
+      data = std::make_unique_for_overwrite<char[]>(numBytes);
+      capacity = numBytes;
+    }
+    size = 0;
+  }
+};
+
+/// Ring of blocks which are written by the decompression threads and read in order by the consumer.
+/// Block b is stored in slot b % numSlots, and can only be written once block b - numSlots has been released.
+class BlockRing{
+public:
+  explicit BlockRing(index_t numSlots) : slots(numSlots), slotBlock(numSlots,INVALID){}
+
+  /// Waits until block can be written. Returns nullptr if reading was stopped.
+  Block* acquire(index_t block){
+    std::unique_lock lock(mutex);
+    condition.wait(lock,[&]{ return stopped || block < numReleased + slots.size();});
+    if(stopped){
+      return nullptr;
+    }
+    return &slots[block % slots.size()];
+  }
+  void publish(index_t block){
+    {
+      std::lock_guard lock(mutex);
+      slotBlock[block % slots.size()] = block;
+    }
+    condition.notify_all();
+  }
+  void setNumBlocks(index_t total){
+    {
+      std::lock_guard lock(mutex);
+      numBlocks = total;
+    }
+    condition.notify_all();
+  }
+  void fail(){
+    {
+      std::lock_guard lock(mutex);
+      failed = true;
+      stopped = true;
+    }
+    condition.notify_all();
+  }
+  void stop(){
+    {
+      std::lock_guard lock(mutex);
+      stopped = true;
+    }
+    condition.notify_all();
+  }
+  /// Waits for the next block in order. Returns nullptr if all blocks were read or decompression failed.
+  const Block* next(){
+    std::unique_lock lock(mutex);
+    condition.wait(lock,[&]{
+      return failed || numReleased == numBlocks || slotBlock[numReleased % slots.size()] == numReleased;
+    });
+    if(failed || numReleased == numBlocks){
+      return nullptr;
+    }
+    return &slots[numReleased % slots.size()];
+  }
+  void release(){
+    {
+      std::lock_guard lock(mutex);
+      ++numReleased;
+    }
+    condition.notify_all();
+  }
+  [[nodiscard]] bool hasFailed(){
+    std::lock_guard lock(mutex);
+    return failed;
+  }
+private:
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::vector<Block> slots;
+  std::vector<index_t> slotBlock;
+  index_t numReleased = 0;
+  index_t numBlocks = INVALID;
+  bool stopped = false;
+  bool failed = false;
+};
+
+constexpr unsigned char GZIP_ID1 = 0x1f;
+constexpr unsigned char GZIP_ID2 = 0x8b;
+constexpr unsigned char GZIP_FEXTRA = 0x04;
+
+struct GzipMember{
+  std::size_t offset;
+  std::size_t compressedSize;
+  std::size_t uncompressedSize;
+};
+
+std::uint32_t readLittleEndian(const unsigned char * data, std::size_t numBytes){
+  std::uint32_t value = 0;
+  for(std::size_t i = numBytes; i > 0; --i){
+    value = (value << 8) | data[i-1];
+  }
+  return value;
+}
+
+/// Computes the member boundaries of a BGZF file, where each member stores its own size in a 'BC' extra subfield.
+/// Returns an empty vector if the file is not in this format, in which case the members can only be found by
+/// decompressing the file.
+std::vector<GzipMember> findBGZFMembers(const unsigned char * data, std::size_t size){
+  std::vector<GzipMember> members;
+  std::size_t offset = 0;
+  while(offset < size){
+    constexpr std::size_t HEADER_SIZE = 12;
+    if(size - offset < HEADER_SIZE || data[offset] != GZIP_ID1 || data[offset+1] != GZIP_ID2 ||
+       !(data[offset+3] & GZIP_FEXTRA)){
+      return {};
+    }
+    std::size_t extraLength = readLittleEndian(data + offset + 10,2);
+    if(size - offset < HEADER_SIZE + extraLength){
+      return {};
+    }
+    std::size_t memberSize = 0;
+    const unsigned char * extra = data + offset + HEADER_SIZE;
+    for(std::size_t pos = 0; pos + 4 <= extraLength;){
+      std::size_t subfieldLength = readLittleEndian(extra + pos + 2,2);
+      if(extra[pos] == 'B' && extra[pos+1] == 'C' && subfieldLength == 2 && pos + 6 <= extraLength){
+        memberSize = readLittleEndian(extra + pos + 4,2) + 1;
+        break;
+      }
+      pos += 4 + subfieldLength;
+    }
+    if(memberSize == 0 || memberSize > size - offset || memberSize < HEADER_SIZE + extraLength + 8){
+      return {};
+    }
+    //The last 4 bytes of each member store the uncompressed size
+    std::size_t uncompressedSize = readLittleEndian(data + offset + memberSize - 4,4);
+    members.push_back({offset,memberSize,uncompressedSize});
+    offset += memberSize;
+  }
+  return members;
+}
+
+std::size_t maxInflateInput(const unsigned char * position, const unsigned char * end){
+  return std::min<std::size_t>(end-position,std::numeric_limits<uInt>::max());
+}
+
+/// Decompresses the file member by member on a single thread; the member boundaries are only found while inflating
+void inflateSequential(const unsigned char * data, std::size_t size,
+                       const GzipReadSettings& settings, BlockRing& ring){
+  z_stream stream{};
+  if(inflateInit2(&stream,15+16) != Z_OK){
+    ring.fail();
+    return;
+  }
+  const unsigned char * end = data + size;
+  stream.next_in = const_cast<unsigned char*>(data);
+  index_t blockIndex = 0;
+  Block * block = ring.acquire(blockIndex);
+  if(block != nullptr){
+    block->reserve(std::max<std::size_t>(settings.blockSize,1));
+  }
+  bool done = false;
+  while(block != nullptr){
+    stream.avail_in = maxInflateInput(stream.next_in,end);
+    stream.next_out = reinterpret_cast<unsigned char*>(block->data.get() + block->size);
+    stream.avail_out = block->capacity - block->size;
+    int result = inflate(&stream,Z_NO_FLUSH);
+    block->size = block->capacity - stream.avail_out;
+    if(result == Z_STREAM_END){
+      //Either another member follows, or we reached the end of the file. Trailing garbage is ignored, like gzip does
+      if(stream.next_in != end && stream.next_in[0] == GZIP_ID1){
+        inflateReset(&stream);
+      }else{
+        done = true;
+      }
+    }else if(result == Z_BUF_ERROR && stream.avail_out != 0){
+      //No progress is possible even though there is room for output, so the input must have been exhausted
+      std::cerr<<"Unexpected end of gzip data\n";
+      ring.fail();
+      break;
+    }else if(result != Z_OK && result != Z_BUF_ERROR){
+      std::cerr<<"Could not decompress gzip data: "<<(stream.msg != nullptr ? stream.msg : "unknown error")<<"\n";
+      ring.fail();
+      break;
+    }
+    if(done || block->size == block->capacity){
+      ring.publish(blockIndex);
+      ++blockIndex;
+      if(done){
+        ring.setNumBlocks(blockIndex);
+        break;
+      }
+      block = ring.acquire(blockIndex);
+      if(block != nullptr){
+        block->reserve(std::max<std::size_t>(settings.blockSize,1));
+      }
+    }
+  }
+  inflateEnd(&stream);
+}
+
+/// Decompresses batches of BGZF members in parallel; each batch forms one block
+void inflateParallel(const unsigned char * data, const std::vector<GzipMember>& members,
+                     const GzipReadSettings& settings, BlockRing& ring){
+  struct Batch{
+    std::size_t firstMember;
+    std::size_t lastMember;
+    std::size_t uncompressedSize;
+  };
+  std::vector<Batch> batches;
+  for(std::size_t i = 0; i < members.size(); ++i){
+    if(batches.empty() || batches.back().uncompressedSize >= settings.blockSize){
+      batches.push_back({i,i,0});
+    }
+    batches.back().lastMember = i + 1;
+    batches.back().uncompressedSize += members[i].uncompressedSize;
+  }
+  ring.setNumBlocks(batches.size());
+
+  std::atomic<std::size_t> nextBatch{0};
+  auto worker = [&](){
+    z_stream stream{};
+    if(inflateInit2(&stream,15+16) != Z_OK){
+      ring.fail();
+      return;
+    }
+    for(std::size_t batchIndex = nextBatch.fetch_add(1); batchIndex < batches.size(); batchIndex = nextBatch.fetch_add(1)){
+      const Batch& batch = batches[batchIndex];
+      Block * block = ring.acquire(batchIndex);
+      if(block == nullptr){
+        break;
+      }
+      //zlib does not accept a null output buffer, which we would get for batches that only hold empty members
+      block->reserve(std::max<std::size_t>(batch.uncompressedSize,1));
+      bool good = true;
+      for(std::size_t i = batch.firstMember; i < batch.lastMember && good; ++i){
+        const GzipMember& member = members[i];
+        inflateReset(&stream);
+        stream.next_in = const_cast<unsigned char*>(data + member.offset);
+        stream.avail_in = member.compressedSize;
+        stream.next_out = reinterpret_cast<unsigned char*>(block->data.get() + block->size);
+        stream.avail_out = member.uncompressedSize;
+        good = inflate(&stream,Z_FINISH) == Z_STREAM_END && stream.avail_out == 0 && stream.avail_in == 0;
+        block->size += member.uncompressedSize;
+      }
+      if(!good){
+        std::cerr<<"Could not decompress gzip member\n";
+        ring.fail();
+        break;
+      }
+      ring.publish(batchIndex);
+    }
+    inflateEnd(&stream);
+  };
+
+  index_t numThreads = std::min<index_t>(std::max<index_t>(settings.numThreads,1),batches.size());
+  std::vector<std::jthread> threads;
+  for(index_t i = 1; i < numThreads; ++i){
+    threads.emplace_back(worker);
+  }
+  worker();
+}
+
+}
+
+bool readGzipFileBlocks(const std::filesystem::path& path,
+                        const GzipReadSettings& settings,
+                        const std::function<bool(std::string_view)>& consumer){
+  std::error_code error;
+  auto fileSize = std::filesystem::file_size(path,error);
+  if(error){
+    std::cerr<<"Could not open file: "<<path<<", "<<error.message()<<"\n";
+    return false;
+  }
+  if(fileSize == 0){
+    std::cerr<<"File "<<path<<" is empty and not a valid gzip file\n";
+    return false;
+  }
+  boost::iostreams::mapped_file_source file;
+  try{
+    file.open(path.string());
+  }catch(const std::ios_base::failure& failure){
+    std::cerr<<"Could not memory-map file: "<<path<<", "<<failure.what()<<"\n";
+    return false;
+  }
+  const auto * data = reinterpret_cast<const unsigned char*>(file.data());
+
+  BlockRing ring(std::max<index_t>(settings.numBlocks,2));
+  std::vector<GzipMember> members = findBGZFMembers(data,file.size());
+  std::jthread producer;
+  if(members.empty()){
+    producer = std::jthread([&](){ inflateSequential(data,file.size(),settings,ring);});
+  }else{
+    producer = std::jthread([&](){ inflateParallel(data,members,settings,ring);});
+  }
+
+  for(const Block * block = ring.next(); block != nullptr; block = ring.next()){
+    bool proceed = consumer(std::string_view(block->data.get(),block->size));
+    ring.release();
+    if(!proceed){
+      ring.stop();
+      break;
+    }
+  }
+  producer.join();
+  return !ring.hasFailed();
+}
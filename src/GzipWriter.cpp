@@ -0,0 +1,257 @@
+//
+// Created by rolf on 17-10-26.
+//
+
+#include "mipworkshop2024/GzipWriter.h"
+#include "mipworkshop2024/Parallel.h"
+
+#include <zlib.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// BGZF members hold at most this many uncompressed bytes, so that the compressed member always fits in 64 KiB
+constexpr std::size_t BGZF_MAX_MEMBER_INPUT = 0xff00;
+constexpr std::size_t BGZF_HEADER_SIZE = 18;
+constexpr std::size_t BGZF_FOOTER_SIZE = 8;
+constexpr std::size_t BGZF_MAX_MEMBER_SIZE = std::size_t(1) << 16;
+
+void appendLittleEndian(std::string& output, std::uint32_t value, std::size_t numBytes){
+  for(std::size_t i = 0; i < numBytes; ++i){
+    output.push_back(static_cast<char>((value >> (8*i)) & 0xff));
+  }
+}
+
+/// Compresses the input as a single BGZF member: a gzip member whose header stores the member size in a 'BC' subfield
+bool appendBGZFMember(z_stream& stream, std::string_view input, std::string& output){
+  std::size_t start = output.size();
+  output.resize(start + BGZF_MAX_MEMBER_SIZE);
+  auto * header = reinterpret_cast<unsigned char*>(output.data() + start);
+  const unsigned char fixedHeader[BGZF_HEADER_SIZE] = {0x1f,0x8b,8,4,0,0,0,0,0,0xff,6,0,'B','C',2,0,0,0};
+  std::copy(std::begin(fixedHeader),std::end(fixedHeader),header);
+
+  deflateReset(&stream);
+  stream.next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(input.data()));
+  stream.avail_in = input.size();
+  stream.next_out = header + BGZF_HEADER_SIZE;
+  stream.avail_out = BGZF_MAX_MEMBER_SIZE - BGZF_HEADER_SIZE - BGZF_FOOTER_SIZE;
+  if(deflate(&stream,Z_FINISH) != Z_STREAM_END){
+    return false;
+  }
+  std::size_t memberSize = BGZF_MAX_MEMBER_SIZE - stream.avail_out;
+  header[16] = static_cast<unsigned char>((memberSize - 1) & 0xff);
+  header[17] = static_cast<unsigned char>((memberSize - 1) >> 8);
+  output.resize(start + memberSize - BGZF_FOOTER_SIZE);
+  auto crc = crc32(0,reinterpret_cast<const Bytef*>(input.data()),input.size());
+  appendLittleEndian(output,crc,4);
+  appendLittleEndian(output,input.size(),4);
+  return true;
+}
+
+}
+
+struct GzipFileWriter::Implementation{
+  struct Job{
+    std::string input;
+    std::string output;
+    bool last = false;
+    bool done = false;
+  };
+
+  Implementation(const std::filesystem::path& path, const GzipWriteSettings& settings) :
+  file(path,std::ios::binary | std::ios::trunc),
+  blockSize{std::max<std::size_t>(settings.blockSize,1)},
+  maxJobs{std::max<index_t>(settings.numBlocks,1)},
+  bgzf{resolveNumThreads(settings.numThreads) > 1}{
+    if(!file.is_open()){
+      std::cerr<<"Could not open file: "<<path<<"\n";
+      failed = true;
+      return;
+    }
+    index_t numThreads = resolveNumThreads(settings.numThreads);
+    //BGZF members are raw deflate streams; the gzip framing is written by appendBGZFMember
+    int windowBits = bgzf ? -15 : 15 + 16;
+    streams.resize(numThreads);
+    for(z_stream& stream : streams){
+      if(deflateInit2(&stream,settings.compressionLevel,Z_DEFLATED,windowBits,8,Z_DEFAULT_STRATEGY) != Z_OK){
+        failed = true;
+      }
+    }
+    current.reserve(blockSize);
+    for(index_t i = 0; i < numThreads && !failed; ++i){
+      threads.emplace_back([this,i](){ work(streams[i]);});
+    }
+  }
+  ~Implementation(){
+    finish();
+    for(z_stream& stream : streams){
+      deflateEnd(&stream);
+    }
+  }
+
+  void submit(bool last){
+    std::unique_lock lock(mutex);
+    condition.wait(lock,[&]{ return failed || jobs.size() < maxJobs;});
+    auto& job = jobs.emplace_back(std::make_unique<Job>());
+    job->input = std::move(current);
+    job->last = last;
+    pending.push_back(job.get());
+    current = std::string();
+    if(!last){
+      current.reserve(blockSize);
+    }
+    condition.notify_all();
+  }
+
+  void work(z_stream& stream){
+    while(true){
+      Job * job;
+      {
+        std::unique_lock lock(mutex);
+        condition.wait(lock,[&]{ return !pending.empty() || stopping;});
+        if(pending.empty()){
+          return;
+        }
+        job = pending.front();
+        pending.pop_front();
+      }
+      bool good = bgzf ? compressBGZF(stream,*job) : compressStream(stream,*job);
+      std::unique_lock lock(mutex);
+      job->done = true;
+      if(!good){
+        std::cerr<<"Could not compress gzip data\n";
+        failed = true;
+      }
+      writeFinishedJobs(lock);
+    }
+  }
+
+  bool compressBGZF(z_stream& stream, Job& job){
+    std::string_view input = job.input;
+    job.output.reserve(input.size() / 2 + BGZF_MAX_MEMBER_SIZE);
+    for(std::size_t offset = 0; offset < input.size(); offset += BGZF_MAX_MEMBER_INPUT){
+      if(!appendBGZFMember(stream,input.substr(offset,BGZF_MAX_MEMBER_INPUT),job.output)){
+        return false;
+      }
+    }
+    //Like bgzip, end the file with an empty member so that truncated files can be recognized
+    return !job.last || appendBGZFMember(stream,{},job.output);
+  }
+
+  /// Compresses the next part of the single gzip member. Only one thread compresses in this mode, so jobs are
+  /// processed in order.
+  bool compressStream(z_stream& stream, Job& job){
+    stream.next_in = reinterpret_cast<unsigned char*>(job.input.data());
+    stream.avail_in = job.input.size();
+    int flush = job.last ? Z_FINISH : Z_NO_FLUSH;
+    while(true){
+      std::size_t size = job.output.size();
+      job.output.resize(size + std::max<std::size_t>(deflateBound(&stream,stream.avail_in),1 << 12));
+      stream.next_out = reinterpret_cast<unsigned char*>(job.output.data() + size);
+      stream.avail_out = job.output.size() - size;
+      int result = deflate(&stream,flush);
+      job.output.resize(job.output.size() - stream.avail_out);
+      if(result == Z_STREAM_END || (!job.last && stream.avail_in == 0 && (result == Z_OK || result == Z_BUF_ERROR))){
+        return true;
+      }
+      if(result != Z_OK && result != Z_BUF_ERROR){
+        return false;
+      }
+    }
+  }
+
+  /// Writes the compressed jobs to the file in order. One thread writes at a time, without holding the lock.
+  void writeFinishedJobs(std::unique_lock<std::mutex>& lock){
+    if(writing){
+      return;
+    }
+    writing = true;
+    while(!jobs.empty() && jobs.front()->done){
+      auto job = std::move(jobs.front());
+      jobs.pop_front();
+      condition.notify_all();
+      lock.unlock();
+      bool good = file.write(job->output.data(),static_cast<std::streamsize>(job->output.size())).good();
+      lock.lock();
+      if(!good){
+        failed = true;
+      }
+    }
+    writing = false;
+    condition.notify_all();
+  }
+
+  bool finish(){
+    if(closed){
+      return !failed;
+    }
+    closed = true;
+    if(!threads.empty()){
+      submit(true);
+      {
+        std::unique_lock lock(mutex);
+        condition.wait(lock,[&]{ return jobs.empty() || (failed && !writing);});
+        stopping = true;
+      }
+      condition.notify_all();
+      threads.clear();
+    }
+    file.close();
+    return !failed && !file.fail();
+  }
+
+  std::ofstream file;
+  std::size_t blockSize;
+  index_t maxJobs;
+  bool bgzf;
+  std::vector<z_stream> streams;
+  std::string current;
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::deque<std::unique_ptr<Job>> jobs; //all jobs which are not yet written, in order
+  std::deque<Job*> pending; //jobs which are not yet compressed
+  bool writing = false;
+  bool stopping = false;
+  bool failed = false;
+  bool closed = false;
+  std::vector<std::jthread> threads;
+};
+
+GzipFileWriter::GzipFileWriter(const std::filesystem::path& path, const GzipWriteSettings& settings) :
+implementation{std::make_unique<Implementation>(path,settings)}{
+
+}
+
+GzipFileWriter::~GzipFileWriter() = default;
+
+bool GzipFileWriter::write(std::string_view data){
+  Implementation& impl = *implementation;
+  while(!data.empty()){
+    {
+      std::lock_guard lock(impl.mutex);
+      if(impl.failed || impl.closed){
+        return false;
+      }
+    }
+    std::size_t numBytes = std::min(data.size(),impl.blockSize - impl.current.size());
+    impl.current.append(data.substr(0,numBytes));
+    data.remove_prefix(numBytes);
+    if(impl.current.size() == impl.blockSize){
+      impl.submit(false);
+    }
+  }
+  return true;
+}
+
+bool GzipFileWriter::close(){
+  return implementation->finish();
+}
@@ -3,11 +3,21 @@
 //
 
 #include "mipworkshop2024/IO.h"
+#include "mipworkshop2024/Parallel.h"
+#include "mipworkshop2024/GzipReader.h"
+#include "mipworkshop2024/GzipWriter.h"
+#include "mipworkshop2024/BinaryProblem.h"
 
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <iostream>
 #include <bitset>
+#include <cstring>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <functional>
 
 bool solToStream(const ExternalSolution& solution, std::ostream& stream){
   stream<<std::setprecision(15);
@@ -21,32 +31,50 @@ bool solToStream(const ExternalSolution& solution, std::ostream& stream){
   return stream.good();
 }
 
+namespace {
+/// Returns the first whitespace-delimited word of the text
+std::string_view firstWord(std::string_view text){
+  std::size_t start = text.find_first_not_of(" \t");
+  if(start == std::string_view::npos){
+    return {};
+  }
+  text.remove_prefix(start);
+  return text.substr(0,text.find_first_of(" \t"));
+}
+}
+
 std::optional<ExternalSolution> solFromStream(std::istream& stream){
   ExternalSolution solution;
   std::string buffer;
 
-  while(!stream.eof()){
-    getline(stream,buffer);
-    if(buffer.empty() || buffer.starts_with('#')){
+  while(std::getline(stream,buffer)){
+    std::string_view line = buffer;
+    if(line.ends_with('\r')){
+      line.remove_suffix(1);
+    }
+    if(line.empty() || line.starts_with('#')){
       continue;
-    }else if(buffer.starts_with("=obj= ")){
-      double value = std::stod(buffer.substr(6));
-      solution.objectiveValue = value;
-    }else{
-      int whiteSpaceIndex = -1;
-      for (int i = 0; i < buffer.size(); ++i) {
-        if(buffer[i] == ' '){
-          whiteSpaceIndex = i;
-          break;
-        }
+    }
+    std::optional<double> value;
+    if(line.starts_with("=obj= ")){
+      value = parseDouble(firstWord(line.substr(6)));
+      if(value.has_value()){
+        solution.objectiveValue = value.value();
       }
-      if(whiteSpaceIndex == -1){
-        std::cerr<<"Could not read line: "<<buffer<<"\n";
+    }else{
+      std::size_t whiteSpaceIndex = line.find(' ');
+      if(whiteSpaceIndex == std::string_view::npos){
+        std::cerr<<"Could not read line: "<<line<<"\n";
         continue;
       }
-      std::string varName = buffer.substr(0,whiteSpaceIndex);
-      double value = std::stod(buffer.substr(whiteSpaceIndex+1));
-      solution.variableValues[varName] = value ;
+      value = parseDouble(firstWord(line.substr(whiteSpaceIndex+1)));
+      if(value.has_value()){
+        solution.variableValues.insert_or_assign(std::string(line.substr(0,whiteSpaceIndex)),value.value());
+      }
+    }
+    if(!value.has_value()){
+      std::cerr<<"Could not parse number on line: "<<line<<"\n";
+      return std::nullopt;
     }
   }
 
@@ -60,39 +88,7 @@ std::optional<ExternalSolution> solFromCompressedStream(std::istream& stream){
   boost::iostreams::filtering_istream is;
   is.push(boost::iostreams::gzip_decompressor());
   is.push(stream);
-  ExternalSolution solution;
-
-  std::string buffer;
-  buffer.reserve(1024);
-  while(!is.eof()){
-    std::getline(is,buffer);
-    if(buffer.empty() || buffer.starts_with('#')){
-      continue;
-    }else if(buffer.starts_with("=obj= ")){
-      double value = std::stod(buffer.substr(6));
-      solution.objectiveValue = value;
-    }else{
-      int whiteSpaceIndex = -1;
-      for (int i = 0; i < buffer.size(); ++i) {
-        if(buffer[i] == ' '){
-          whiteSpaceIndex = i;
-          break;
-        }
-      }
-      if(whiteSpaceIndex == -1){
-        std::cerr<<"Could not read line: "<<buffer<<"\n";
-        continue;
-      }
-      std::string varName = buffer.substr(0,whiteSpaceIndex);
-      double value = std::stod(buffer.substr(whiteSpaceIndex+1));
-      solution.variableValues[varName] = value ;
-    }
-  }
-
-  if(!is.eof()){
-    return std::nullopt;
-  }
-  return solution;
+  return solFromStream(is);
 }
 std::optional<ExternalSolution> readSolFile(const std::filesystem::path& path){
   std::ifstream stream(path);
@@ -104,16 +100,77 @@ std::optional<ExternalSolution> readSolFile(const std::filesystem::path& path){
   std::cerr<<"Path does not have correct extensions!\n";
   return std::nullopt;
 }
-std::optional<Problem> readMPSFile(const std::filesystem::path& path){
-  std::ifstream stream(path);
+namespace {
+constexpr std::array<char,8> NAME_FILE_MAGIC = {'M','I','P','W','N','A','M','E'};
+constexpr std::uint32_t NAME_FILE_VERSION = 1;
+
+std::optional<Problem> readProblemFile(const std::filesystem::path& path, const MPSReadSettings& settings){
   if(path.extension() == ".gz" && path.stem().extension() == ".mps"){
+    if(settings.pipelineDecompression){
+      return problemFromCompressedMPSFile(path,settings);
+    }
+    std::ifstream stream(path);
     return problemFromCompressedMPSStream(stream);
+  }else if(path.extension() == BINARY_PROBLEM_EXTENSION){
+    auto view = BinaryProblemView::open(path);
+    if(!view.has_value()){
+      return std::nullopt;
+    }
+    //The names never need to be materialized if they are not kept or stored
+    return view->toProblem(settings.keepNames || !settings.nameFile.empty());
   }else if(path.extension() == ".mps"){
+    if(settings.memoryMap){
+      return problemFromMappedMPSFile(path,settings);
+    }
+    std::ifstream stream(path);
     return problemFromMPSstream(stream);
   }
   std::cerr<<"Path does not have correct extensions!\n";
   return std::nullopt;
 }
+}
+
+std::optional<Problem> readMPSFile(const std::filesystem::path& path, const MPSReadSettings& settings){
+  auto problem = readProblemFile(path,settings);
+  if(!problem.has_value() || settings.keepNames){
+    return problem;
+  }
+  if(!settings.nameFile.empty() && problem->hasNames() && !writeNameFile(problem.value(),settings.nameFile)){
+    std::cerr<<"Could not write name file "<<settings.nameFile<<"\n";
+    return std::nullopt;
+  }
+  problem->releaseNames();
+  return problem;
+}
+
+bool writeNameFile(const Problem& problem, const std::filesystem::path& path){
+  if(!problem.hasNames()){
+    return false;
+  }
+  std::ofstream stream(path,std::ios::binary | std::ios::trunc);
+  stream.write(NAME_FILE_MAGIC.data(),NAME_FILE_MAGIC.size());
+  std::uint32_t version[2] = {NAME_FILE_VERSION,0};
+  stream.write(reinterpret_cast<const char*>(version),sizeof(version));
+  return problem.colNames.writeTo(stream) && problem.rowNames.writeTo(stream);
+}
+
+std::optional<ProblemNames> readNameFile(const std::filesystem::path& path){
+  std::ifstream stream(path,std::ios::binary);
+  std::array<char,8> magic{};
+  std::uint32_t version[2] = {0,0};
+  if(!stream.read(magic.data(),magic.size()) || magic != NAME_FILE_MAGIC ||
+     !stream.read(reinterpret_cast<char*>(version),sizeof(version)) || version[0] != NAME_FILE_VERSION){
+    std::cerr<<"Invalid name file "<<path<<"\n";
+    return std::nullopt;
+  }
+  auto colNames = NameTable::readFrom(stream);
+  auto rowNames = colNames.has_value() ? NameTable::readFrom(stream) : std::nullopt;
+  if(!rowNames.has_value()){
+    std::cerr<<"Invalid name file "<<path<<"\n";
+    return std::nullopt;
+  }
+  return ProblemNames{.colNames = std::move(colNames.value()), .rowNames = std::move(rowNames.value())};
+}
 std::optional<Problem> problemFromCompressedMPSStream(std::istream& stream){
   boost::iostreams::filtering_istream is;
   is.push(boost::iostreams::gzip_decompressor());
@@ -160,11 +217,46 @@ struct FreeRowData{
   FreeRowData();
   double rhs;
   std::vector<double> coefficients;
-  std::vector<std::string> columns; //TODO: inefficient solution
+  std::vector<index_t> columns;
 };
 FreeRowData::FreeRowData() : rhs{0.0}{
 
 }
+
+/// The number of columns and matrix entries in (a part of) the COLUMNS section, which is used to size the storage
+/// before parsing. The number of entries is an upper bound, as it includes the entries of the objective and other
+/// free rows; telling these apart requires looking up the rows.
+struct ColumnSectionSize{
+  std::uint64_t numColumns = 0; //counted in 64 bits, so that sizes which do not fit index_t can be detected
+  std::uint64_t numEntries = 0;
+  std::size_t numNameChars = 0; //including a terminating character per name, as stored by NameTable
+};
+
+/// A part of the COLUMNS section which is parsed independently of the other parts.
+/// Columns are numbered locally, starting from 0 at the start of the chunk.
+struct ColumnChunk{
+  struct Marker{
+    index_t column; //The marker applies to all columns starting from this local column index
+    bool intOrg;
+    std::size_t line;
+  };
+  struct FreeRowEntry{
+    FreeRowData * row;
+    index_t column;
+    double value;
+  };
+
+  ColumnSectionSize size;
+  CompressedBlock block;
+  std::vector<std::string_view> names;
+  std::vector<Marker> markers;
+  std::vector<FreeRowEntry> freeRowEntries;
+  std::size_t numLines = 0;
+
+  bool failed = false;
+  std::size_t errorLine = 0;
+  std::string error;
+};
 /// Currently, we support a few of CPLEX' extensions to MPS files.
 /// The only exception as far as we are aware is that we do not suppor that the dollar sign '$',
 /// can be used in field 3 and 5 to treat the remaining characters as a comment
@@ -175,14 +267,12 @@ struct MPSReader{
 
   std::string objectiveRowName;
 
-  std::unordered_map<std::string,FreeRowData> freeRows;
+  std::unordered_map<std::string,FreeRowData,NameHash,std::equal_to<>> freeRows;
 
   bool processedFirstColumn = false;
   bool markNewColsInteger = false;
   bool colIsInteger = false;
   std::string lastColumn;
-  std::vector<index_t> columnRows;
-  std::vector<double> columnValues;
 
   bool finalizeModel(Problem& problem);
   bool setNewSection(Problem& problem,MPSSection section);
@@ -191,42 +281,79 @@ struct MPSReader{
   void finalizeSection(Problem& problem);
   void finalizeCOLUMNS(Problem& problem);
 
-  bool processNewSection(const std::string& line, Problem& problem);
-  bool processSectionLine(const std::string& line, Problem& problem);
-  bool processNAMELine(const std::string& line, Problem& problem);
-  bool processROWSLine(const std::string& line, Problem& problem);
-
-  bool processCOLUMNSLine(const std::string& line, Problem& problem);
-  bool processRHSLine(const std::string& line, Problem& problem);
-  bool processRANGESLine(const std::string& line, Problem& problem);
-  bool processBOUNDSLine(const std::string& line, Problem& problem);
-  bool processOBJSENSELine(const std::string& line, Problem& problem);
-  bool processObjsenseWord(const std::string& word, Problem& problem);
-  bool processOBJNAMELine(const std::string& line, Problem& problem);
-
-
-  bool addRow(Problem& problem, const std::string& name, char senseChar);
-  bool addRange(Problem& problem, const std::string& rowName, const std::string& value );
+  /// Processes a single line of the file, with any line ending characters already removed
+  bool processLine(std::string_view line, Problem& problem);
+  bool processNewSection(std::string_view line, Problem& problem);
+  bool processSectionLine(std::string_view line, Problem& problem);
+  bool processNAMELine(std::string_view line, Problem& problem);
+  bool processROWSLine(std::string_view line, Problem& problem);
+
+  bool processCOLUMNSLine(std::string_view line, Problem& problem);
+  /// Parses the complete body of the COLUMNS section at once, in parallel if numThreads != 1.
+  /// The section is split into chunks at lines where a new column starts.
+  bool processCOLUMNSSection(std::string_view body, Problem& problem, index_t numThreads);
+  void parseColumnChunk(std::string_view chunkText, const Problem& problem, ColumnChunk& chunk);
+  bool processRHSLine(std::string_view line, Problem& problem);
+  bool processRANGESLine(std::string_view line, Problem& problem);
+  bool processBOUNDSLine(std::string_view line, Problem& problem);
+  bool processOBJSENSELine(std::string_view line, Problem& problem);
+  bool processObjsenseWord(std::string_view word, Problem& problem);
+  bool processOBJNAMELine(std::string_view line, Problem& problem);
+
+
+  bool addRow(Problem& problem, std::string_view name, char senseChar);
+  /// Returns false and reports an error if a problem of this size can not be indexed by index_t
+  bool checkProblemSize(std::uint64_t numRows, std::uint64_t numCols, std::uint64_t numNonzeros) const;
+  /// Looks up a row by name. Free rows are not added to the problem; for these row is set to INVALID and
+  /// freeRow points to their data. Returns false if no row with this name was declared.
+  bool findRow(const Problem& problem, std::string_view name, index_t& row, FreeRowData*& freeRow);
+  bool addRange(Problem& problem, std::string_view rowName, std::string_view value );
 
   bool addColumnNonzero(Problem& problem,
-                        const std::string& rowName,
-                        const std::string& value);
+                        std::string_view rowName,
+                        std::string_view value);
   void flushColumn(Problem& problem);
 
   bool addRHS(Problem& problem,
-              const std::string& rowName, const std::string& value);
+              std::string_view rowName, std::string_view value);
 
   bool computeBoundValue(
       index_t& outCol,
       double& outVal,
       Problem& problem,
-      const std::string& colName,
-      const std::string& value);
+      std::string_view colName,
+      std::string_view value);
+
+  bool parseValue(std::string_view value, double& outVal) const;
 };
 
 
-std::vector<std::string> splitString(const std::string& string,char delim=' '){
-  std::vector<std::string> result;
+/// The words of a single line. The words point into the line itself, so splitting a line does not allocate.
+/// No line in an MPS file has more than 6 fields; any further words are counted but not stored, except for the last one.
+struct MPSFields{
+  static constexpr std::size_t MAX_FIELDS = 8;
+  std::array<std::string_view,MAX_FIELDS> words;
+  std::string_view lastWord;
+  std::size_t numWords = 0;
+
+  [[nodiscard]] std::size_t size() const{
+    return numWords;
+  }
+  [[nodiscard]] bool empty() const{
+    return numWords == 0;
+  }
+  [[nodiscard]] std::string_view operator[](std::size_t index) const{
+    assert(index < std::min(numWords,MAX_FIELDS));
+    return words[index];
+  }
+  [[nodiscard]] std::string_view back() const{
+    assert(numWords > 0);
+    return lastWord;
+  }
+};
+
+MPSFields splitString(std::string_view string,char delim=' '){
+  MPSFields result;
 
   for(std::size_t stringPos = 0; stringPos < string.size(); ){
     if(string[stringPos] == delim){
@@ -239,14 +366,259 @@ std::vector<std::string> splitString(const std::string& string,char delim=' '){
       ++stringPos;
       ++wordSize;
     }
-    result.push_back(string.substr(wordBegin,wordSize));
+    result.lastWord = string.substr(wordBegin,wordSize);
+    if(result.numWords < MPSFields::MAX_FIELDS){
+      result.words[result.numWords] = result.lastWord;
+    }
+    ++result.numWords;
   }
 
   return result;
 }
 
 constexpr std::array<const char*,1> UNSUPPORTED_SECTIONS = {"SOS"};
-bool MPSReader::processNewSection(const std::string& line, Problem &problem) {
+/// Returns the start of the line following the line containing position
+std::size_t nextLineStart(std::string_view text, std::size_t position){
+  if(position >= text.size()){
+    return text.size();
+  }
+  const char * lineEnd = static_cast<const char*>(std::memchr(text.data() + position,'\n',text.size() - position));
+  return lineEnd == nullptr ? text.size() : static_cast<std::size_t>(lineEnd - text.data()) + 1;
+}
+
+std::string_view lineAt(std::string_view text, std::size_t lineStart){
+  std::size_t lineEnd = nextLineStart(text,lineStart);
+  std::string_view line = text.substr(lineStart,lineEnd-lineStart);
+  if(line.ends_with('\n')) line.remove_suffix(1);
+  if(line.ends_with('\r')) line.remove_suffix(1);
+  return line;
+}
+
+ColumnSectionSize countColumnSection(std::string_view text){
+  ColumnSectionSize size;
+  std::string_view lastName;
+  for(std::size_t lineStart = 0; lineStart < text.size(); lineStart = nextLineStart(text,lineStart)){
+    std::string_view line = lineAt(text,lineStart);
+    if(line.empty() || line.starts_with('*')){
+      continue;
+    }
+    auto words = splitString(line);
+    if(words.size() < 3 || words[1] == "'MARKER'"){
+      continue;
+    }
+    if(words[0] != lastName){
+      lastName = words[0];
+      ++size.numColumns;
+      size.numNameChars += lastName.size() + 1;
+    }
+    size.numEntries += words.size() >= 5 ? 2 : 1;
+  }
+  return size;
+}
+
+/// Returns the column name of a line in the COLUMNS section, or an empty view for comments and markers
+std::string_view columnNameOfLine(std::string_view line){
+  if(line.empty() || line.starts_with('*')){
+    return {};
+  }
+  auto words = splitString(line);
+  if(words.size() < 2 || words[1] == "'MARKER'"){
+    return {};
+  }
+  return words[0];
+}
+
+/// Finds the first line at or after position which starts a different column than the line before it
+std::size_t findColumnBoundary(std::string_view body, std::size_t position){
+  std::size_t lineStart = nextLineStart(body,position);
+  std::string_view previousName;
+  while(lineStart < body.size()){
+    std::string_view name = columnNameOfLine(lineAt(body,lineStart));
+    if(!name.empty()){
+      if(previousName.empty()){
+        previousName = name;
+      }else if(name != previousName){
+        return lineStart;
+      }
+    }
+    lineStart = nextLineStart(body,lineStart);
+  }
+  return body.size();
+}
+
+void MPSReader::parseColumnChunk(std::string_view chunkText, const Problem& problem, ColumnChunk& chunk){
+  chunk.size = countColumnSection(chunkText);
+  chunk.names.reserve(chunk.size.numColumns);
+  chunk.block.primaryStart.reserve(chunk.size.numColumns + 1);
+  chunk.block.secondaryIndex.reserve(chunk.size.numEntries);
+  chunk.block.values.reserve(chunk.size.numEntries);
+  auto fail = [&](std::string message){
+    chunk.failed = true;
+    chunk.errorLine = chunk.numLines;
+    chunk.error = std::move(message);
+  };
+  auto addNonzero = [&](std::string_view rowName, std::string_view value){
+    index_t rowIndex;
+    FreeRowData * freeRow;
+    if(!findRow(problem,rowName,rowIndex,freeRow)){
+      fail("Row: " + std::string(rowName) + " was not declared");
+      return false;
+    }
+    auto val = parseDouble(value);
+    if(!val.has_value()){
+      fail("Could not parse number: " + std::string(value));
+      return false;
+    }
+    if(rowIndex == INVALID){ //Row is free
+      chunk.freeRowEntries.push_back({freeRow,static_cast<index_t>(chunk.names.size()-1),val.value()});
+    }else{
+      chunk.block.secondaryIndex.push_back(rowIndex);
+      chunk.block.values.push_back(val.value());
+    }
+    return true;
+  };
+
+  std::size_t lineStart = 0;
+  while(lineStart < chunkText.size()){
+    std::string_view line = lineAt(chunkText,lineStart);
+    lineStart = nextLineStart(chunkText,lineStart);
+    ++chunk.numLines;
+    if(line.empty() || line.starts_with('*')) continue;
+
+    auto words = splitString(line);
+    if(words.size() != 3 && words.size() != 5){
+      fail("Unexpected number of fields in mps file,COLUMNS section");
+      return;
+    }
+    if(words[1] == "'MARKER'"){
+      if(words[2] == "'INTORG'" || words[2] == "'INTEND'"){
+        //Whether the markers are nested correctly can only be checked once all chunks are known
+        chunk.markers.push_back({static_cast<index_t>(chunk.names.size()),words[2] == "'INTORG'",chunk.numLines});
+        continue;
+      }
+      fail("Unexpected MARKER value");
+      return;
+    }
+    if(chunk.names.empty() || words[0] != chunk.names.back()){
+      if(!chunk.names.empty()){
+        chunk.block.primaryStart.push_back(chunk.block.secondaryIndex.size());
+      }
+      chunk.names.push_back(words[0]);
+    }
+    if(!addNonzero(words[1],words[2])){
+      return;
+    }
+    if(words.size() == 5 && !addNonzero(words[3],words[4])){
+      return;
+    }
+  }
+  if(!chunk.names.empty()){
+    chunk.block.primaryStart.push_back(chunk.block.secondaryIndex.size());
+  }
+}
+
+bool MPSReader::processCOLUMNSSection(std::string_view body, Problem& problem, index_t numThreads){
+  numThreads = resolveNumThreads(numThreads);
+  std::vector<std::size_t> chunkStart(numThreads+1,body.size());
+  chunkStart[0] = 0;
+  for(index_t i = 1; i < numThreads; ++i){
+    std::size_t target = std::max(chunkStart[i-1],body.size() / numThreads * i);
+    chunkStart[i] = target == 0 ? 0 : findColumnBoundary(body,target-1);
+  }
+  std::vector<ColumnChunk> chunks(numThreads);
+  parallelFor(numThreads,numThreads,[&](index_t i){
+    parseColumnChunk(body.substr(chunkStart[i],chunkStart[i+1]-chunkStart[i]),problem,chunks[i]);
+  });
+
+  for(const auto& chunk : chunks){
+    if(chunk.failed){
+      std::cerr<<chunk.error<<", line: "<<lineCount + chunk.errorLine<<"\n";
+      return false;
+    }
+    lineCount += chunk.numLines;
+  }
+  std::size_t sectionStartLine = lineCount;
+  for(const auto& chunk : chunks){
+    sectionStartLine -= chunk.numLines;
+  }
+
+  //Resolve the integrality markers, now that we know where each chunk starts
+  std::vector<VariableType> types;
+  std::size_t chunkLineOffset = sectionStartLine;
+  for(const auto& chunk : chunks){
+    auto marker = chunk.markers.begin();
+    for(index_t col = 0; col <= chunk.names.size(); ++col){
+      for(; marker != chunk.markers.end() && marker->column == col; ++marker){
+        if(marker->intOrg == markNewColsInteger){
+          std::cerr<<"Cannot nest "<<(marker->intOrg ? "'INTORG'" : "'INTEND'")<<" markers, line: "
+                   <<chunkLineOffset + marker->line<<"\n";
+          return false;
+        }
+        markNewColsInteger = marker->intOrg;
+      }
+      if(col < chunk.names.size()){
+        types.push_back(markNewColsInteger ? VariableType::INTEGER : VariableType::CONTINUOUS);
+      }
+    }
+    chunkLineOffset += chunk.numLines;
+  }
+
+  index_t firstColumn = problem.numCols();
+  index_t column = firstColumn;
+  ColumnSectionSize size;
+  for(const auto& chunk : chunks){
+    size.numColumns += chunk.size.numColumns;
+    size.numEntries += chunk.size.numEntries;
+    size.numNameChars += chunk.size.numNameChars;
+  }
+  if(!checkProblemSize(problem.numRows(),problem.numCols() + size.numColumns,
+                       problem.matrix.getValues().size() + size.numEntries)){
+    return false;
+  }
+  problem.colNames.reserve(problem.colNames.size() + size.numColumns,problem.colNames.numChars() + size.numNameChars);
+  for(const auto& chunk : chunks){
+    for(const auto& entry : chunk.freeRowEntries){
+      entry.row->coefficients.push_back(entry.value);
+      entry.row->columns.push_back(column + entry.column);
+    }
+    for(std::string_view name : chunk.names){
+      if(problem.colNames.add(name) == INVALID){
+        std::cerr<<"Cannot declare a second column with name: "<< name<<"\n";
+        return false;
+      }
+      ++column;
+    }
+  }
+
+  std::vector<CompressedBlock> blocks;
+  blocks.reserve(chunks.size());
+  for(auto& chunk : chunks){
+    blocks.push_back(std::move(chunk.block));
+  }
+  problem.matrix.appendPrimaryBlocks(blocks,numThreads);
+  assert(problem.numCols() == column);
+
+  index_t numAdded = column - firstColumn;
+  problem.lb.resize(problem.lb.size() + numAdded,0.0);
+  problem.ub.resize(problem.ub.size() + numAdded,infinity);
+  problem.obj.resize(problem.obj.size() + numAdded,0.0);
+  problem.colType.insert(problem.colType.end(),types.begin(),types.end());
+  return true;
+}
+
+bool MPSReader::processLine(std::string_view line, Problem& problem){
+  if(line.ends_with('\r')){
+    line.remove_suffix(1);
+  }
+  ++lineCount;
+  if(line.empty() || line.starts_with('*')) return true; //Line is a comment, we ignore it
+  if(!line.starts_with(' ')){
+    return processNewSection(line,problem);
+  }
+  return processSectionLine(line,problem);
+}
+
+bool MPSReader::processNewSection(std::string_view line, Problem &problem) {
   auto words = splitString(line);
   assert(!words.empty());
   if(words[0] == "NAME" ){
@@ -351,7 +723,7 @@ bool MPSReader::processNewSection(const std::string& line, Problem &problem) {
   return false;
 }
 
-bool MPSReader::processSectionLine(const std::string& line, Problem &problem) {
+bool MPSReader::processSectionLine(std::string_view line, Problem &problem) {
   switch(section){
   case MPSSection::NAME: return processNAMELine(line,problem);
   case MPSSection::ROWS: return processROWSLine(line,problem);
@@ -409,25 +781,16 @@ bool MPSReader::finalizeModel(Problem& problem) {
     assert(freeRowIt != freeRows.end());
     const auto& freeRowData = freeRowIt->second;
     for(std::size_t i = 0; i < freeRowData.coefficients.size(); ++i){
-      auto colIndexIt = problem.colToIndex.find(freeRowData.columns[i]);
-      if(colIndexIt == problem.colToIndex.end()){
-        std::cerr<<"Could not find column: "<<freeRowData.columns[i] <<" in the objective\n";
-        return false;
-      }
-      index_t column = colIndexIt->second;
+      index_t column = freeRowData.columns[i];
+      assert(column < problem.numCols());
       problem.obj[column] = freeRowData.coefficients[i];
     }
     problem.objectiveOffset = -freeRowData.rhs;
 
   }
-  //Cleanup the row name mapping by removing free rows; we initially have this so that it is easier to test for duplicate row names
-  for(const auto& freeRow : freeRows){
-    std::size_t numRemoved = problem.rowToIndex.erase(freeRow.first);
-    assert(numRemoved == 1);
-  }
   return true;
 }
-bool MPSReader::processNAMELine(const std::string &line, Problem &problem) {
+bool MPSReader::processNAMELine(std::string_view line, Problem &problem) {
     auto words = splitString(line); //TODO: maybe check if we can increase performance here because we do this for every section
     assert(!words.empty());
     if(words.size() > 1){
@@ -442,7 +805,7 @@ bool MPSReader::processNAMELine(const std::string &line, Problem &problem) {
     return true;
 }
 
-bool MPSReader::processROWSLine(const std::string& line, Problem& problem){
+bool MPSReader::processROWSLine(std::string_view line, Problem& problem){
   auto words = splitString(line); //TODO: maybe check if we can increase performance here because we do this for every section
   assert(!words.empty());
   assert(!words[0].empty());
@@ -457,7 +820,7 @@ bool MPSReader::processROWSLine(const std::string& line, Problem& problem){
   }
   return addRow(problem,words[1],senseChar);
 }
-bool MPSReader::processCOLUMNSLine(const std::string& line, Problem& problem){
+bool MPSReader::processCOLUMNSLine(std::string_view line, Problem& problem){
   auto words = splitString(line); //TODO: maybe check if we can increase performance here because we do this for every section
   assert(!words.empty());
   if(words.size() != 3 && words.size() != 5){
@@ -485,6 +848,10 @@ bool MPSReader::processCOLUMNSLine(const std::string& line, Problem& problem){
       return false;
     }
   }
+  //The current column is only added once it is complete, hence the +1
+  if(!checkProblemSize(problem.numRows(),problem.numCols() + 1,problem.matrix.getValues().size() + 2)){
+    return false;
+  }
   if(words[0] != lastColumn){
     if(processedFirstColumn){
       flushColumn(problem);
@@ -492,7 +859,7 @@ bool MPSReader::processCOLUMNSLine(const std::string& line, Problem& problem){
       processedFirstColumn = true;
     }
 
-    if(problem.colToIndex.contains(words[0])){
+    if(problem.colNames.contains(words[0])){
       std::cerr<<"Cannot declare a second column with name: "<< words[0]<<"\n";
       return false;
     }
@@ -507,7 +874,7 @@ bool MPSReader::processCOLUMNSLine(const std::string& line, Problem& problem){
   }
   return true;
 }
-bool MPSReader::processRHSLine(const std::string &line, Problem &problem) {
+bool MPSReader::processRHSLine(std::string_view line, Problem &problem) {
   auto words = splitString(line); //TODO
   assert(!words.empty());
   if(words.size() != 3 && words.size() != 5){
@@ -522,7 +889,7 @@ bool MPSReader::processRHSLine(const std::string &line, Problem &problem) {
   }
   return true;
 }
-bool MPSReader::processRANGESLine(const std::string& line, Problem& problem){
+bool MPSReader::processRANGESLine(std::string_view line, Problem& problem){
   auto words = splitString(line);
   if(words.size() != 3 && words.size() != 5){
     std::cerr<<"Unexpected number of fields in mps file, RANGES section, line: "<<lineCount<<"\n";
@@ -536,7 +903,7 @@ bool MPSReader::processRANGESLine(const std::string& line, Problem& problem){
   }
   return true;
 }
-bool MPSReader::processBOUNDSLine(const std::string& line, Problem& problem){
+bool MPSReader::processBOUNDSLine(std::string_view line, Problem& problem){
   auto words = splitString(line); //TODO
   assert(!words.empty());
   if(words.size() <3 && words.size() >6){
@@ -562,12 +929,11 @@ bool MPSReader::processBOUNDSLine(const std::string& line, Problem& problem){
       std::cerr<<"Unexpected number of fields in mps file, BOUNDS section, line: "<<lineCount<<"\n";
       return false;
     }
-    auto it = problem.colToIndex.find(words[2]);
-    if(it == problem.colToIndex.end()){
+    indices[0] = problem.colNames.find(words[2]);
+    if(indices[0] == INVALID){
       std::cerr<<"Could not find column name: "<<words[2] <<" in BOUNDS section, line: "<<lineCount <<"\n";
       return false;
     }
-    indices[0] = it->second;
 
     if(words.size() ==4){
       //only MIPLIB benchmark instances which have a redundant word here are leo1 and leo2
@@ -657,14 +1023,29 @@ bool MPSReader::processBOUNDSLine(const std::string& line, Problem& problem){
 }
 
 
-bool MPSReader::addRow(Problem& problem, const std::string& name, char senseChar) {
-  if(problem.rowToIndex.contains(name)){
+bool MPSReader::findRow(const Problem& problem, std::string_view name, index_t& row, FreeRowData*& freeRow){
+  row = problem.rowNames.find(name);
+  freeRow = nullptr;
+  if(row != INVALID){
+    return true;
+  }
+  auto freeIt = freeRows.find(name);
+  if(freeIt == freeRows.end()){
+    return false;
+  }
+  freeRow = &freeIt->second;
+  return true;
+}
+bool MPSReader::addRow(Problem& problem, std::string_view name, char senseChar) {
+  if(problem.rowNames.contains(name) || freeRows.contains(name)){
     std::cerr<<"Cannot declare a second row with name: "<< name<<"\n";
     return false;
   }
+  if(!checkProblemSize(problem.numRows() + 1,problem.numCols(),problem.matrix.getValues().size())){
+    return false;
+  }
   if(senseChar == 'N'){
-    problem.rowToIndex[name] = INVALID;
-    freeRows[name] = FreeRowData();
+    freeRows.emplace(name,FreeRowData());
     if(objectiveRowName.empty()){
       objectiveRowName = name;
     }
@@ -692,6 +1073,15 @@ bool MPSReader::addRow(Problem& problem, const std::string& name, char senseChar
   problem.addRow(name,lhs,rhs);
   return true;
 }
+bool MPSReader::checkProblemSize(std::uint64_t numRows, std::uint64_t numCols, std::uint64_t numNonzeros) const{
+  //The primary starts store the number of nonzeros and the column count, so these must fit as well
+  if(fitsInIndex(numRows) && fitsInIndex(numCols + 1) && fitsInIndex(numNonzeros)){
+    return true;
+  }
+  std::cerr<<"Problem has too many rows, columns or nonzeros for "<<8*sizeof(index_t)<<"-bit indices, line: "
+           <<lineCount<<"\n";
+  return false;
+}
 void MPSReader::finalizeSection(Problem& problem) {
   switch(section){
   case MPSSection::COLUMNS: {
@@ -702,34 +1092,35 @@ void MPSReader::finalizeSection(Problem& problem) {
   }
 }
 void MPSReader::finalizeCOLUMNS(Problem& problem) {
-  flushColumn(problem);
+  if(processedFirstColumn){
+    flushColumn(problem);
+  }
 }
 void MPSReader::flushColumn(Problem &problem) {
   double lb = 0.0;
   double ub =  infinity;
   VariableType type = colIsInteger ? VariableType::INTEGER : VariableType::CONTINUOUS;
-  problem.addColumn(lastColumn,columnRows,columnValues,type,lb,ub);
-  columnRows.clear();
-  columnValues.clear();
+  problem.finishColumn(lastColumn,type,lb,ub);
 }
 bool MPSReader::addColumnNonzero(Problem& problem,
-    const std::string& rowName, const std::string& value) {
-  auto it = problem.rowToIndex.find(rowName);
-  if(it == problem.rowToIndex.end()){
+    std::string_view rowName, std::string_view value) {
+  index_t rowIndex;
+  FreeRowData * freeRow;
+  if(!findRow(problem,rowName,rowIndex,freeRow)){
     std::cerr<<"Row: "<<rowName<< " was not declared\n";
     return false;
   }
-  double val = std::stod(value); //TODO: error handling
-  index_t rowIndex = it->second;
+  double val;
+  if(!parseValue(value,val)){
+    return false;
+  }
   if(rowIndex == INVALID){ //Row is free
-    auto freeIt = freeRows.find(rowName);
-    assert(freeIt != freeRows.end());
-    auto& rowData = freeIt->second;
+    auto& rowData = *freeRow;
     rowData.coefficients.push_back(val);
-    rowData.columns.push_back(lastColumn);
+    //The column which is currently being read is only added to the problem once it is complete
+    rowData.columns.push_back(problem.numCols());
   }else{
-    columnRows.push_back(rowIndex);
-    columnValues.push_back(val);
+    problem.appendColumnNonzero(rowIndex,val);
   }
 
   return true;
@@ -738,35 +1129,39 @@ bool MPSReader::addColumnNonzero(Problem& problem,
 bool MPSReader::computeBoundValue(index_t &outCol,
                                   double &outVal,
                                   Problem &problem,
-                                  const std::string &colName,
-                                  const std::string &value) {
-  auto colIt = problem.colToIndex.find(colName);
-  if(colIt == problem.colToIndex.end()){
+                                  std::string_view colName,
+                                  std::string_view value) {
+  outCol = problem.colNames.find(colName);
+  if(outCol == INVALID){
     std::cerr<<"Could not find column: "<<colName<<" in BOUNDS section, line: "<<lineCount<<"\n";
     return false;
   }
-  outCol = colIt->second;
-  outVal = std::stod(value); //TODO: error handling
-
+  return parseValue(value,outVal);
+}
+bool MPSReader::parseValue(std::string_view value, double& outVal) const{
+  auto parsed = parseDouble(value);
+  if(!parsed.has_value()){
+    std::cerr<<"Could not parse number: "<<value<<", line: "<<lineCount<<"\n";
+    return false;
+  }
+  outVal = parsed.value();
   return true;
 }
 bool MPSReader::addRHS(Problem& problem,
-                       const std::string &rowName, const std::string &value) {
-  auto it = problem.rowToIndex.find(rowName);
-  if(it == problem.rowToIndex.end()){
+                       std::string_view rowName, std::string_view value) {
+  index_t index;
+  FreeRowData * freeRow;
+  if(!findRow(problem,rowName,index,freeRow)){
     std::cerr<<"Row: "<< rowName <<"was not yet declared, line "<<lineCount<<"\n";
     return false;
   }
-  index_t index = it->second;
-  double val = std::stod(value); //TODO: check
-  if(it->second == INVALID){
+  double val;
+  if(!parseValue(value,val)){
+    return false;
+  }
+  if(index == INVALID){
     //Row is free
-    auto freeIt = freeRows.find(rowName);
-    if(freeIt == freeRows.end()){
-      std::cerr<<"Could not find free row: "<<rowName<<"\n";
-      return false;
-    }
-    freeIt->second.rhs = val;
+    freeRow->rhs = val;
     return true;
   }
 
@@ -778,19 +1173,22 @@ bool MPSReader::addRHS(Problem& problem,
   }
   return true;
 }
-bool MPSReader::addRange(Problem &problem, const std::string &rowName, const std::string &value) {
-  auto it = problem.rowToIndex.find(rowName);
-  if(it == problem.rowToIndex.end()){
+bool MPSReader::addRange(Problem &problem, std::string_view rowName, std::string_view value) {
+  index_t rowIndex;
+  FreeRowData * freeRow;
+  if(!findRow(problem,rowName,rowIndex,freeRow)){
     std::cerr<<"Could not find row: "<<rowName<<" in RANGES section, line: "<<lineCount<<"\n";
     return false;
   }
-  index_t rowIndex = it->second;
   if(rowIndex == INVALID){
     //Row is free; ranges does not make any sense
     std::cerr<<"Can not specify RANGES for free row, line: "<<lineCount<<"\n";
     return false;
   }
-  double val= std::stod(value);
+  double val;
+  if(!parseValue(value,val)){
+    return false;
+  }
 
   bool lhsInfinite = problem.lhs[rowIndex] == -infinity;
   bool rhsInfinite = problem.rhs[rowIndex] == infinity;
@@ -813,7 +1211,7 @@ bool MPSReader::addRange(Problem &problem, const std::string &rowName, const std
   return true;
 }
 
-bool MPSReader::processOBJNAMELine(const std::string &line, Problem &) {
+bool MPSReader::processOBJNAMELine(std::string_view line, Problem &) {
     auto words = splitString(line);
     assert(!words.empty());
     if(words.size() > 2){
@@ -824,7 +1222,7 @@ bool MPSReader::processOBJNAMELine(const std::string &line, Problem &) {
     return true;
 }
 
-bool MPSReader::processOBJSENSELine(const std::string &line, Problem &problem) {
+bool MPSReader::processOBJSENSELine(std::string_view line, Problem &problem) {
     auto words = splitString(line);
     assert(!words.empty());
     if(words.size() > 2){
@@ -835,7 +1233,7 @@ bool MPSReader::processOBJSENSELine(const std::string &line, Problem &problem) {
     return processObjsenseWord(words[0],problem);
 }
 
-bool MPSReader::processObjsenseWord(const std::string &word, Problem &problem) {
+bool MPSReader::processObjsenseWord(std::string_view word, Problem &problem) {
     if(word == "MAX"){
         problem.sense = ObjSense::MAXIMIZE;
     }else if(word == "MIN"){
@@ -852,24 +1250,64 @@ std::optional<Problem> problemFromMPSstream(std::istream& stream){
   std::string read;
   MPSReader reader;
   Problem problem;
-  while(!stream.eof()){
-    std::getline(stream,read);
-    if(read.ends_with('\r')){
-      read.pop_back();
-    }
-    ++reader.lineCount;
-    if(read.empty() || read.starts_with('*')) continue; //Line is a comment, we ignore it
-    if(!read.starts_with(' ')){
-      if(!reader.processNewSection(read,problem)){
-        return std::nullopt;
+  while(std::getline(stream,read)){
+    if(!reader.processLine(read,problem)){
+      return std::nullopt;
+    }
+    if(reader.section == MPSSection::ENDATA){
+      break;
+    }
+  }
+  if(reader.finalizeModel(problem)){
+    return problem;
+  }
+  return std::nullopt;
+}
+
+std::optional<Problem> problemFromMPSMemory(std::string_view contents, const MPSReadSettings& settings){
+  MPSReader reader;
+  Problem problem;
+  std::size_t lineBegin = 0;
+  while(lineBegin < contents.size()){
+    const char * lineEnd = static_cast<const char*>(
+        std::memchr(contents.data() + lineBegin,'\n',contents.size() - lineBegin));
+    std::size_t lineSize = lineEnd == nullptr ? contents.size() - lineBegin : lineEnd - (contents.data() + lineBegin);
+    MPSSection previousSection = reader.section;
+    if(!reader.processLine(contents.substr(lineBegin,lineSize),problem)){
+      return std::nullopt;
+    }
+    if(reader.section == MPSSection::ENDATA){
+      break;
+    }
+    lineBegin += lineSize + 1;
+    if(reader.section == MPSSection::COLUMNS && previousSection != MPSSection::COLUMNS){
+      //The body of the COLUMNS section is everything up to the next section header
+      std::size_t bodyEnd = lineBegin;
+      while(bodyEnd < contents.size()){
+        char first = contents[bodyEnd];
+        if(first != ' ' && first != '*' && first != '\n' && first != '\r'){
+          break;
+        }
+        bodyEnd = nextLineStart(contents,bodyEnd);
       }
-      if(reader.section == MPSSection::ENDATA){
-        break;
+      std::string_view body = contents.substr(lineBegin,bodyEnd-lineBegin);
+      if(resolveNumThreads(settings.numThreads) == 1){
+        //Parse the section line by line directly into the problem, after sizing its storage with a quick first pass
+        auto size = countColumnSection(body);
+        if(!reader.checkProblemSize(problem.numRows(),problem.numCols() + size.numColumns,
+                                    problem.matrix.getValues().size() + size.numEntries)){
+          return std::nullopt;
+        }
+        problem.reserve(problem.numRows(),problem.numCols() + size.numColumns,
+                        problem.matrix.getValues().size() + size.numEntries);
+        problem.colNames.reserve(problem.colNames.size() + size.numColumns,
+                                 problem.colNames.numChars() + size.numNameChars);
+        continue;
       }
-    }else{
-      if(!reader.processSectionLine(read,problem)){
+      if(!reader.processCOLUMNSSection(body,problem,settings.numThreads)){
         return std::nullopt;
       }
+      lineBegin = bodyEnd;
     }
   }
   if(reader.finalizeModel(problem)){
@@ -877,6 +1315,82 @@ std::optional<Problem> problemFromMPSstream(std::istream& stream){
   }
   return std::nullopt;
 }
+
+std::optional<Problem> problemFromCompressedMPSFile(const std::filesystem::path& path, const MPSReadSettings& settings){
+  MPSReader reader;
+  Problem problem;
+  bool parsed = true;
+  //Processes a line, and returns whether we should continue reading
+  auto processLine = [&](std::string_view line){
+    if(!reader.processLine(line,problem)){
+      parsed = false;
+      return false;
+    }
+    return reader.section != MPSSection::ENDATA;
+  };
+  //Lines can be split over two consecutive blocks; the first part is then stored here
+  std::string partialLine;
+  GzipReadSettings gzipSettings{
+    .blockSize = settings.decompressionBlockSize,
+    .numBlocks = settings.numDecompressionBlocks,
+    .numThreads = resolveNumThreads(settings.numThreads)
+  };
+  bool decompressed = readGzipFileBlocks(path,gzipSettings,[&](std::string_view block){
+    std::size_t lineBegin = 0;
+    while(true){
+      const char * lineEnd = static_cast<const char*>(
+          std::memchr(block.data() + lineBegin,'\n',block.size() - lineBegin));
+      if(lineEnd == nullptr){
+        partialLine.append(block.substr(lineBegin));
+        return true;
+      }
+      std::string_view line = block.substr(lineBegin,lineEnd - (block.data() + lineBegin));
+      lineBegin += line.size() + 1;
+      bool proceed;
+      if(partialLine.empty()){
+        proceed = processLine(line);
+      }else{
+        partialLine.append(line);
+        proceed = processLine(partialLine);
+        partialLine.clear();
+      }
+      if(!proceed){
+        return false;
+      }
+    }
+  });
+  if(!parsed || !decompressed){
+    return std::nullopt;
+  }
+  if(!partialLine.empty() && reader.section != MPSSection::ENDATA && !reader.processLine(partialLine,problem)){
+    return std::nullopt;
+  }
+  if(reader.finalizeModel(problem)){
+    return problem;
+  }
+  return std::nullopt;
+}
+
+std::optional<Problem> problemFromMappedMPSFile(const std::filesystem::path& path, const MPSReadSettings& settings){
+  std::error_code error;
+  auto fileSize = std::filesystem::file_size(path,error);
+  if(error){
+    std::cerr<<"Could not open file: "<<path<<", "<<error.message()<<"\n";
+    return std::nullopt;
+  }
+  if(fileSize == 0){
+    //Empty files cannot be mapped, but should give the same error as any other incomplete file
+    return problemFromMPSMemory({},settings);
+  }
+  boost::iostreams::mapped_file_source file;
+  try{
+    file.open(path.string());
+  }catch(const std::ios_base::failure& failure){
+    std::cerr<<"Could not memory-map file: "<<path<<", "<<failure.what()<<"\n";
+    return std::nullopt;
+  }
+  return problemFromMPSMemory({file.data(),file.size()},settings);
+}
 char rowSenseChar(double lhs, double rhs){
   if(lhs == rhs){
     return 'E';
@@ -896,30 +1410,106 @@ char rowSenseChar(double lhs, double rhs){
   return 'L';
 }
 
-bool problemToStream(const Problem& problem,std::ostream& stream){
-  stream <<std::setprecision(15);
+namespace {
+/// Formats the output of the MPS writer into a large reusable buffer, which is handed to the sink whenever it is full.
+/// Numbers are written with std::to_chars, using the shortest representation which reads back to the same value.
+class OutputBuffer{
+public:
+  OutputBuffer(std::function<bool(std::string_view)> sink, std::size_t capacity) :
+  sink{std::move(sink)}, buffer(std::max(capacity,MAX_NUMBER_LENGTH)){
+
+  }
+  OutputBuffer& operator<<(std::string_view text){
+    if(text.size() > buffer.size() - size){
+      flush();
+      if(text.size() > buffer.size()){
+        isGood = isGood && sink(text);
+        return *this;
+      }
+    }
+    std::memcpy(buffer.data() + size,text.data(),text.size());
+    size += text.size();
+    return *this;
+  }
+  OutputBuffer& operator<<(char character){
+    return *this << std::string_view(&character,1);
+  }
+  OutputBuffer& operator<<(double value){
+    return writeNumber(value);
+  }
+  OutputBuffer& operator<<(std::size_t value){
+    return writeNumber(value);
+  }
+  bool flush(){
+    if(size != 0){
+      isGood = isGood && sink(std::string_view(buffer.data(),size));
+      size = 0;
+    }
+    return isGood;
+  }
+  [[nodiscard]] bool good() const{
+    return isGood;
+  }
+private:
+  static constexpr std::size_t MAX_NUMBER_LENGTH = 32;
+
+  template<typename T>
+  OutputBuffer& writeNumber(T value){
+    if(buffer.size() - size < MAX_NUMBER_LENGTH){
+      flush();
+    }
+    auto result = std::to_chars(buffer.data() + size,buffer.data() + buffer.size(),value);
+    size = result.ptr - buffer.data();
+    return *this;
+  }
+
+  std::function<bool(std::string_view)> sink;
+  std::vector<char> buffer;
+  std::size_t size = 0;
+  bool isGood = true;
+};
+
+bool writeProblem(const Problem& problem, OutputBuffer& out){
+  //Problems without names are written using their generated names
+  const bool named = problem.hasNames();
+  std::string colBuffer;
+  std::string rowBuffer;
+  auto colName = [&](index_t col) -> std::string_view {
+    if(named){
+      return problem.colNames[col];
+    }
+    colBuffer = problem.columnName(col);
+    return colBuffer;
+  };
+  auto rowName = [&](index_t row) -> std::string_view {
+    if(named){
+      return problem.rowNames[row];
+    }
+    rowBuffer = problem.rowName(row);
+    return rowBuffer;
+  };
 //  assert(problem.matrix.format == SparseMatrixFormat::COLUMN_WISE); //TODO: fix
-  stream << sectionToString(MPSSection::NAME)<< "  "<<problem.name<<"\n";
-  if(!stream.good()){
+  out << sectionToString(MPSSection::NAME)<< "  "<<problem.name<<"\n";
+  if(!out.good()){
     return false;
   }
   if(problem.sense == ObjSense::MAXIMIZE){
-      stream<<sectionToString(MPSSection::OBJSENSE)<<"\n";
-      stream<<"  MAX\n";
+      out<<sectionToString(MPSSection::OBJSENSE)<<"\n";
+      out<<"  MAX\n";
   }
 
   //rows section
-  stream << sectionToString(MPSSection::ROWS)<<"\n";
-  stream <<"  "<<"N"<<"  "<<"obj\n";
+  out << sectionToString(MPSSection::ROWS)<<"\n";
+  out <<"  "<<"N"<<"  "<<"obj\n";
   for(index_t i = 0; i < problem.numRows(); ++i){
-    stream<<"  "<<rowSenseChar(problem.lhs[i],problem.rhs[i])<<"  "<<problem.rowNames[i]<<"\n";
+    out<<"  "<<rowSenseChar(problem.lhs[i],problem.rhs[i])<<"  "<<rowName(i)<<"\n";
   }
 
-  if(!stream.good()){
+  if(!out.good()){
     return false;
   }
 
-  stream << sectionToString(MPSSection::COLUMNS)<<"\n";
+  out << sectionToString(MPSSection::COLUMNS)<<"\n";
   bool inIntegralSection = false;
   std::size_t integralIndex = 0;
   for(index_t col = 0; col < problem.numCols(); ++col){
@@ -927,42 +1517,42 @@ bool problemToStream(const Problem& problem,std::ostream& stream){
     if(inIntegralSection &&
     problem.colType[col] == VariableType::CONTINUOUS ||
     problem.colType[col] == VariableType::IMPLIED_INTEGER){
-      stream<<"  MARK"<<integralIndex<<"  'MARKER'      'INTEND'\n";
+      out<<"  MARK"<<integralIndex<<"  'MARKER'      'INTEND'\n";
       inIntegralSection = false;
       ++integralIndex;
     }
     if(!inIntegralSection &&
     problem.colType[col] != VariableType::CONTINUOUS && problem.colType[col] != VariableType::IMPLIED_INTEGER){
-      stream<<"  MARK"<<integralIndex<<"  'MARKER'      'INTORG'\n";
+      out<<"  MARK"<<integralIndex<<"  'MARKER'      'INTORG'\n";
       inIntegralSection = true;
       ++integralIndex;
     }
-    const std::string& name = problem.colNames[col];
+    std::string_view name = colName(col);
 
     auto slice = problem.matrix.getPrimaryVector(col);
     for(auto it = slice.begin(); it != slice.end(); ++it){
-        stream<<"  "<<name<<"  "<<problem.rowNames[it->index()]<<"  "<<it->value();
+        out<<"  "<<name<<"  "<<rowName(it->index())<<"  "<<it->value();
         ++it;
         if(it == slice.end()){
-            stream<<"\n";
+            out<<"\n";
             break;
         }
-        stream<<"  "<<problem.rowNames[it->index()]<<"  "<<it->value()<<"\n";
+        out<<"  "<<rowName(it->index())<<"  "<<it->value()<<"\n";
     }
     if(problem.obj[col] != 0.0){
-      stream<<"  "<<name<<"  obj  "<<problem.obj[col]<<"\n";
+      out<<"  "<<name<<"  obj  "<<problem.obj[col]<<"\n";
     }
   }
   if(inIntegralSection){
-    stream<<"  MARK"<<integralIndex<<"  'MARKER'      'INTEND'\n";
+    out<<"  MARK"<<integralIndex<<"  'MARKER'      'INTEND'\n";
     inIntegralSection = false;
     ++integralIndex;
   }
 
-  if(!stream.good()){
+  if(!out.good()){
     return false;
   }
-  stream<<sectionToString(MPSSection::RHS)<<"\n";
+  out<<sectionToString(MPSSection::RHS)<<"\n";
 
   //TODO: writing as two lines might save some filespace
   for(index_t row = 0; row < problem.numRows(); ++row){
@@ -974,10 +1564,10 @@ bool problemToStream(const Problem& problem,std::ostream& stream){
     if(rhsInfinite && !lhsInfinite){
       rhs = problem.lhs[row];
     }
-    stream<<"  rhs  "<<problem.rowNames[row]<<" "<<rhs<<"\n";
+    out<<"  rhs  "<<rowName(row)<<" "<<rhs<<"\n";
   }
   if(problem.objectiveOffset != 0.0){
-    stream<<"  rhs  obj  "<<-problem.objectiveOffset<<"\n";
+    out<<"  rhs  obj  "<<-problem.objectiveOffset<<"\n";
   }
   std::size_t numWrittenRanges = 0;
   //TODO: inefficient file storing
@@ -985,47 +1575,55 @@ bool problemToStream(const Problem& problem,std::ostream& stream){
     if(problem.lhs[row] != -infinity && problem.rhs[row] != infinity &&
        problem.lhs[row] != problem.rhs[row]){
       if(numWrittenRanges == 0){
-        stream<<sectionToString(MPSSection::RANGES)<<"\n";
+        out<<sectionToString(MPSSection::RANGES)<<"\n";
       }
       ++numWrittenRanges;
-      stream<<"  rhs  "<<problem.rowNames[row]<<"  "<<problem.rhs[row]-problem.lhs[row] <<"\n";
+      out<<"  rhs  "<<rowName(row)<<"  "<<problem.rhs[row]-problem.lhs[row] <<"\n";
     }
   }
-  if(!stream.good()){
+  if(!out.good()){
     return false;
   }
   //TODO: finalize, along with OBJSENSE and OBJNAME sections
-  stream<<sectionToString(MPSSection::BOUNDS)<<"\n";
+  out<<sectionToString(MPSSection::BOUNDS)<<"\n";
   for(index_t col = 0; col < problem.numCols(); ++col){
     if(problem.colType[col] == VariableType::BINARY ||
         (problem.colType[col] == VariableType::INTEGER &&
         isFeasEq(problem.lb[col],0.0) && isFeasEq(problem.ub[col],1.0))){
-      stream<<"  BV Bound  "<<problem.colNames[col]<<"\n";
+      out<<"  BV Bound  "<<colName(col)<<"\n";
       continue;
     }
     if(problem.lb[col] == -infinity && problem.ub[col] == infinity){
-      stream<<"  FR Bound  "<<problem.colNames[col]<<"\n";
+      out<<"  FR Bound  "<<colName(col)<<"\n";
       continue;
     }
     if(isFeasEq(problem.lb[col],problem.ub[col])){
-      stream<<"  FX Bound  "<<problem.colNames[col]<<"  "<<problem.lb[col]<<"\n";
+      out<<"  FX Bound  "<<colName(col)<<"  "<<problem.lb[col]<<"\n";
       continue;
     }
     //print lower and upper bound
     if(problem.lb[col] == -infinity){
-      stream<<"  MI Bound  "<<problem.colNames[col]<<"\n";
+      out<<"  MI Bound  "<<colName(col)<<"\n";
     }else{
-      stream<<"  LO Bound  "<<problem.colNames[col]<<"  "<<problem.lb[col]<<"\n";
+      out<<"  LO Bound  "<<colName(col)<<"  "<<problem.lb[col]<<"\n";
     }
     if(problem.ub[col] == infinity){
-      stream<<"  PL Bound  "<<problem.colNames[col]<<"\n";
+      out<<"  PL Bound  "<<colName(col)<<"\n";
     }else{
-      stream<<"  UP Bound  "<<problem.colNames[col]<<"  "<<problem.ub[col]<<"\n";
+      out<<"  UP Bound  "<<colName(col)<<"  "<<problem.ub[col]<<"\n";
     }
   }
-  stream<<sectionToString(MPSSection::ENDATA);
+  out<<sectionToString(MPSSection::ENDATA);
 
-  return stream.good();
+  return out.good();
+}
+}
+
+bool problemToStream(const Problem& problem,std::ostream& stream){
+  OutputBuffer out([&](std::string_view data){
+    return stream.write(data.data(),static_cast<std::streamsize>(data.size())).good();
+  },std::size_t(1) << 16);
+  return writeProblem(problem,out) && out.flush();
 }
 
 bool problemToStreamCompressed(const Problem& problem, std::ostream& stream){
@@ -1036,25 +1634,49 @@ bool problemToStreamCompressed(const Problem& problem, std::ostream& stream){
   boost::iostreams::close(os);
   return good;
 }
-bool writeMPSFile(const Problem& problem,const std::filesystem::path& path){
-  std::ofstream stream(path);
-  return problemToStreamCompressed(problem,stream);
+bool writeMPSFile(const Problem& problem,const std::filesystem::path& path, const MPSWriteSettings& settings){
+  if(!settings.compress){
+    std::ofstream stream(path,std::ios::binary | std::ios::trunc);
+    OutputBuffer out([&](std::string_view data){
+      return stream.write(data.data(),static_cast<std::streamsize>(data.size())).good();
+    },settings.bufferSize);
+    return writeProblem(problem,out) && out.flush();
+  }
+  GzipFileWriter writer(path,GzipWriteSettings{
+    .numThreads = settings.numCompressionThreads,
+    .compressionLevel = settings.compressionLevel,
+    .blockSize = settings.bufferSize
+  });
+  OutputBuffer out([&](std::string_view data){ return writer.write(data);},settings.bufferSize);
+  bool good = writeProblem(problem,out) && out.flush();
+  return writer.close() && good;
 }
 
 
-bool writePostSolveStackFile(const PostSolveStack& stack, const std::filesystem::path& path){
-    std::ofstream stream(path);
-    return postSolveStackToStream(stack,stream);
+bool writePostSolveStackFile(const PostSolveStack& stack, const std::filesystem::path& path, PostSolveStackFormat format){
+    std::ofstream stream(path,std::ios::binary | std::ios::trunc);
+    return postSolveStackToStream(stack,stream,format);
 }
-bool postSolveStackToStream(const PostSolveStack& stack, std::ostream& stream){
+bool postSolveStackToStream(const PostSolveStack& stack, std::ostream& stream, PostSolveStackFormat format){
+    if(format == PostSolveStackFormat::BINARY){
+        return postSolveToBinary(stack,stream);
+    }
     auto json = postSolveToJson(stack);
 
     stream << json;
     return stream.good();
 }
 std::optional<PostSolveStack> postSolveStackFromStream(std::istream& stream){
+    //Both formats are accepted; binary files are recognized by their magic bytes, as JSON can never start with these
+    if(stream.peek() == POSTSOLVE_BINARY_MAGIC[0]){
+        return postSolveFromBinary(stream);
+    }
     nlohmann::json json;
-    stream >> json;
-    PostSolveStack stack = postSolveFromJson(json);
-    return stack;
-}
\ No newline at end of file
+    try{
+        stream >> json;
+        return postSolveFromJson(json);
+    }catch(const nlohmann::json::exception& exception){
+        std::cerr<<"Could not read postsolve stack: "<<exception.what()<<"\n";
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,147 @@
+//
+// Created by rolf on 17-10-26.
+//
+
+#include "mipworkshop2024/NameTable.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace {
+constexpr std::size_t MIN_SLOTS = 16;
+
+std::size_t hashName(std::string_view name){
+  return NameHash{}(name);
+}
+
+/// Reads the given number of elements in chunks, so that a corrupted size can not cause a huge allocation
+template<typename T>
+bool readChunked(std::istream& stream, std::vector<T>& data, std::uint64_t numElements){
+  constexpr std::size_t CHUNK_SIZE = (std::size_t(1) << 20) / sizeof(T);
+  data.clear();
+  while(data.size() < numElements){
+    std::size_t offset = data.size();
+    data.resize(offset + std::min<std::uint64_t>(numElements - offset,CHUNK_SIZE));
+    if(!stream.read(reinterpret_cast<char*>(data.data() + offset),
+                    static_cast<std::streamsize>((data.size() - offset) * sizeof(T)))){
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+NameTable::NameTable() : offsets{0}, slots(MIN_SLOTS,INVALID){
+
+}
+
+std::size_t NameTable::findSlot(std::string_view name, std::size_t hash) const{
+  std::size_t mask = slots.size() - 1;
+  //Linear probing; the table is at most half full, so there is always an empty slot to stop at
+  for(std::size_t slot = hash & mask; ; slot = (slot + 1) & mask){
+    index_t index = slots[slot];
+    if(index == INVALID || (*this)[index] == name){
+      return slot;
+    }
+  }
+}
+
+index_t NameTable::find(std::string_view name) const{
+  return slots[findSlot(name,hashName(name))];
+}
+
+index_t NameTable::add(std::string_view name){
+  if(2 * (size() + 1) > slots.size()){
+    rehash(2 * slots.size());
+  }
+  std::size_t slot = findSlot(name,hashName(name));
+  if(slots[slot] != INVALID){
+    return INVALID;
+  }
+  index_t index = size();
+  chars.insert(chars.end(),name.begin(),name.end());
+  chars.push_back('\0');
+  offsets.push_back(chars.size());
+  slots[slot] = index;
+  return index;
+}
+
+void NameTable::rehash(std::size_t numSlots){
+  assert(std::has_single_bit(numSlots));
+  slots.assign(numSlots,INVALID);
+  std::size_t mask = numSlots - 1;
+  for(index_t index = 0; index < size(); ++index){
+    std::size_t slot = hashName((*this)[index]) & mask;
+    while(slots[slot] != INVALID){
+      slot = (slot + 1) & mask;
+    }
+    slots[slot] = index;
+  }
+}
+
+void NameTable::reserve(index_t numNames, std::size_t numChars){
+  chars.reserve(numChars);
+  offsets.reserve(numNames + 1);
+  std::size_t numSlots = std::max<std::size_t>(MIN_SLOTS,std::bit_ceil(2 * static_cast<std::size_t>(numNames)));
+  if(numSlots > slots.size()){
+    rehash(numSlots);
+  }
+}
+
+void NameTable::clear(){
+  chars.clear();
+  offsets.assign(1,0);
+  slots.assign(MIN_SLOTS,INVALID);
+}
+
+bool NameTable::operator==(const NameTable& other) const{
+  return offsets == other.offsets && chars == other.chars;
+}
+
+bool NameTable::writeTo(std::ostream& stream) const{
+  std::uint64_t counts[2] = {size(),chars.size()};
+  stream.write(reinterpret_cast<const char*>(counts),sizeof(counts));
+  for(std::size_t offset : offsets){
+    auto value = static_cast<std::uint64_t>(offset);
+    stream.write(reinterpret_cast<const char*>(&value),sizeof(value));
+  }
+  stream.write(chars.data(),static_cast<std::streamsize>(chars.size()));
+  return stream.good();
+}
+
+std::optional<NameTable> NameTable::readFrom(std::istream& stream){
+  std::uint64_t counts[2];
+  if(!stream.read(reinterpret_cast<char*>(counts),sizeof(counts))){
+    return std::nullopt;
+  }
+  //Every name takes at least its terminating NUL, which bounds the number of names
+  if(counts[0] > counts[1] || !fitsInIndex(counts[0])){
+    return std::nullopt;
+  }
+  std::vector<std::uint64_t> offsets;
+  std::vector<char> chars;
+  if(!readChunked(stream,offsets,counts[0] + 1) || !readChunked(stream,chars,counts[1])){
+    return std::nullopt;
+  }
+  //Validate the offsets, so that a corrupted file can not cause out of bounds accesses
+  if(offsets.front() != 0 || offsets.back() != chars.size()){
+    return std::nullopt;
+  }
+  for(std::size_t i = 1; i < offsets.size(); ++i){
+    if(offsets[i] <= offsets[i-1] || chars[offsets[i]-1] != '\0'){
+      return std::nullopt;
+    }
+  }
+  NameTable table;
+  table.reserve(static_cast<index_t>(counts[0]),chars.size());
+  for(std::size_t i = 1; i < offsets.size(); ++i){
+    if(table.add({chars.data() + offsets[i-1],offsets[i] - offsets[i-1] - 1}) == INVALID){
+      return std::nullopt;
+    }
+  }
+  return table;
+}
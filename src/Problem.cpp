@@ -4,14 +4,56 @@
 
 #include "mipworkshop2024/Problem.h"
 #include <cassert>
+#include <stdexcept>
+#include <string>
 #include "mipworkshop2024/ExternalSolution.h"
 
-void Problem::addRow(const std::string& rowName,
+namespace {
+constexpr char GENERATED_COLUMN_PREFIX = 'x';
+constexpr char GENERATED_ROW_PREFIX = 'c';
+
+std::string generatedName(char prefix, index_t index){
+  std::string name(1,prefix);
+  name += std::to_string(index);
+  return name;
+}
+}
+
+RowMatrixCache::RowMatrixCache(const RowMatrixCache& other){
+  std::lock_guard lock(other.mutex);
+  rowMatrix = other.rowMatrix;
+  matrixStamp = other.matrixStamp;
+}
+
+RowMatrixCache& RowMatrixCache::operator=(const RowMatrixCache& other){
+  if(this != &other){
+    std::scoped_lock lock(mutex,other.mutex);
+    rowMatrix = other.rowMatrix;
+    matrixStamp = other.matrixStamp;
+  }
+  return *this;
+}
+
+std::shared_ptr<const SparseMatrix> RowMatrixCache::get(const SparseMatrix& matrix, index_t numThreads) const{
+  std::lock_guard lock(mutex);
+  std::uint64_t stamp = matrix.contentStamp();
+  if(!rowMatrix || matrixStamp != stamp){
+    rowMatrix = std::make_shared<const SparseMatrix>(matrix.transposedFormat(numThreads));
+    matrixStamp = stamp;
+  }
+  return rowMatrix;
+}
+
+std::shared_ptr<const SparseMatrix> Problem::rowMatrix(index_t numThreads) const{
+  return rowMatrixCache.get(matrix,numThreads);
+}
+
+void Problem::addRow(std::string_view rowName,
                      double rowLHS, double rowRHS) {
-  assert(!rowToIndex.contains(rowName));
   index_t index = matrix.numRows();
-  rowToIndex[rowName] = index;
-  rowNames.push_back(rowName);
+  if(rowNames.size() == index && rowNames.add(rowName) == INVALID){
+    throw std::invalid_argument("Cannot add a second row with name: " + std::string(rowName));
+  }
   lhs.push_back(rowLHS);
   rhs.push_back(rowRHS);
   matrix.setNumSecondary(index+1);
@@ -19,16 +61,21 @@ void Problem::addRow(const std::string& rowName,
 Problem::Problem() : sense{ObjSense::MINIMIZE},objectiveOffset{0.0}{
 
 }
-void Problem::addColumn(const std::string &colName,
+void Problem::addColumn(std::string_view colName,
                         const std::vector<index_t>& entryRows,
                         const std::vector<double>& entryValues,
                         VariableType type,
                         double lowerBound,
                         double upperBound) {
-  assert(!colToIndex.contains(colName));
-  index_t index = matrix.addPrimaryVector(entryRows,entryValues);
-  colToIndex[colName] = index;
-  colNames.push_back(colName);
+  //The name is checked first, so that a duplicate name leaves the problem unchanged
+  bool addName = colNames.size() == numCols();
+  if(addName && colNames.contains(colName)){
+    throw std::invalid_argument("Cannot add a second column with name: " + std::string(colName));
+  }
+  matrix.addPrimaryVector(entryRows,entryValues);
+  if(addName){
+    colNames.add(colName);
+  }
 
   lb.push_back(lowerBound);
   ub.push_back(upperBound);
@@ -36,6 +83,30 @@ void Problem::addColumn(const std::string &colName,
   colType.push_back(type);
 
 }
+void Problem::reserve(index_t numRows, index_t numCols, index_t numNonzeros) {
+  lhs.reserve(numRows);
+  rhs.reserve(numRows);
+  lb.reserve(numCols);
+  ub.reserve(numCols);
+  obj.reserve(numCols);
+  colType.reserve(numCols);
+  matrix.reserve(numCols,numNonzeros);
+}
+index_t Problem::finishColumn(std::string_view colName, VariableType type, double lowerBound, double upperBound) {
+  bool addName = colNames.size() == numCols();
+  if(addName && colNames.contains(colName)){
+    throw std::invalid_argument("Cannot add a second column with name: " + std::string(colName));
+  }
+  index_t index = matrix.finishPrimaryVector();
+  if(addName){
+    colNames.add(colName);
+  }
+  lb.push_back(lowerBound);
+  ub.push_back(upperBound);
+  obj.push_back(0.0);
+  colType.push_back(type);
+  return index;
+}
 bool Problem::isFeasible(const Solution &solution) const{
   assert(solution.values.size() == numCols());
   for(std::size_t i = 0; i < solution.values.size(); ++i){
@@ -68,20 +139,20 @@ bool Problem::isFeasible(const Solution &solution) const{
 std::optional<Solution> Problem::convertExternalSolution(const ExternalSolution &solution) const {
   Solution sol(matrix.numCols());
   for(const auto& pair : solution.variableValues){
-    auto it = colToIndex.find(pair.first);
-    if(it == colToIndex.end()){
+    index_t col = findColumn(pair.first);
+    if(col == INVALID){
       return std::nullopt;
     }
-    sol.values[it->second] = pair.second;
+    sol.values[col] = pair.second;
   }
   return sol;
 }
 
-std::size_t Problem::numRows() const {
+index_t Problem::numRows() const {
     return matrix.numRows();
 }
 
-std::size_t Problem::numCols() const {
+index_t Problem::numCols() const {
     return matrix.numCols();
 }
 double Problem::computeObjective(const Solution& solution) const
@@ -95,15 +166,90 @@ double Problem::computeObjective(const Solution& solution) const
 }
 ExternalSolution Problem::convertSolution(const Solution& solution) const
 {
+	if(hasNames()){
+		return convertSolution(solution,colNames);
+	}
 	ExternalSolution externalSol;
 	externalSol.objectiveValue = computeObjective(solution);
 
 	assert(solution.values.size() == numCols());
 	for(index_t i = 0; i < solution.values.size(); ++i){
-		externalSol.variableValues[colNames[i]] = solution.values[i];
+		externalSol.variableValues.emplace(columnName(i),solution.values[i]);
 	}
 	return externalSol;
 }
+ExternalSolution Problem::convertSolution(const Solution& solution, const NameTable& names) const
+{
+	ExternalSolution externalSol;
+	externalSol.objectiveValue = computeObjective(solution);
+
+	assert(solution.values.size() == numCols());
+	assert(names.size() == numCols());
+	for(index_t i = 0; i < solution.values.size(); ++i){
+		externalSol.variableValues.emplace(names[i],solution.values[i]);
+	}
+	return externalSol;
+}
+
+bool Problem::hasNames() const {
+  return colNames.size() == numCols() && rowNames.size() == numRows();
+}
+
+ProblemNames Problem::releaseNames() {
+  ProblemNames names{.colNames = std::move(colNames), .rowNames = std::move(rowNames)};
+  colNames = NameTable();
+  rowNames = NameTable();
+  return names;
+}
+
+bool Problem::setNames(ProblemNames names) {
+  if(names.colNames.size() != numCols() || names.rowNames.size() != numRows()){
+    return false;
+  }
+  colNames = std::move(names.colNames);
+  rowNames = std::move(names.rowNames);
+  return true;
+}
+
+std::string Problem::columnName(index_t col) const {
+  assert(col < numCols());
+  if(colNames.size() == numCols()){
+    return std::string(colNames[col]);
+  }
+  return generatedName(GENERATED_COLUMN_PREFIX,col);
+}
+
+std::string Problem::rowName(index_t row) const {
+  assert(row < numRows());
+  if(rowNames.size() == numRows()){
+    return std::string(rowNames[row]);
+  }
+  return generatedName(GENERATED_ROW_PREFIX,row);
+}
+
+index_t Problem::findColumn(std::string_view colName) const {
+  if(colNames.size() == numCols()){
+    return colNames.find(colName);
+  }
+  if(colName.size() < 2 || colName.front() != GENERATED_COLUMN_PREFIX){
+    return INVALID;
+  }
+  index_t col = 0;
+  for(char c : colName.substr(1)){
+    if(c < '0' || c > '9'){
+      return INVALID;
+    }
+    col = 10 * col + static_cast<index_t>(c - '0');
+    if(col >= numCols()){
+      return INVALID;
+    }
+  }
+  //Reject leading zeros, so that every column has exactly one generated name
+  if(colName[1] == '0' && colName.size() > 2){
+    return INVALID;
+  }
+  return col;
+}
 
 void Problem::scale(const std::vector<double> &rowScale, const std::vector<double> &colScale) {
     assert(rowScale.size() == numRows());
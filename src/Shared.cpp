@@ -5,6 +5,36 @@
 #include "mipworkshop2024/Shared.h"
 #include <cassert>
 #include <array>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+std::optional<double> parseDouble(std::string_view token) {
+    const char *first = token.data();
+    const char *last = token.data() + token.size();
+    if (first != last && *first == '+') {
+        ++first;
+        if (first != last && *first == '-') {
+            return std::nullopt;
+        }
+    }
+    double value;
+    auto [end, error] = std::from_chars(first, last, value);
+    if (error == std::errc::result_out_of_range && end == last) {
+        //from_chars does not report a value for out of range numbers, so these rare cases are handled by strtod
+        char buffer[128];
+        if (token.size() >= sizeof(buffer)) {
+            return std::nullopt;
+        }
+        std::memcpy(buffer, token.data(), token.size());
+        buffer[token.size()] = '\0';
+        return std::strtod(buffer, nullptr);
+    }
+    if (error != std::errc() || end != last) {
+        return std::nullopt;
+    }
+    return value;
+}
 
 std::optional<Rat64> realToRational(double value,
                                     double minDelta,
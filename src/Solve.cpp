@@ -3,6 +3,7 @@
 //
 
 #include "mipworkshop2024/Solve.h"
+#include "mipworkshop2024/presolve/NetworkPostSolve.h"
 #include <scip/scip.h>
 #include <scip/scipdefplugins.h>
 #include <scip/cons.h>
@@ -51,7 +52,7 @@ SCIP_RETCODE scipDoSolveProblem(const Problem& problem, SCIPRunResult& result,
     case VariableType::IMPLIED_INTEGER: type = SCIP_VARTYPE_IMPLINT; break;
     }
 
-    SCIP_CALL(SCIPcreateVarBasic(scip,&var,problem.colNames[i].c_str(),
+    SCIP_CALL(SCIPcreateVarBasic(scip,&var,problem.columnName(i).c_str(),
                   convertValue(scip,problem.lb[i]),
                   convertValue(scip,problem.ub[i]),
                   convertValue(scip,problem.obj[i]),type));
@@ -63,24 +64,19 @@ SCIP_RETCODE scipDoSolveProblem(const Problem& problem, SCIPRunResult& result,
   std::vector<SCIP_CONS *> constraints;
   //TODO: temporary solution for initializing the constraints...
   {
-    std::vector<std::vector<index_t>> consCols(problem.numRows(), std::vector<index_t>());
-    std::vector<std::vector<double>> consValues(problem.numRows(), std::vector<double>());
-
-    for (index_t i = 0; i < problem.numCols(); ++i) {
-        for(const Nonzero& nonzero : problem.matrix.getPrimaryVector(i)){
-            consCols[nonzero.index()].push_back(i);
-            consValues[nonzero.index()].push_back(nonzero.value());
-        }
-    }
+    auto rowMatrix = problem.rowMatrix();
     std::vector<SCIP_VAR *> varBuffer;
+    std::vector<double> valueBuffer;
     for (int i = 0; i < problem.numRows(); ++i) {
       SCIP_CONS *cons;
       varBuffer.clear();
-      for (auto &index : consCols[i]) {
-        varBuffer.push_back(vars[index]);
+      valueBuffer.clear();
+      for (const Nonzero& nonzero : rowMatrix->getPrimaryVector(i)) {
+        varBuffer.push_back(vars[nonzero.index()]);
+        valueBuffer.push_back(nonzero.value());
       }
-      SCIP_CALL(SCIPcreateConsBasicLinear(scip, &cons, problem.rowNames[i].c_str(), varBuffer.size(),
-                                          varBuffer.data(), consValues[i].data(),
+      SCIP_CALL(SCIPcreateConsBasicLinear(scip, &cons, problem.rowName(i).c_str(), varBuffer.size(),
+                                          varBuffer.data(), valueBuffer.data(),
                                           convertValue(scip, problem.lhs[i]),
                                           convertValue(scip, problem.rhs[i])));
 
@@ -180,7 +176,7 @@ std::optional<SCIPRunResult> solveProblemSCIP(const Problem& problem, double tim
 SCIP_RETCODE doSolveTULP(const Problem& problem,
 		const TotallyUnimodularColumnSubmatrix& submatrix,
 		Solution& currentSol){
-	std::vector<std::size_t> rowMapping(problem.matrix.numRows(),INVALID);
+	std::vector<index_t> rowMapping(problem.matrix.numRows(),INVALID);
 	for(index_t i = 0; i < submatrix.submatRows.size(); ++i){
 		rowMapping[submatrix.submatRows[i]] = i;
 	}
@@ -201,7 +197,7 @@ SCIP_RETCODE doSolveTULP(const Problem& problem,
 	std::vector<SCIP_VAR*> vars;
 	for(index_t col : submatrix.submatColumns){
 		SCIP_VAR * var;
-		SCIP_CALL(SCIPcreateVarBasic(scip,&var,problem.colNames[col].c_str(),
+		SCIP_CALL(SCIPcreateVarBasic(scip,&var,problem.columnName(col).c_str(),
 				convertValue(scip,problem.lb[col]),
 				convertValue(scip,problem.ub[col]),
 				convertValue(scip,problem.obj[col]),
@@ -254,7 +250,7 @@ SCIP_RETCODE doSolveTULP(const Problem& problem,
 	for(index_t i = 0; i < submatrix.submatRows.size(); ++i){
 		index_t row = submatrix.submatRows[i];
 		SCIP_CONS * cons = NULL;
-		SCIP_CALL(SCIPcreateConsBasicLinear(scip, &cons, problem.rowNames[row].c_str(), consVars[i].size(),
+		SCIP_CALL(SCIPcreateConsBasicLinear(scip, &cons, problem.rowName(row).c_str(), consVars[i].size(),
 				consVars[i].data(), consValues[i].data(),
 				convertValue(scip, consLHS[i]),
 				convertValue(scip, consRHS[i])));
@@ -314,10 +310,13 @@ std::optional<Solution> doPostSolve(const Problem& originalProblem,
             std::cout<<"Implying column is not integer?!\n";
             return std::nullopt;
         }
-		SCIP_RETCODE code = doSolveTULP(originalProblem,*it,correctedSol);
-		if(code != SCIP_OKAY){
-			std::cout<<"Some error occurred during TU postsolve\n";
-			return std::nullopt;
+		//Network submatrices are solved as a min cost flow problem; the others need an LP solve
+		if(!solveNetworkTUSubmatrix(originalProblem,*it,correctedSol)){
+			SCIP_RETCODE code = doSolveTULP(originalProblem,*it,correctedSol);
+			if(code != SCIP_OKAY){
+				std::cout<<"Some error occurred during TU postsolve\n";
+				return std::nullopt;
+			}
 		}
 		for(index_t col : it->submatColumns){
 			if(!isFeasIntegral(correctedSol.values[col])){
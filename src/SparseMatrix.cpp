@@ -3,6 +3,14 @@
 //
 
 #include "mipworkshop2024/SparseMatrix.h"
+#include "mipworkshop2024/Parallel.h"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+/// Below this many nonzeros, starting threads costs more than the transpose itself
+constexpr index_t PARALLEL_TRANSPOSE_MIN_NONZEROS = 1 << 16;
+}
 
 SparseMatrix::SparseMatrix() : num_cols{0},
 num_rows{0},primaryStart{0}, format{SparseMatrixFormat::COLUMN_WISE}{
@@ -34,8 +42,78 @@ index_t SparseMatrix::addPrimaryVector(const std::vector<index_t>& entrySecondar
   primaryStart.push_back(primaryStart.back() + entrySecondary.size());
   secondaryIndex.insert(secondaryIndex.end(),entrySecondary.begin(),entrySecondary.end());
   values.insert(values.end(),entryValues.begin(),entryValues.end());
+  stamp = 0;
   return primary;
 }
+void SparseMatrix::reserve(index_t numPrimary, index_t numNonzeros) {
+  primaryStart.reserve(numPrimary + 1);
+  secondaryIndex.reserve(numNonzeros);
+  values.reserve(numNonzeros);
+}
+index_t SparseMatrix::finishPrimaryVector() {
+  assert(secondaryIndex.size() == values.size());
+  index_t primary = format == SparseMatrixFormat::ROW_WISE ? num_rows++ : num_cols++;
+  primaryStart.push_back(secondaryIndex.size());
+  stamp = 0;
+  return primary;
+}
+void SparseMatrix::appendPrimaryVectors(std::span<const index_t> blockStart,
+                                        std::span<const index_t> blockIndex,
+                                        std::span<const double> blockValues) {
+  assert(!blockStart.empty() && blockStart.front() == 0 && blockStart.back() == blockIndex.size());
+  assert(blockIndex.size() == blockValues.size());
+  index_t offset = secondaryIndex.size();
+  for(std::size_t i = 1; i < blockStart.size(); ++i){
+    primaryStart.push_back(offset + blockStart[i]);
+  }
+  secondaryIndex.insert(secondaryIndex.end(),blockIndex.begin(),blockIndex.end());
+  values.insert(values.end(),blockValues.begin(),blockValues.end());
+  if(format == SparseMatrixFormat::ROW_WISE){
+    num_rows += blockStart.size() - 1;
+  }else{
+    assert(format == SparseMatrixFormat::COLUMN_WISE);
+    num_cols += blockStart.size() - 1;
+  }
+  stamp = 0;
+}
+void SparseMatrix::appendPrimaryBlocks(const std::vector<CompressedBlock>& blocks, index_t numThreads) {
+  assert(!primaryStart.empty());
+  //Compute where each block starts using a prefix sum over the block sizes
+  std::vector<index_t> blockPrimaryOffset(blocks.size()+1);
+  std::vector<index_t> blockEntryOffset(blocks.size()+1);
+  blockPrimaryOffset[0] = primaryStart.size() - 1;
+  blockEntryOffset[0] = secondaryIndex.size();
+  for(std::size_t i = 0; i < blocks.size(); ++i){
+    const auto& block = blocks[i];
+    assert(block.primaryStart.front() == 0);
+    assert(block.primaryStart.back() == block.secondaryIndex.size());
+    assert(block.secondaryIndex.size() == block.values.size());
+    blockPrimaryOffset[i+1] = blockPrimaryOffset[i] + block.numPrimary();
+    blockEntryOffset[i+1] = blockEntryOffset[i] + block.secondaryIndex.size();
+  }
+  primaryStart.resize(blockPrimaryOffset.back() + 1);
+  secondaryIndex.resize(blockEntryOffset.back());
+  values.resize(blockEntryOffset.back());
+
+  parallelFor(blocks.size(),numThreads,[&](index_t i){
+    const auto& block = blocks[i];
+    index_t entryOffset = blockEntryOffset[i];
+    index_t primaryOffset = blockPrimaryOffset[i];
+    for(index_t j = 1; j <= block.numPrimary(); ++j){
+      primaryStart[primaryOffset + j] = entryOffset + block.primaryStart[j];
+    }
+    std::copy(block.secondaryIndex.begin(),block.secondaryIndex.end(),secondaryIndex.begin() + entryOffset);
+    std::copy(block.values.begin(),block.values.end(),values.begin() + entryOffset);
+  });
+
+  if(format == SparseMatrixFormat::ROW_WISE){
+    num_rows = blockPrimaryOffset.back();
+  }else{
+    assert(format == SparseMatrixFormat::COLUMN_WISE);
+    num_cols = blockPrimaryOffset.back();
+  }
+  stamp = 0;
+}
 void SparseMatrix::setNumSecondary(index_t num) {
   if(format == SparseMatrixFormat::ROW_WISE){
     num_cols = num;
@@ -43,6 +121,7 @@ void SparseMatrix::setNumSecondary(index_t num) {
     assert(format == SparseMatrixFormat::COLUMN_WISE);
     num_rows = num;
   }
+  stamp = 0;
 }
 
 MatrixSlice<CompressedSlice> SparseMatrix::getPrimaryVector(index_t index) const {
@@ -51,15 +130,29 @@ MatrixSlice<CompressedSlice> SparseMatrix::getPrimaryVector(index_t index) const
     return {secondaryIndex.data() + start,values.data() + start, end-start};
 }
 
-SparseMatrix SparseMatrix::transposedFormat() const {
+SparseMatrix SparseMatrix::transposedFormat(index_t numThreads) const {
     SparseMatrix transposed;
     transposed.format = format  == SparseMatrixFormat::ROW_WISE ? SparseMatrixFormat::COLUMN_WISE : SparseMatrixFormat::ROW_WISE;
     transposed.num_rows = num_rows;
     transposed.num_cols = num_cols;
 
-    //First, count the number of nonzeros in each row
     index_t numPrimary = format == SparseMatrixFormat::ROW_WISE ? num_rows : num_cols;
     index_t numSecondary = format == SparseMatrixFormat::ROW_WISE ? num_cols : num_rows;
+    index_t numNonzeros = values.size();
+
+    //Every block keeps a cursor per secondary vector; limit the blocks so that the cursors take at most twice the
+    //memory of the secondary indices
+    index_t numBlocks = std::min(resolveNumThreads(numThreads),2 * numNonzeros / std::max<index_t>(numSecondary,1));
+    if(numBlocks <= 1 || numNonzeros < PARALLEL_TRANSPOSE_MIN_NONZEROS){
+        transposeSerial(transposed,numPrimary,numSecondary);
+    }else{
+        transposeBlocked(transposed,numPrimary,numSecondary,numBlocks);
+    }
+    return transposed;
+}
+
+void SparseMatrix::transposeSerial(SparseMatrix& transposed, index_t numPrimary, index_t numSecondary) const{
+    //First, count the number of nonzeros in each row
     transposed.primaryStart.assign(numSecondary+1,0);
 
     index_t numNonzeros = values.size();
@@ -88,8 +181,73 @@ SparseMatrix SparseMatrix::transposedFormat() const {
         transposed.primaryStart[i] = transposed.primaryStart[i-1];
     }
     transposed.primaryStart[0] = 0;
+}
 
-    return transposed;
+void SparseMatrix::transposeBlocked(SparseMatrix& transposed, index_t numPrimary, index_t numSecondary,
+                                    index_t numBlocks) const{
+    //Split the primary vectors into contiguous blocks with roughly the same number of nonzeros
+    index_t numNonzeros = values.size();
+    std::vector<index_t> blockPrimaryStart(numBlocks+1,numPrimary);
+    blockPrimaryStart[0] = 0;
+    for(index_t block = 1; block < numBlocks; ++block){
+        auto it = std::lower_bound(primaryStart.begin(),primaryStart.begin() + numPrimary,numNonzeros / numBlocks * block);
+        blockPrimaryStart[block] = std::max(blockPrimaryStart[block-1],static_cast<index_t>(it - primaryStart.begin()));
+    }
+
+    //Histogram of the secondary indices of every block; cursor[block*numSecondary + s] later becomes the write position
+    std::vector<index_t> cursor(numBlocks * numSecondary);
+    parallelFor(numBlocks,numBlocks,[&](index_t block){
+        index_t * count = cursor.data() + block * numSecondary;
+        std::fill(count,count + numSecondary,0);
+        for(index_t pos = primaryStart[blockPrimaryStart[block]]; pos < primaryStart[blockPrimaryStart[block+1]]; ++pos){
+            ++count[secondaryIndex[pos]];
+        }
+    });
+
+    //Prefix sum over (secondary, block), so that within a secondary vector the blocks, and thus the primary indices,
+    //stay in ascending order. The secondary vectors are split in ranges: first sum each range, then scan within it.
+    index_t numRanges = std::min<index_t>(numBlocks * 4,numSecondary);
+    auto rangeStart = [&](index_t range){ return numSecondary / numRanges * range + std::min(range,numSecondary % numRanges);};
+    std::vector<index_t> rangeOffset(numRanges+1,0);
+    parallelFor(numRanges,numBlocks,[&](index_t range){
+        index_t sum = 0;
+        for(index_t secondary = rangeStart(range); secondary < rangeStart(range+1); ++secondary){
+            for(index_t block = 0; block < numBlocks; ++block){
+                sum += cursor[block * numSecondary + secondary];
+            }
+        }
+        rangeOffset[range+1] = sum;
+    });
+    for(index_t range = 0; range < numRanges; ++range){
+        rangeOffset[range+1] += rangeOffset[range];
+    }
+    transposed.primaryStart.resize(numSecondary+1);
+    transposed.primaryStart[numSecondary] = numNonzeros;
+    parallelFor(numRanges,numBlocks,[&](index_t range){
+        index_t offset = rangeOffset[range];
+        for(index_t secondary = rangeStart(range); secondary < rangeStart(range+1); ++secondary){
+            transposed.primaryStart[secondary] = offset;
+            for(index_t block = 0; block < numBlocks; ++block){
+                index_t count = cursor[block * numSecondary + secondary];
+                cursor[block * numSecondary + secondary] = offset;
+                offset += count;
+            }
+        }
+    });
+
+    //Every block scatters its own primary vectors into positions which no other block writes to
+    transposed.secondaryIndex.resize(numNonzeros);
+    transposed.values.resize(numNonzeros);
+    parallelFor(numBlocks,numBlocks,[&](index_t block){
+        index_t * position = cursor.data() + block * numSecondary;
+        for(index_t i = blockPrimaryStart[block]; i < blockPrimaryStart[block+1]; ++i){
+            for(index_t pos = primaryStart[i]; pos < primaryStart[i+1]; ++pos){
+                index_t newIndex = position[secondaryIndex[pos]]++;
+                transposed.secondaryIndex[newIndex] = i;
+                transposed.values[newIndex] = values[pos];
+            }
+        }
+    });
 }
 
 void SparseMatrix::scale(const std::vector<double> &rowScale, const std::vector<double> &colScale) {
@@ -104,5 +262,54 @@ void SparseMatrix::scale(const std::vector<double> &rowScale, const std::vector<
             values[pos] *= primaryScale[i]* secondaryScale[secondary];
         }
     }
+    stamp = 0;
+}
+
+std::uint64_t SparseMatrix::contentStamp() const {
+    static std::atomic<std::uint64_t> nextStamp{1};
+    if(stamp == 0){
+        stamp = nextStamp.fetch_add(1,std::memory_order_relaxed);
+    }
+    return stamp;
+}
+
+InterleavedSparseMatrix::InterleavedSparseMatrix(const SparseMatrix& matrix) :
+num_rows{matrix.numRows()},
+num_cols{matrix.numCols()},
+primaryStart{matrix.getPrimaryStart()}{
+    const auto& secondaryIndex = matrix.getSecondaryIndex();
+    const auto& values = matrix.getValues();
+    entries.reserve(values.size());
+    for(index_t i = 0; i < values.size(); ++i){
+        entries.emplace_back(secondaryIndex[i],values[i]);
+    }
+}
 
+SignPatternMatrix::SignPatternMatrix(const SparseMatrix& matrix) :
+num_rows{matrix.numRows()},
+num_cols{matrix.numCols()},
+primaryStart{matrix.getPrimaryStart()},
+secondaryIndex{matrix.getSecondaryIndex()}{
+    const auto& values = matrix.getValues();
+    negativeBits.assign((values.size() + 63) / 64,0);
+    nonUnitBits.assign((values.size() + 63) / 64,0);
+    for(index_t i = 0; i < values.size(); ++i){
+        std::uint64_t bit = std::uint64_t(1) << (i % 64);
+        if(values[i] < 0.0){
+            negativeBits[i / 64] |= bit;
+        }
+        if(fabs(values[i]) != 1.0){
+            nonUnitBits[i / 64] |= bit;
+        }
+    }
+    index_t numPrimary = primaryStart.size() - 1;
+    allUnit.assign(numPrimary,true);
+    for(index_t i = 0; i < numPrimary; ++i){
+        for(index_t pos = primaryStart[i]; pos < primaryStart[i+1]; ++pos){
+            if(fabs(values[pos]) != 1.0){
+                allUnit[i] = false;
+                break;
+            }
+        }
+    }
 }
@@ -73,14 +73,14 @@ std::optional<double> calculateIntegralRowScalar(const MatrixSlice<T> &rowSlice,
 }
 
 MatrixComponentsScaling computeCCCScaling(const Problem &problem) {
-    SparseMatrix rowMatrix = problem.matrix.transposedFormat();
+    auto rowMatrix = problem.rowMatrix();
     index_t numRows = problem.numRows();
     index_t numCols = problem.numCols();
 
     std::vector<bool> rowScaledForIntegrality;
     std::vector<double> rowIntegralityMultiplier;
     for (index_t row = 0; row < numRows; ++row) {
-        auto scalar = calculateIntegralRowScalar(rowMatrix.getPrimaryVector(row), problem.lhs[row], problem.rhs[row],
+        auto scalar = calculateIntegralRowScalar(rowMatrix->getPrimaryVector(row), problem.lhs[row], problem.rhs[row],
                                                  problem);
         rowIntegralityMultiplier.push_back(scalar.value_or(1.0));
         rowScaledForIntegrality.push_back(scalar.has_value());
@@ -141,7 +141,7 @@ MatrixComponentsScaling computeCCCScaling(const Problem &problem) {
                     isScalable = false;
                 }
 
-                for (const Nonzero &nonzero: rowMatrix.getPrimaryVector(index)) {
+                for (const Nonzero &nonzero: rowMatrix->getPrimaryVector(index)) {
                     if (problem.colType[nonzero.index()] != VariableType::CONTINUOUS) continue;
                     assert(colComponent[nonzero.index()] < 0
                            || colComponent[nonzero.index()] == currentComponent);
@@ -270,12 +270,12 @@ MatrixComponentsScaling computeCCCScaling(const Problem &problem) {
               <<", Cols: "<<numScaledColCandidates <<" / "<<numColCandidates<<"\n";
     Problem scaledProblem = problem;
     scaledProblem.scale(rowScale, colScale);
-    SparseMatrix transposed = scaledProblem.matrix.transposedFormat();
+    auto transposed = scaledProblem.rowMatrix();
 
     for (std::size_t i = 0; i < mcs.components.contComponents.size(); ++i) {
         if(!mcs.scalableComponents[i]) continue;
         const auto& component = mcs.components.contComponents[i];
-        bool check = checkProblemScaling(scaledProblem,transposed, component);
+        bool check = checkProblemScaling(scaledProblem,*transposed, component);
         if (!check) {
             std::cout << "Fail\n";
         }
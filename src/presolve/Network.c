@@ -19,13 +19,18 @@ typedef struct {
 typedef struct {
     spqr_node head;
     spqr_node tail;
-    spqr_member member;
     spqr_member childMember;
     SPQRNetworkDecompositionArcListNode headArcListNode;
     SPQRNetworkDecompositionArcListNode tailArcListNode;
     SPQRNetworkDecompositionArcListNode arcListNode; //Linked-list node of the array of arcs of the member which this arc is in
 
     spqr_element element;
+} SPQRNetworkDecompositionArc;
+
+///The fields of an arc which are used by the union-find walks, which are stored separately from the other fields so
+///that the walks touch as few cache lines as possible
+typedef struct {
+    spqr_member member;
 
     //Signed union-find for arc directions
     //For non-rigid members every arc is it's own representative, and the direction is simply given by the boolean
@@ -33,7 +38,7 @@ typedef struct {
     //and the direction can be found by multiplying the signs along the union-find path
     spqr_arc representative;
     bool reversed;
-} SPQRNetworkDecompositionArc;
+} SPQRNetworkDecompositionArcUnionFind;
 
 typedef struct {
     spqr_member representativeMember;
@@ -47,10 +52,65 @@ typedef struct {
     int numArcs;
 } SPQRNetworkDecompositionMember;
 
+typedef struct {
+    spqr_arc arc;
+    SPQRNetworkDecompositionArc data;
+    SPQRNetworkDecompositionArcUnionFind unionFind;
+} SPQRArcUndoEntry;
+
+typedef struct {
+    spqr_member member;
+    SPQRNetworkDecompositionMember data;
+} SPQRMemberUndoEntry;
+
+typedef struct {
+    spqr_node node;
+    SPQRNetworkDecompositionNode data;
+} SPQRNodeUndoEntry;
+
+typedef struct {
+    spqr_matrix_size index; //row or column index
+    spqr_arc arc;
+} SPQRElementUndoEntry;
+
+///Stores the old values of all entries which were modified since the checkpoint.
+///Arcs, members and nodes are only appended, so entries created after the checkpoint need not be stored;
+///they are dropped by resetting the counts.
+typedef struct {
+    bool active;
+    bool failed; //set if the log could not be enlarged, in which case the checkpoint can not be restored
+
+    int numArcs;
+    int numMembers;
+    int numNodes;
+    int numConnectedComponents;
+
+    SPQRArcUndoEntry * arcEntries;
+    int numArcEntries;
+    int memArcEntries;
+
+    SPQRMemberUndoEntry * memberEntries;
+    int numMemberEntries;
+    int memMemberEntries;
+
+    SPQRNodeUndoEntry * nodeEntries;
+    int numNodeEntries;
+    int memNodeEntries;
+
+    SPQRElementUndoEntry * rowEntries;
+    int numRowEntries;
+    int memRowEntries;
+
+    SPQRElementUndoEntry * columnEntries;
+    int numColumnEntries;
+    int memColumnEntries;
+} SPQRUndoLog;
+
 struct SPQRNetworkDecompositionImpl {
     int numArcs;
     int memArcs;
     SPQRNetworkDecompositionArc *arcs;
+    SPQRNetworkDecompositionArcUnionFind *arcUnionFind; //has the same size as arcs
     spqr_arc firstFreeArc;
 
     int memMembers;
@@ -72,8 +132,87 @@ struct SPQRNetworkDecompositionImpl {
     SPQR * env;
 
     int numConnectedComponents;
+
+    SPQRUndoLog undoLog;
 };
 
+///Makes room for one more entry in the given undo log array, and returns false if this fails
+static bool reserveUndoEntry(SPQRNetworkDecomposition *dec, void ** entries, size_t entrySize, int numEntries,
+                             int * memEntries){
+    if(numEntries < *memEntries){
+        return true;
+    }
+    int newSize = *memEntries == 0 ? 64 : 2 * *memEntries;
+    if(implSPQRreallocBlockArray(dec->env, entries, entrySize, (size_t) newSize) != SPQR_OKAY){
+        dec->undoLog.failed = true;
+        return false;
+    }
+    *memEntries = newSize;
+    return true;
+}
+
+///The log* functions must be called before modifying the respective entry, so that it can be restored on rollback
+static void logArc(SPQRNetworkDecomposition *dec, spqr_arc arc){
+    SPQRUndoLog * log = &dec->undoLog;
+    if(!log->active || arc >= log->numArcs ||
+       !reserveUndoEntry(dec, (void **) &log->arcEntries, sizeof(*log->arcEntries), log->numArcEntries,
+                         &log->memArcEntries)){
+        return;
+    }
+    log->arcEntries[log->numArcEntries].arc = arc;
+    log->arcEntries[log->numArcEntries].data = dec->arcs[arc];
+    log->arcEntries[log->numArcEntries].unionFind = dec->arcUnionFind[arc];
+    ++log->numArcEntries;
+}
+
+static void logMember(SPQRNetworkDecomposition *dec, spqr_member member){
+    SPQRUndoLog * log = &dec->undoLog;
+    if(!log->active || member >= log->numMembers ||
+       !reserveUndoEntry(dec, (void **) &log->memberEntries, sizeof(*log->memberEntries), log->numMemberEntries,
+                         &log->memMemberEntries)){
+        return;
+    }
+    log->memberEntries[log->numMemberEntries].member = member;
+    log->memberEntries[log->numMemberEntries].data = dec->members[member];
+    ++log->numMemberEntries;
+}
+
+static void logNode(SPQRNetworkDecomposition *dec, spqr_node node){
+    SPQRUndoLog * log = &dec->undoLog;
+    if(!log->active || node >= log->numNodes ||
+       !reserveUndoEntry(dec, (void **) &log->nodeEntries, sizeof(*log->nodeEntries), log->numNodeEntries,
+                         &log->memNodeEntries)){
+        return;
+    }
+    log->nodeEntries[log->numNodeEntries].node = node;
+    log->nodeEntries[log->numNodeEntries].data = dec->nodes[node];
+    ++log->numNodeEntries;
+}
+
+static void logRowArc(SPQRNetworkDecomposition *dec, spqr_row row){
+    SPQRUndoLog * log = &dec->undoLog;
+    if(!log->active ||
+       !reserveUndoEntry(dec, (void **) &log->rowEntries, sizeof(*log->rowEntries), log->numRowEntries,
+                         &log->memRowEntries)){
+        return;
+    }
+    log->rowEntries[log->numRowEntries].index = row;
+    log->rowEntries[log->numRowEntries].arc = dec->rowArcs[row];
+    ++log->numRowEntries;
+}
+
+static void logColumnArc(SPQRNetworkDecomposition *dec, spqr_col column){
+    SPQRUndoLog * log = &dec->undoLog;
+    if(!log->active ||
+       !reserveUndoEntry(dec, (void **) &log->columnEntries, sizeof(*log->columnEntries), log->numColumnEntries,
+                         &log->memColumnEntries)){
+        return;
+    }
+    log->columnEntries[log->numColumnEntries].index = column;
+    log->columnEntries[log->numColumnEntries].arc = dec->columnArcs[column];
+    ++log->numColumnEntries;
+}
+
 static void swap_ints(int* a, int* b){
     int temp = *a;
     *a = *b;
@@ -107,6 +246,7 @@ static spqr_node findNode(SPQRNetworkDecomposition *dec, spqr_node node) {
 
     //update all pointers along path to point to root, flattening the tree
     while (SPQRnodeIsValid(next = dec->nodes[current].representativeNode)) {
+        logNode(dec,current);
         dec->nodes[current].representativeNode = root;
         current = next;
         assert(current < dec->memNodes);
@@ -137,6 +277,7 @@ static spqr_node findArcTail(SPQRNetworkDecomposition *dec, spqr_arc arc) {
     assert(arc < dec->memArcs);
 
     spqr_node representative = findNode(dec, dec->arcs[arc].tail);
+    logArc(dec,arc);
     dec->arcs[arc].tail = representative; //update the arc information
 
     return representative;
@@ -147,6 +288,7 @@ static spqr_node findArcHead(SPQRNetworkDecomposition *dec, spqr_arc arc) {
     assert(arc < dec->memArcs);
 
     spqr_node representative = findNode(dec, dec->arcs[arc].head);
+    logArc(dec,arc);
     dec->arcs[arc].head = representative;//update the arc information
 
     return representative;
@@ -199,6 +341,7 @@ static spqr_arc getNextNodeArc(SPQRNetworkDecomposition * dec, spqr_arc arc, spq
         arc = dec->arcs[arc].headArcListNode.next;
     }else{
         assert(findArcTailNoCompression(dec,arc) == node);
+        logArc(dec,arc);
         dec->arcs[arc].tail = node; //This assignment is not necessary but speeds up future queries.
         arc = dec->arcs[arc].tailArcListNode.next;
     }
@@ -214,6 +357,7 @@ static spqr_arc getPreviousNodeArc(SPQRNetworkDecomposition *dec, spqr_arc arc,
         arc = dec->arcs[arc].headArcListNode.previous;
     }else{
         assert(findArcTailNoCompression(dec,arc) == node);
+        logArc(dec,arc);
         dec->arcs[arc].tail = node; //This assignment is not necessary but speeds up future queries.
         arc = dec->arcs[arc].tailArcListNode.previous;
     }
@@ -226,6 +370,8 @@ static void mergeNodeArcList(SPQRNetworkDecomposition *dec, spqr_node toMergeInt
     spqr_arc firstFromArc = getFirstNodeArc(dec, toRemove);
     if(SPQRarcIsInvalid(firstIntoArc)){
         //new node has no arcs
+        logNode(dec,toMergeInto);
+        logNode(dec,toRemove);
         dec->nodes[toMergeInto].numArcs += dec->nodes[toRemove].numArcs;
         dec->nodes[toRemove].numArcs = 0;
 
@@ -258,11 +404,17 @@ static void mergeNodeArcList(SPQRNetworkDecomposition *dec, spqr_node toMergeInt
                                                           &dec->arcs[lastFromArc].headArcListNode :
                                                           &dec->arcs[lastFromArc].tailArcListNode;
 
+    logArc(dec,firstIntoArc);
+    logArc(dec,lastIntoArc);
+    logArc(dec,firstFromArc);
+    logArc(dec,lastFromArc);
     firstIntoNode->previous = lastFromArc;
     lastIntoNode->next = firstFromArc;
     firstFromNode->previous = lastIntoArc;
     lastFromNode->next = firstIntoArc;
 
+    logNode(dec,toMergeInto);
+    logNode(dec,toRemove);
     dec->nodes[toMergeInto].numArcs += dec->nodes[toRemove].numArcs;
     dec->nodes[toRemove].numArcs = 0;
     dec->nodes[toRemove].firstArc = SPQR_INVALID_ARC;
@@ -272,20 +424,23 @@ static void arcFlipReversed(SPQRNetworkDecomposition *dec, spqr_arc arc){
     assert(dec);
     assert(SPQRarcIsValid(arc));
     assert(arc < dec->memArcs);
-    dec->arcs[arc].reversed = !dec->arcs[arc].reversed;
+    logArc(dec,arc);
+    dec->arcUnionFind[arc].reversed = !dec->arcUnionFind[arc].reversed;
 }
 static void arcSetReversed(SPQRNetworkDecomposition *dec, spqr_arc arc, bool reversed){
     assert(dec);
     assert(SPQRarcIsValid(arc));
     assert(arc < dec->memArcs);
-    dec->arcs[arc].reversed = reversed;
+    logArc(dec,arc);
+    dec->arcUnionFind[arc].reversed = reversed;
 }
 static void arcSetRepresentative(SPQRNetworkDecomposition *dec, spqr_arc arc, spqr_arc representative){
     assert(dec);
     assert(SPQRarcIsValid(arc));
     assert(arc < dec->memArcs);
     assert(representative == SPQR_INVALID_ARC || SPQRarcIsValid(representative));
-    dec->arcs[arc].representative = representative;
+    logArc(dec,arc);
+    dec->arcUnionFind[arc].representative = representative;
 }
 
 static spqr_node mergeNodes(SPQRNetworkDecomposition *dec, spqr_node first, spqr_node second) {
@@ -305,8 +460,10 @@ static spqr_node mergeNodes(SPQRNetworkDecomposition *dec, spqr_node first, spqr
     }
     //first becomes representative; we merge all of the arcs of second into first
     mergeNodeArcList(dec,first,second);
+    logNode(dec,second);
     dec->nodes[second].representativeNode = first;
     if (firstRank == secondRank) {
+        logNode(dec,first);
         --dec->nodes[first].representativeNode;
     }
     return first;
@@ -339,6 +496,7 @@ static spqr_member findMember(SPQRNetworkDecomposition *dec, spqr_member member)
 
     //update all pointers along path to point to root, flattening the tree
     while (SPQRmemberIsValid(next = dec->members[current].representativeMember)) {
+        logMember(dec,current);
         dec->members[current].representativeMember = root;
         current = next;
         assert(current < dec->memMembers);
@@ -379,8 +537,10 @@ static spqr_member mergeMembers(SPQRNetworkDecomposition *dec, spqr_member first
     if (firstRank > secondRank) {
         swap_ints(&first, &second);
     }
+    logMember(dec,second);
     dec->members[second].representativeMember = first;
     if (firstRank == secondRank) {
+        logMember(dec,first);
         --dec->members[first].representativeMember;
     }
     return first;
@@ -391,8 +551,9 @@ static spqr_member findArcMember(SPQRNetworkDecomposition *dec, spqr_arc arc) {
     assert(SPQRarcIsValid(arc));
     assert(arc < dec->memArcs);
 
-    spqr_member representative = findMember(dec, dec->arcs[arc].member);
-    dec->arcs[arc].member = representative;
+    spqr_member representative = findMember(dec, dec->arcUnionFind[arc].member);
+    logArc(dec,arc);
+    dec->arcUnionFind[arc].member = representative;
     return representative;
 }
 
@@ -401,7 +562,7 @@ static spqr_member findArcMemberNoCompression(const SPQRNetworkDecomposition *de
     assert(SPQRarcIsValid(arc));
     assert(arc < dec->memArcs);
 
-    spqr_member representative = findMemberNoCompression(dec, dec->arcs[arc].member);
+    spqr_member representative = findMemberNoCompression(dec, dec->arcUnionFind[arc].member);
     return representative;
 }
 
@@ -416,6 +577,7 @@ static spqr_member findMemberParent(SPQRNetworkDecomposition *dec, spqr_member m
         return dec->members[member].parentMember;
     }
     spqr_member parent_representative = findMember(dec, dec->members[member].parentMember);
+    logMember(dec,member);
     dec->members[member].parentMember = parent_representative;
 
     return parent_representative;
@@ -440,6 +602,7 @@ static spqr_member findArcChildMember(SPQRNetworkDecomposition *dec, spqr_arc ar
     assert(arc < dec->memArcs);
 
     spqr_member representative = findMember(dec, dec->arcs[arc].childMember);
+    logArc(dec,arc);
     dec->arcs[arc].childMember = representative;
     return representative;
 }
@@ -480,7 +643,7 @@ static bool arcIsRepresentative(const SPQRNetworkDecomposition *dec, spqr_arc ar
     assert(arc < dec->memArcs);
     assert(SPQRarcIsValid(arc));
 
-    return SPQRarcIsInvalid(dec->arcs[arc].representative);
+    return SPQRarcIsInvalid(dec->arcUnionFind[arc].representative);
 }
 
 static ArcSign findArcSign(SPQRNetworkDecomposition *dec, spqr_arc arc) {
@@ -491,28 +654,29 @@ static ArcSign findArcSign(SPQRNetworkDecomposition *dec, spqr_arc arc) {
     spqr_arc current = arc;
     spqr_arc next;
 
-    bool totalReversed = dec->arcs[current].reversed;
+    bool totalReversed = dec->arcUnionFind[current].reversed;
     //traverse down tree to find the root
-    while (SPQRarcIsValid(next = dec->arcs[current].representative)) {
+    while (SPQRarcIsValid(next = dec->arcUnionFind[current].representative)) {
         current = next;
         assert(current < dec->memArcs);
         //swap boolean only if new arc is reversed
-        totalReversed = (totalReversed != dec->arcs[current].reversed);
+        totalReversed = (totalReversed != dec->arcUnionFind[current].reversed);
     }
 
     spqr_arc root = current;
     current = arc;
 
-    bool currentReversed = totalReversed != dec->arcs[root].reversed;
+    bool currentReversed = totalReversed != dec->arcUnionFind[root].reversed;
     //update all pointers along path to point to root, flattening the tree
 
-    while (SPQRarcIsValid(next = dec->arcs[current].representative)) {
-        bool wasReversed = dec->arcs[current].reversed;
+    while (SPQRarcIsValid(next = dec->arcUnionFind[current].representative)) {
+        bool wasReversed = dec->arcUnionFind[current].reversed;
 
-        dec->arcs[current].reversed = currentReversed;
+        logArc(dec,current);
+        dec->arcUnionFind[current].reversed = currentReversed;
         currentReversed = (currentReversed != wasReversed);
 
-        dec->arcs[current].representative = root;
+        dec->arcUnionFind[current].representative = root;
         current = next;
         assert(current < dec->memArcs);
     }
@@ -531,13 +695,13 @@ static ArcSign findArcSignNoCompression(const SPQRNetworkDecomposition *dec, spq
     spqr_arc current = arc;
     spqr_arc next;
 
-    bool totalReversed = dec->arcs[current].reversed;
+    bool totalReversed = dec->arcUnionFind[current].reversed;
     //traverse down tree to find the root
-    while (SPQRarcIsValid(next = dec->arcs[current].representative)) {
+    while (SPQRarcIsValid(next = dec->arcUnionFind[current].representative)) {
         current = next;
         assert(current < dec->memArcs);
         //swap boolean only if new arc is reversed
-        totalReversed = (totalReversed != dec->arcs[current].reversed);
+        totalReversed = (totalReversed != dec->arcUnionFind[current].reversed);
     }
     ArcSign sign;
     sign.reversed = totalReversed;
@@ -591,22 +755,24 @@ static spqr_arc mergeArcSigns(SPQRNetworkDecomposition *dec, spqr_arc first, spq
 
     //The rank is stored as a negative number: we decrement it making the negative number larger.
     // We want the new root to be the one with 'largest' rank, so smallest number. If they are equal, we decrement.
-    spqr_member firstRank = dec->arcs[first].representative;
-    spqr_member secondRank = dec->arcs[second].representative;
+    spqr_member firstRank = dec->arcUnionFind[first].representative;
+    spqr_member secondRank = dec->arcUnionFind[second].representative;
 
     spqr_arc initialFirst = first;
     if (firstRank > secondRank) {
         swap_ints(&first, &second);
     }
-    dec->arcs[second].representative = first;
+    logArc(dec,first);
+    logArc(dec,second);
+    dec->arcUnionFind[second].representative = first;
     if (firstRank == secondRank) {
-        --dec->arcs[first].representative;
+        --dec->arcUnionFind[first].representative;
     }
     //These boolean formula's cover all 16 possible cases, such that the relative orientation of the first is not changed
-    bool equal = dec->arcs[first].reversed == dec->arcs[second].reversed;
-    dec->arcs[second].reversed = (equal == reflectRelative);
+    bool equal = dec->arcUnionFind[first].reversed == dec->arcUnionFind[second].reversed;
+    dec->arcUnionFind[second].reversed = (equal == reflectRelative);
     if(firstRank > secondRank){
-        dec->arcs[first].reversed = (dec->arcs[first].reversed != reflectRelative);
+        dec->arcUnionFind[first].reversed = (dec->arcUnionFind[first].reversed != reflectRelative);
     }
     return first;
 }
@@ -619,7 +785,7 @@ static bool arcIsReversedNonRigid(const SPQRNetworkDecomposition *dec, spqr_arc
     assert(SPQRarcIsValid(arc));
     assert(arc < dec->memArcs);
 
-    return dec->arcs[arc].reversed;
+    return dec->arcUnionFind[arc].reversed;
 }
 
 
@@ -644,12 +810,14 @@ static void setDecompositionColumnArc(SPQRNetworkDecomposition *dec, spqr_col co
     assert(SPQRcolIsValid(col) && (int)col < dec->memColumns);
     assert(dec);
     assert(SPQRarcIsValid(arc));
+    logColumnArc(dec,col);
     dec->columnArcs[col] = arc;
 }
 static void setDecompositionRowArc(SPQRNetworkDecomposition *dec, spqr_row row, spqr_arc arc){
     assert(SPQRrowIsValid(row) && (int) row < dec->memRows);
     assert(dec);
     assert(SPQRarcIsValid(arc));
+    logRowArc(dec,row);
     dec->rowArcs[row] = arc;
 }
 static spqr_arc getDecompositionColumnArc(const SPQRNetworkDecomposition *dec, spqr_col col){
@@ -679,9 +847,10 @@ SPQR_ERROR SPQRNetworkDecompositionCreate(SPQR * env, SPQRNetworkDecomposition *
         dec->memArcs = initialMemArcs;
         dec->numArcs = 0;
         SPQR_CALL(SPQRallocBlockArray(env, &dec->arcs, (size_t) dec->memArcs));
+        SPQR_CALL(SPQRallocBlockArray(env, &dec->arcUnionFind, (size_t) dec->memArcs));
         for (spqr_arc i = 0; i < dec->memArcs; ++i) {
             dec->arcs[i].arcListNode.next = i + 1;
-            dec->arcs[i].member = SPQR_INVALID_MEMBER;
+            dec->arcUnionFind[i].member = SPQR_INVALID_MEMBER;
         }
         dec->arcs[dec->memArcs - 1].arcListNode.next = SPQR_INVALID_ARC;
         dec->firstFreeArc = 0;
@@ -724,6 +893,41 @@ SPQR_ERROR SPQRNetworkDecompositionCreate(SPQR * env, SPQRNetworkDecomposition *
     }
 
     dec->numConnectedComponents = 0;
+
+    SPQRUndoLog empty = {0};
+    dec->undoLog = empty;
+    return SPQR_OKAY;
+}
+
+SPQR_ERROR SPQRNetworkDecompositionReserve(SPQRNetworkDecomposition *dec, int numArcs, int numMembers, int numNodes){
+    assert(dec);
+    assert(!dec->undoLog.active);
+
+    if(numArcs > dec->memArcs){
+        int oldSize = dec->memArcs;
+        SPQR_CALL(SPQRreallocBlockArray(dec->env, &dec->arcs, (size_t) numArcs));
+        SPQR_CALL(SPQRreallocBlockArray(dec->env, &dec->arcUnionFind, (size_t) numArcs));
+        for (int i = oldSize; i < numArcs; ++i) {
+            dec->arcs[i].arcListNode.next = i + 1;
+            dec->arcUnionFind[i].member = SPQR_INVALID_MEMBER;
+        }
+        dec->arcs[numArcs - 1].arcListNode.next = SPQR_INVALID_ARC;
+        //The free list always consists of the arcs numArcs,...,memArcs-1 in order, so we append the new arcs to it
+        if(SPQRarcIsValid(dec->firstFreeArc)){
+            dec->arcs[oldSize - 1].arcListNode.next = oldSize;
+        }else{
+            dec->firstFreeArc = oldSize;
+        }
+        dec->memArcs = numArcs;
+    }
+    if(numMembers > dec->memMembers){
+        SPQR_CALL(SPQRreallocBlockArray(dec->env, &dec->members, (size_t) numMembers));
+        dec->memMembers = numMembers;
+    }
+    if(numNodes > dec->memNodes){
+        SPQR_CALL(SPQRreallocBlockArray(dec->env, &dec->nodes, (size_t) numNodes));
+        dec->memNodes = numNodes;
+    }
     return SPQR_OKAY;
 }
 
@@ -732,15 +936,100 @@ void SPQRNetworkDecompositionFree(SPQRNetworkDecomposition **pDec){
     assert(*pDec);
 
     SPQRNetworkDecomposition *dec = *pDec;
+    SPQRfreeBlockArray(dec->env, &dec->undoLog.columnEntries);
+    SPQRfreeBlockArray(dec->env, &dec->undoLog.rowEntries);
+    SPQRfreeBlockArray(dec->env, &dec->undoLog.nodeEntries);
+    SPQRfreeBlockArray(dec->env, &dec->undoLog.memberEntries);
+    SPQRfreeBlockArray(dec->env, &dec->undoLog.arcEntries);
     SPQRfreeBlockArray(dec->env, &dec->columnArcs);
     SPQRfreeBlockArray(dec->env, &dec->rowArcs);
     SPQRfreeBlockArray(dec->env, &dec->nodes);
     SPQRfreeBlockArray(dec->env, &dec->members);
+    SPQRfreeBlockArray(dec->env, &dec->arcUnionFind);
     SPQRfreeBlockArray(dec->env, &dec->arcs);
 
     SPQRfreeBlock(dec->env, pDec);
 
 }
+
+static void clearUndoLog(SPQRUndoLog * log){
+    log->active = false;
+    log->failed = false;
+    log->numArcEntries = 0;
+    log->numMemberEntries = 0;
+    log->numNodeEntries = 0;
+    log->numRowEntries = 0;
+    log->numColumnEntries = 0;
+}
+
+void SPQRNetworkDecompositionCheckpoint(SPQRNetworkDecomposition *dec){
+    assert(dec);
+    assert(!dec->undoLog.active);
+
+    SPQRUndoLog * log = &dec->undoLog;
+    clearUndoLog(log);
+    log->active = true;
+    log->numArcs = dec->numArcs;
+    log->numMembers = dec->numMembers;
+    log->numNodes = dec->numNodes;
+    log->numConnectedComponents = dec->numConnectedComponents;
+}
+
+void SPQRNetworkDecompositionCommit(SPQRNetworkDecomposition *dec){
+    assert(dec);
+    assert(dec->undoLog.active);
+    clearUndoLog(&dec->undoLog);
+}
+
+SPQR_ERROR SPQRNetworkDecompositionRollback(SPQRNetworkDecomposition *dec){
+    assert(dec);
+    assert(dec->undoLog.active);
+
+    SPQRUndoLog * log = &dec->undoLog;
+    if(log->failed){
+        clearUndoLog(log);
+        return SPQR_ERROR_MEMORY;
+    }
+    //Restore in reverse order, so that every entry ends up with the value it had when it was first logged
+    for (int i = log->numArcEntries - 1; i >= 0; --i) {
+        dec->arcs[log->arcEntries[i].arc] = log->arcEntries[i].data;
+        dec->arcUnionFind[log->arcEntries[i].arc] = log->arcEntries[i].unionFind;
+    }
+    for (int i = log->numMemberEntries - 1; i >= 0; --i) {
+        dec->members[log->memberEntries[i].member] = log->memberEntries[i].data;
+    }
+    for (int i = log->numNodeEntries - 1; i >= 0; --i) {
+        dec->nodes[log->nodeEntries[i].node] = log->nodeEntries[i].data;
+    }
+    for (int i = log->numRowEntries - 1; i >= 0; --i) {
+        dec->rowArcs[log->rowEntries[i].index] = log->rowEntries[i].arc;
+    }
+    for (int i = log->numColumnEntries - 1; i >= 0; --i) {
+        dec->columnArcs[log->columnEntries[i].index] = log->columnEntries[i].arc;
+    }
+
+    //Arcs are handed out in order from the free list, so the arcs created since the checkpoint are put back on it
+    for (int i = log->numArcs; i < dec->numArcs; ++i) {
+        dec->arcs[i].arcListNode.next = i + 1;
+        dec->arcUnionFind[i].member = SPQR_INVALID_MEMBER;
+    }
+    if(dec->numArcs == dec->memArcs && log->numArcs < dec->numArcs){
+        dec->arcs[dec->memArcs - 1].arcListNode.next = SPQR_INVALID_ARC;
+    }
+    dec->firstFreeArc = log->numArcs < dec->memArcs ? log->numArcs : SPQR_INVALID_ARC;
+
+    dec->numArcs = log->numArcs;
+    dec->numMembers = log->numMembers;
+    dec->numNodes = log->numNodes;
+    dec->numConnectedComponents = log->numConnectedComponents;
+    clearUndoLog(log);
+    return SPQR_OKAY;
+}
+
+bool SPQRNetworkDecompositionHasCheckpoint(const SPQRNetworkDecomposition *dec){
+    assert(dec);
+    return dec->undoLog.active;
+}
 static spqr_arc getFirstMemberArc(const SPQRNetworkDecomposition * dec, spqr_member member){
     assert(dec);
     assert(SPQRmemberIsValid(member));
@@ -767,15 +1056,20 @@ static void addArcToMemberArcList(SPQRNetworkDecomposition *dec, spqr_arc arc, s
 
     if(SPQRarcIsValid(firstMemberArc)){
         spqr_arc lastMemberArc = getPreviousMemberArc(dec, firstMemberArc);
+        logArc(dec,arc);
         dec->arcs[arc].arcListNode.next = firstMemberArc;
         dec->arcs[arc].arcListNode.previous = lastMemberArc;
+        logArc(dec,firstMemberArc);
         dec->arcs[firstMemberArc].arcListNode.previous = arc;
+        logArc(dec,lastMemberArc);
         dec->arcs[lastMemberArc].arcListNode.next = arc;
     }else{
         assert(dec->members[member].numArcs == 0);
+        logArc(dec,arc);
         dec->arcs[arc].arcListNode.next = arc;
         dec->arcs[arc].arcListNode.previous = arc;
     }
+    logMember(dec,member);
     dec->members[member].firstArc = arc;//TODO: update this in case of row/column arcs to make memory ordering nicer?
     ++(dec->members[member].numArcs);
 }
@@ -791,9 +1085,10 @@ static SPQR_ERROR createArc(SPQRNetworkDecomposition *dec, spqr_member member,bo
         //Enlarge array, no free nodes in arc list
         int newSize = 2 * dec->memArcs;
         SPQR_CALL(SPQRreallocBlockArray(dec->env, &dec->arcs, (size_t) newSize));
+        SPQR_CALL(SPQRreallocBlockArray(dec->env, &dec->arcUnionFind, (size_t) newSize));
         for (int i = dec->memArcs + 1; i < newSize; ++i) {
             dec->arcs[i].arcListNode.next = i + 1;
-            dec->arcs[i].member = SPQR_INVALID_MEMBER;
+            dec->arcUnionFind[i].member = SPQR_INVALID_MEMBER;
         }
         dec->arcs[newSize - 1].arcListNode.next = SPQR_INVALID_ARC;
         dec->firstFreeArc = dec->memArcs + 1;
@@ -803,9 +1098,9 @@ static SPQR_ERROR createArc(SPQRNetworkDecomposition *dec, spqr_member member,bo
     //TODO: Is defaulting these here necessary?
     dec->arcs[index].tail = SPQR_INVALID_NODE;
     dec->arcs[index].head = SPQR_INVALID_NODE;
-    dec->arcs[index].member = member;
+    dec->arcUnionFind[index].member = member;
     dec->arcs[index].childMember = SPQR_INVALID_MEMBER;
-    dec->arcs[index].reversed = reversed;
+    dec->arcUnionFind[index].reversed = reversed;
 
     dec->arcs[index].headArcListNode.next = SPQR_INVALID_ARC;
     dec->arcs[index].headArcListNode.previous = SPQR_INVALID_ARC;
@@ -874,6 +1169,8 @@ static SPQR_ERROR createNode(SPQRNetworkDecomposition *dec, spqr_node * pNode){
     return SPQR_OKAY;
 }
 static void removeArcFromNodeArcList(SPQRNetworkDecomposition *dec, spqr_arc arc, spqr_node node, bool nodeIsHead){
+    logArc(dec,arc);
+    logNode(dec,node);
     SPQRNetworkDecompositionArcListNode * arcListNode = nodeIsHead ? &dec->arcs[arc].headArcListNode : &dec->arcs[arc].tailArcListNode;
 
     if(dec->nodes[node].numArcs == 1){
@@ -881,7 +1178,9 @@ static void removeArcFromNodeArcList(SPQRNetworkDecomposition *dec, spqr_arc arc
     }else{
         spqr_arc next_arc = arcListNode->next;
         spqr_arc prev_arc = arcListNode->previous;
+        logArc(dec,next_arc);
         SPQRNetworkDecompositionArcListNode * nextListNode = findArcHead(dec, next_arc) == node ? &dec->arcs[next_arc].headArcListNode : &dec->arcs[next_arc].tailArcListNode;//TODO: finds necessary?
+        logArc(dec,prev_arc);
         SPQRNetworkDecompositionArcListNode * prevListNode = findArcHead(dec, prev_arc) == node ? &dec->arcs[prev_arc].headArcListNode : &dec->arcs[prev_arc].tailArcListNode;//TODO: finds necessary?
 
         nextListNode->previous = prev_arc;
@@ -899,9 +1198,11 @@ static void addArcToNodeArcList(SPQRNetworkDecomposition *dec, spqr_arc arc, spq
 
     spqr_arc firstNodeArc = getFirstNodeArc(dec, node);
 
+    logArc(dec,arc);
     SPQRNetworkDecompositionArcListNode * arcListNode = nodeIsHead ? &dec->arcs[arc].headArcListNode : &dec->arcs[arc].tailArcListNode;
     if(SPQRarcIsValid(firstNodeArc)){
         bool nextIsHead = findArcHead(dec,firstNodeArc) == node;
+        logArc(dec,firstNodeArc);
         SPQRNetworkDecompositionArcListNode *nextListNode = nextIsHead ? &dec->arcs[firstNodeArc].headArcListNode : &dec->arcs[firstNodeArc].tailArcListNode;
         spqr_arc lastNodeArc = nextListNode->previous;
 
@@ -910,6 +1211,7 @@ static void addArcToNodeArcList(SPQRNetworkDecomposition *dec, spqr_arc arc, spq
 
 
         bool previousIsHead = findArcHead(dec,lastNodeArc) == node;
+        logArc(dec,lastNodeArc);
         SPQRNetworkDecompositionArcListNode *previousListNode = previousIsHead ? &dec->arcs[lastNodeArc].headArcListNode : &dec->arcs[lastNodeArc].tailArcListNode;
         previousListNode->next = arc;
         nextListNode->previous = arc;
@@ -918,6 +1220,7 @@ static void addArcToNodeArcList(SPQRNetworkDecomposition *dec, spqr_arc arc, spq
         arcListNode->next = arc;
         arcListNode->previous = arc;
     }
+    logNode(dec,node);
     dec->nodes[node].firstArc = arc; //TODO: update this in case of row/column arcs to make memory ordering nicer?er?
     ++dec->nodes[node].numArcs;
     if(nodeIsHead){
@@ -933,6 +1236,7 @@ static void setArcHeadAndTail(SPQRNetworkDecomposition *dec, spqr_arc arc, spqr_
 static void clearArcHeadAndTail(SPQRNetworkDecomposition *dec, spqr_arc arc){
     removeArcFromNodeArcList(dec,arc,findArcHead(dec,arc),true);
     removeArcFromNodeArcList(dec,arc,findArcTail(dec,arc),false);
+    logArc(dec,arc);
     dec->arcs[arc].head = SPQR_INVALID_NODE;
     dec->arcs[arc].tail = SPQR_INVALID_NODE;
 }
@@ -949,6 +1253,7 @@ static void changeArcTail(SPQRNetworkDecomposition *dec, spqr_arc arc, spqr_node
     addArcToNodeArcList(dec,arc,newTail,false);
 }
 static void flipArc(SPQRNetworkDecomposition *dec, spqr_arc arc){
+    logArc(dec,arc);
     swap_ints(&dec->arcs[arc].head,&dec->arcs[arc].tail);
 
     SPQRNetworkDecompositionArcListNode temp = dec->arcs[arc].headArcListNode;
@@ -969,12 +1274,13 @@ static SPQRMemberType getMemberType(const SPQRNetworkDecomposition *dec, spqr_me
     assert(memberIsRepresentative(dec,member));
     return dec->members[member].type;
 }
-static void updateMemberType(const SPQRNetworkDecomposition *dec, spqr_member member, SPQRMemberType type){
+static void updateMemberType(SPQRNetworkDecomposition *dec, spqr_member member, SPQRMemberType type){
     assert(dec);
     assert(SPQRmemberIsValid(member));
     assert(member < dec->memMembers);
     assert(memberIsRepresentative(dec,member));
 
+    logMember(dec,member);
     dec->members[member].type = type;
 }
 static spqr_arc markerToParent(const SPQRNetworkDecomposition *dec, spqr_member member){
@@ -1003,10 +1309,12 @@ static void updateMemberParentInformation(SPQRNetworkDecomposition *dec, const s
     assert(memberIsRepresentative(dec,newMember));
     assert(findMemberNoCompression(dec,toRemove) == newMember);
 
+    logMember(dec,newMember);
     dec->members[newMember].markerOfParent = dec->members[toRemove].markerOfParent;
     dec->members[newMember].markerToParent = dec->members[toRemove].markerToParent;
     dec->members[newMember].parentMember = dec->members[toRemove].parentMember;
 
+    logMember(dec,toRemove);
     dec->members[toRemove].markerOfParent = SPQR_INVALID_ARC;
     dec->members[toRemove].markerToParent = SPQR_INVALID_ARC;
     dec->members[toRemove].parentMember = SPQR_INVALID_MEMBER;
@@ -1110,6 +1418,7 @@ static void removeArcFromMemberArcList(SPQRNetworkDecomposition *dec, spqr_arc a
     assert(findArcMemberNoCompression(dec,arc) == member);
     assert(memberIsRepresentative(dec,member));
 
+    logMember(dec,member);
     if(dec->members[member].numArcs == 1){
         dec->members[member].firstArc = SPQR_INVALID_ARC;
 
@@ -1118,7 +1427,9 @@ static void removeArcFromMemberArcList(SPQRNetworkDecomposition *dec, spqr_arc a
         spqr_arc nextArc = dec->arcs[arc].arcListNode.next;
         spqr_arc prevArc = dec->arcs[arc].arcListNode.previous;
 
+        logArc(dec,nextArc);
         dec->arcs[nextArc].arcListNode.previous = prevArc;
+        logArc(dec,prevArc);
         dec->arcs[prevArc].arcListNode.next = nextArc;
 
         if(dec->members[member].firstArc == arc){
@@ -1399,6 +1710,7 @@ static SPQR_ERROR createParentMarker(SPQRNetworkDecomposition *dec, spqr_member
 
     addArcToMemberArcList(dec,*arc,member);
 
+    logMember(dec,member);
     dec->members[member].parentMember = parent;
     dec->members[member].markerOfParent = parentMarker;
     dec->members[member].markerToParent = *arc;
@@ -1439,21 +1751,25 @@ static void moveArcToNewMember(SPQRNetworkDecomposition *dec, spqr_arc arc, spqr
     removeArcFromMemberArcList(dec,arc,oldMember);
     addArcToMemberArcList(dec,arc,newMember);
 
-    dec->arcs[arc].member = newMember;
+    logArc(dec,arc);
+    dec->arcUnionFind[arc].member = newMember;
 
     //If this arc has a childMember, update the information correctly!
     spqr_member childMember = dec->arcs[arc].childMember;
     if(SPQRmemberIsValid(childMember)){
         spqr_member childRepresentative = findArcChildMember(dec, arc);
+        logMember(dec,childRepresentative);
         dec->members[childRepresentative].parentMember = newMember;
     }
     //If this arc is a marker to the parent, update the child arc marker of the parent to reflect the move
     if(dec->members[oldMember].markerToParent == arc){
+        logMember(dec,newMember);
         dec->members[newMember].markerToParent = arc;
         dec->members[newMember].parentMember = dec->members[oldMember].parentMember;
         dec->members[newMember].markerOfParent = dec->members[oldMember].markerOfParent;
 
         assert(findArcChildMemberNoCompression(dec,dec->members[oldMember].markerOfParent) == oldMember);
+        logArc(dec,dec->members[oldMember].markerOfParent);
         dec->arcs[dec->members[oldMember].markerOfParent].childMember = newMember;
     }
 }
@@ -1467,12 +1783,18 @@ static void mergeMemberArcList(SPQRNetworkDecomposition *dec, spqr_member toMerg
     spqr_arc lastFromArc = getPreviousMemberArc(dec, firstFromArc);
 
     //Relink linked lists to merge them effectively
+    logArc(dec,firstIntoArc);
     dec->arcs[firstIntoArc].arcListNode.previous = lastFromArc;
+    logArc(dec,lastIntoArc);
     dec->arcs[lastIntoArc].arcListNode.next = firstFromArc;
+    logArc(dec,firstFromArc);
     dec->arcs[firstFromArc].arcListNode.previous = lastIntoArc;
+    logArc(dec,lastFromArc);
     dec->arcs[lastFromArc].arcListNode.next = firstIntoArc;
 
     //Clean up old
+    logMember(dec,toMergeInto);
+    logMember(dec,toRemove);
     dec->members[toMergeInto].numArcs += dec->members[toRemove].numArcs;
     dec->members[toRemove].numArcs = 0;
     dec->members[toRemove].firstArc = SPQR_INVALID_ARC;
@@ -1486,6 +1808,7 @@ static void changeLoopToSeries(SPQRNetworkDecomposition * dec, spqr_member membe
     assert((getMemberType(dec,member) == SPQR_MEMBERTYPE_PARALLEL || getMemberType(dec, member) == SPQR_MEMBERTYPE_SERIES ||
             getMemberType(dec,member) == SPQR_MEMBERTYPE_LOOP) && getNumMemberArcs(dec, member) == 2);
     assert(memberIsRepresentative(dec,member));
+    logMember(dec,member);
     dec->members[member].type = SPQR_MEMBERTYPE_SERIES;
 }
 static void changeLoopToParallel(SPQRNetworkDecomposition * dec, spqr_member member){
@@ -1495,6 +1818,7 @@ static void changeLoopToParallel(SPQRNetworkDecomposition * dec, spqr_member mem
     assert((getMemberType(dec,member) == SPQR_MEMBERTYPE_PARALLEL || getMemberType(dec, member) == SPQR_MEMBERTYPE_SERIES ||
             getMemberType(dec,member) == SPQR_MEMBERTYPE_LOOP) && getNumMemberArcs(dec, member) == 2);
     assert(memberIsRepresentative(dec,member));
+    logMember(dec,member);
     dec->members[member].type = SPQR_MEMBERTYPE_PARALLEL;
 }
 bool SPQRNetworkDecompositionIsMinimal(const SPQRNetworkDecomposition * dec){
@@ -1561,13 +1885,16 @@ static void mergeLoop(SPQRNetworkDecomposition * dec, spqr_member loopMember){
 
     spqr_arc loopChildArc = dec->members[childMember].markerOfParent;
 
+    logMember(dec,childMember);
     dec->members[childMember].markerOfParent = loopParentMarkerToLoop;
     dec->members[childMember].parentMember = loopParentMember;
+    logArc(dec,loopParentMarkerToLoop);
     dec->arcs[loopParentMarkerToLoop].childMember = childMember;
 
     //TODO: clean up the loopMember
     removeArcFromMemberArcList(dec,loopChildArc,loopMember);
     removeArcFromMemberArcList(dec,dec->members[loopMember].markerToParent,loopMember);
+    logMember(dec,loopMember);
     dec->members[loopMember].type = SPQR_MEMBERTYPE_UNASSIGNED;
     //TODO: probably just use 'merge' functionality twice here instead
 }
@@ -1595,10 +1922,13 @@ static void reorderComponent(SPQRNetworkDecomposition *dec, spqr_member newRoot)
             spqr_arc oldMarkerToParent = dec->members[member].markerToParent;
             spqr_arc oldMarkerOfParent = dec->members[member].markerOfParent;
 
+            logMember(dec,member);
             dec->members[member].markerToParent = newMarkerToParent;
             dec->members[member].markerOfParent = markerOfNewParent;
             dec->members[member].parentMember = newParent;
+            logArc(dec,markerOfNewParent);
             dec->arcs[markerOfNewParent].childMember = member;
+            logArc(dec,newMarkerToParent);
             dec->arcs[newMarkerToParent].childMember = SPQR_INVALID_MEMBER;
 
             if (SPQRmemberIsValid(oldParent)){
@@ -1610,6 +1940,7 @@ static void reorderComponent(SPQRNetworkDecomposition *dec, spqr_member newRoot)
                 break;
             }
         }while(true);
+        logMember(dec,newRoot);
         dec->members[newRoot].parentMember = SPQR_INVALID_MEMBER;
         dec->members[newRoot].markerToParent = SPQR_INVALID_ARC;
         dec->members[newRoot].markerOfParent = SPQR_INVALID_ARC;
@@ -1837,6 +2168,7 @@ void SPQRNetworkDecompositionRemoveComponents(SPQRNetworkDecomposition *dec, con
     for (int i = 0; i < numRows; ++i) {
         spqr_row row = componentRows[i];
         if(SPQRarcIsValid(dec->rowArcs[row])){
+            logRowArc(dec,row);
             dec->rowArcs[row] = SPQR_INVALID_ARC;
         }
     }
@@ -1844,11 +2176,135 @@ void SPQRNetworkDecompositionRemoveComponents(SPQRNetworkDecomposition *dec, con
     for (int i = 0; i < numCols; ++i) {
         spqr_col col = componentCols[i];
         if(SPQRarcIsValid(dec->columnArcs[col])){
+            logColumnArc(dec,col);
             dec->columnArcs[col] = SPQR_INVALID_ARC;
         }
     }
 }
 
+static int growCapacity(int capacity, int required){
+    int newSize = capacity > 0 ? capacity : 1;
+    while(newSize < required){
+        newSize *= 2;
+    }
+    return newSize;
+}
+
+static int offsetIfValid(int index, int offset){
+    //Invalid indices and the (negative) union-find ranks stay as they are
+    return index >= 0 ? index + offset : index;
+}
+
+SPQR_ERROR SPQRNetworkDecompositionMerge(SPQRNetworkDecomposition *dec, const SPQRNetworkDecomposition *other){
+    assert(dec);
+    assert(other);
+    assert(dec->memRows == other->memRows);
+    assert(dec->memColumns == other->memColumns);
+    assert(!dec->undoLog.active);
+
+    //Arcs, members and nodes are never freed, so the used entries are exactly the first num* entries of each array
+    const int arcOffset = dec->numArcs;
+    const int memberOffset = dec->numMembers;
+    const int nodeOffset = dec->numNodes;
+    const int totalArcs = dec->numArcs + other->numArcs;
+    const int totalMembers = dec->numMembers + other->numMembers;
+    const int totalNodes = dec->numNodes + other->numNodes;
+
+    //All arrays are grown before anything is copied, and the capacities are only updated once every reallocation
+    //succeeded, so that a failed allocation leaves dec unchanged. An array which is larger than its recorded capacity
+    //is still consistent.
+    const int newMemArcs = totalArcs > dec->memArcs ? growCapacity(dec->memArcs,totalArcs) : dec->memArcs;
+    const int newMemMembers = totalMembers > dec->memMembers ? growCapacity(dec->memMembers,totalMembers) : dec->memMembers;
+    const int newMemNodes = totalNodes > dec->memNodes ? growCapacity(dec->memNodes,totalNodes) : dec->memNodes;
+    if(newMemArcs != dec->memArcs){
+        SPQR_CALL(SPQRreallocBlockArray(dec->env, &dec->arcs, (size_t) newMemArcs));
+        SPQR_CALL(SPQRreallocBlockArray(dec->env, &dec->arcUnionFind, (size_t) newMemArcs));
+    }
+    if(newMemMembers != dec->memMembers){
+        SPQR_CALL(SPQRreallocBlockArray(dec->env, &dec->members, (size_t) newMemMembers));
+    }
+    if(newMemNodes != dec->memNodes){
+        SPQR_CALL(SPQRreallocBlockArray(dec->env, &dec->nodes, (size_t) newMemNodes));
+    }
+    dec->memArcs = newMemArcs;
+    dec->memMembers = newMemMembers;
+    dec->memNodes = newMemNodes;
+
+    {
+        for (int i = 0; i < other->numArcs; ++i) {
+            const SPQRNetworkDecompositionArc * source = &other->arcs[i];
+            SPQRNetworkDecompositionArc * target = &dec->arcs[arcOffset + i];
+            target->head = offsetIfValid(source->head,nodeOffset);
+            target->tail = offsetIfValid(source->tail,nodeOffset);
+            target->childMember = offsetIfValid(source->childMember,memberOffset);
+            target->headArcListNode.previous = offsetIfValid(source->headArcListNode.previous,arcOffset);
+            target->headArcListNode.next = offsetIfValid(source->headArcListNode.next,arcOffset);
+            target->tailArcListNode.previous = offsetIfValid(source->tailArcListNode.previous,arcOffset);
+            target->tailArcListNode.next = offsetIfValid(source->tailArcListNode.next,arcOffset);
+            target->arcListNode.previous = offsetIfValid(source->arcListNode.previous,arcOffset);
+            target->arcListNode.next = offsetIfValid(source->arcListNode.next,arcOffset);
+            target->element = source->element;
+
+            const SPQRNetworkDecompositionArcUnionFind * sourceUnionFind = &other->arcUnionFind[i];
+            SPQRNetworkDecompositionArcUnionFind * targetUnionFind = &dec->arcUnionFind[arcOffset + i];
+            targetUnionFind->member = offsetIfValid(sourceUnionFind->member,memberOffset);
+            targetUnionFind->representative = offsetIfValid(sourceUnionFind->representative,arcOffset);
+            targetUnionFind->reversed = sourceUnionFind->reversed;
+        }
+        dec->numArcs = totalArcs;
+        //Rebuild the free list from the remaining entries
+        for (int i = totalArcs; i < dec->memArcs; ++i) {
+            dec->arcs[i].arcListNode.next = i + 1;
+            dec->arcUnionFind[i].member = SPQR_INVALID_MEMBER;
+        }
+        if(totalArcs < dec->memArcs){
+            dec->arcs[dec->memArcs - 1].arcListNode.next = SPQR_INVALID_ARC;
+            dec->firstFreeArc = totalArcs;
+        }else{
+            dec->firstFreeArc = SPQR_INVALID_ARC;
+        }
+    }
+    {
+        for (int i = 0; i < other->numMembers; ++i) {
+            const SPQRNetworkDecompositionMember * source = &other->members[i];
+            SPQRNetworkDecompositionMember * target = &dec->members[memberOffset + i];
+            target->representativeMember = offsetIfValid(source->representativeMember,memberOffset);
+            target->type = source->type;
+            target->parentMember = offsetIfValid(source->parentMember,memberOffset);
+            target->markerToParent = offsetIfValid(source->markerToParent,arcOffset);
+            target->markerOfParent = offsetIfValid(source->markerOfParent,arcOffset);
+            target->firstArc = offsetIfValid(source->firstArc,arcOffset);
+            target->numArcs = source->numArcs;
+        }
+        dec->numMembers = totalMembers;
+    }
+    {
+        for (int i = 0; i < other->numNodes; ++i) {
+            const SPQRNetworkDecompositionNode * source = &other->nodes[i];
+            SPQRNetworkDecompositionNode * target = &dec->nodes[nodeOffset + i];
+            target->representativeNode = offsetIfValid(source->representativeNode,nodeOffset);
+            target->firstArc = offsetIfValid(source->firstArc,arcOffset);
+            target->numArcs = source->numArcs;
+        }
+        dec->numNodes = totalNodes;
+    }
+
+    for (int i = 0; i < other->memRows; ++i) {
+        if(SPQRarcIsValid(other->rowArcs[i])){
+            assert(SPQRarcIsInvalid(dec->rowArcs[i]));
+            dec->rowArcs[i] = other->rowArcs[i] + arcOffset;
+        }
+    }
+    for (int i = 0; i < other->memColumns; ++i) {
+        if(SPQRarcIsValid(other->columnArcs[i])){
+            assert(SPQRarcIsInvalid(dec->columnArcs[i]));
+            dec->columnArcs[i] = other->columnArcs[i] + arcOffset;
+        }
+    }
+    dec->numConnectedComponents += other->numConnectedComponents;
+    return SPQR_OKAY;
+}
+
 SPQRNetworkDecompositionStatistics SPQRNetworkDecompositionGetStatistics(SPQRNetworkDecomposition *dec){
     SPQRNetworkDecompositionStatistics stats;
     stats.numComponents = dec->numConnectedComponents;
@@ -1895,11 +2351,149 @@ SPQRNetworkDecompositionStatistics SPQRNetworkDecompositionGetStatistics(SPQRNet
     return stats;
 }
 
-
 static int max(int a, int b){
     return (a > b) ? a : b;
 }
 
+static spqr_node findRealizationNode(spqr_node * representative, spqr_node node){
+    while(representative[node] != node){
+        representative[node] = representative[representative[node]];
+        node = representative[node];
+    }
+    return node;
+}
+
+SPQR_ERROR SPQRNetworkDecompositionCreateRealization(const SPQRNetworkDecomposition *dec, int * numNodes,
+                                                     spqr_node * rowTails, spqr_node * rowHeads,
+                                                     spqr_node * columnTails, spqr_node * columnHeads){
+    assert(dec);
+    assert(numNodes);
+
+    //First, every member gets its own nodes: rigid members use their decomposition nodes, and the other members get
+    //fresh nodes after those, at most two per arc. Then, the endpoints of the two arcs of every marker pair are
+    //identified, which glues the members together into a single graph for every SPQR tree.
+    int numLocalNodes = dec->numNodes + 2 * dec->numArcs;
+    spqr_node * representative = NULL;
+    SPQR_CALL(SPQRallocBlockArray(dec->env, &representative, (size_t) max(numLocalNodes, 1)));
+    for (int i = 0; i < numLocalNodes; ++i) {
+        representative[i] = i;
+    }
+    spqr_node * arcTails = NULL;
+    spqr_node * arcHeads = NULL;
+    SPQR_CALL(SPQRallocBlockArray(dec->env, &arcTails, (size_t) max(dec->numArcs, 1)));
+    SPQR_CALL(SPQRallocBlockArray(dec->env, &arcHeads, (size_t) max(dec->numArcs, 1)));
+
+    spqr_node nextNode = dec->numNodes;
+    for (spqr_member member = 0; member < dec->numMembers; ++member) {
+        if(!memberIsRepresentative(dec, member)){
+            continue;
+        }
+        spqr_arc firstArc = getFirstMemberArc(dec, member);
+        if(SPQRarcIsInvalid(firstArc)){
+            continue;
+        }
+        SPQRMemberType type = getMemberType(dec, member);
+        spqr_arc arc = firstArc;
+        int index = 0;
+        do{
+            assert(arc < dec->numArcs);
+            spqr_node tail;
+            spqr_node head;
+            switch(type){
+                case SPQR_MEMBERTYPE_RIGID:{
+                    tail = findEffectiveArcTailNoCompression(dec, arc);
+                    head = findEffectiveArcHeadNoCompression(dec, arc);
+                    break;
+                }
+                case SPQR_MEMBERTYPE_PARALLEL:{
+                    //All arcs connect the same two nodes
+                    tail = nextNode;
+                    head = nextNode + 1;
+                    break;
+                }
+                case SPQR_MEMBERTYPE_SERIES:
+                case SPQR_MEMBERTYPE_LOOP:{
+                    //The arcs form a cycle in the order of the member arc list
+                    tail = nextNode + index;
+                    head = getNextMemberArc(dec, arc) == firstArc ? nextNode : nextNode + index + 1;
+                    break;
+                }
+                default:{
+                    assert(false);
+                    tail = SPQR_INVALID_NODE;
+                    head = SPQR_INVALID_NODE;
+                    break;
+                }
+            }
+            if(type != SPQR_MEMBERTYPE_RIGID && arcIsReversedNonRigid(dec, arc)){
+                swap_ints(&tail, &head);
+            }
+            arcTails[arc] = tail;
+            arcHeads[arc] = head;
+            ++index;
+            arc = getNextMemberArc(dec, arc);
+        }while(arc != firstArc);
+        if(type == SPQR_MEMBERTYPE_PARALLEL){
+            nextNode += 2;
+        }else if(type != SPQR_MEMBERTYPE_RIGID){
+            nextNode += index;
+        }
+    }
+    assert(nextNode <= numLocalNodes);
+
+    //The path through the child between the endpoints of its marker replaces the marker of the parent,
+    //so the tails of both markers are the same node, and so are their heads
+    for (spqr_member member = 0; member < dec->numMembers; ++member) {
+        if(!memberIsRepresentative(dec, member) || SPQRarcIsInvalid(markerToParent(dec, member))){
+            continue;
+        }
+        spqr_arc childMarker = markerToParent(dec, member);
+        spqr_arc parentMarker = markerOfParent(dec, member);
+        spqr_node tailRoot = findRealizationNode(representative, arcTails[childMarker]);
+        spqr_node otherTailRoot = findRealizationNode(representative, arcTails[parentMarker]);
+        representative[max(tailRoot, otherTailRoot)] = tailRoot < otherTailRoot ? tailRoot : otherTailRoot;
+        spqr_node headRoot = findRealizationNode(representative, arcHeads[childMarker]);
+        spqr_node otherHeadRoot = findRealizationNode(representative, arcHeads[parentMarker]);
+        representative[max(headRoot, otherHeadRoot)] = headRoot < otherHeadRoot ? headRoot : otherHeadRoot;
+    }
+
+    //Number the nodes of the graph in the order in which they first occur on the rows, and then on the columns
+    spqr_node * graphNode = NULL;
+    SPQR_CALL(SPQRallocBlockArray(dec->env, &graphNode, (size_t) max(numLocalNodes, 1)));
+    for (int i = 0; i < numLocalNodes; ++i) {
+        graphNode[i] = SPQR_INVALID_NODE;
+    }
+    *numNodes = 0;
+    for (int element = 0; element < dec->memRows + dec->memColumns; ++element) {
+        bool isRow = element < dec->memRows;
+        spqr_arc arc = isRow ? dec->rowArcs[element] : dec->columnArcs[element - dec->memRows];
+        spqr_node * tails = isRow ? rowTails : columnTails;
+        spqr_node * heads = isRow ? rowHeads : columnHeads;
+        int index = isRow ? element : element - dec->memRows;
+        if(SPQRarcIsInvalid(arc)){
+            tails[index] = SPQR_INVALID_NODE;
+            heads[index] = SPQR_INVALID_NODE;
+            continue;
+        }
+        spqr_node tail = findRealizationNode(representative, arcTails[arc]);
+        if(SPQRnodeIsInvalid(graphNode[tail])){
+            graphNode[tail] = (*numNodes)++;
+        }
+        spqr_node head = findRealizationNode(representative, arcHeads[arc]);
+        if(SPQRnodeIsInvalid(graphNode[head])){
+            graphNode[head] = (*numNodes)++;
+        }
+        tails[index] = graphNode[tail];
+        heads[index] = graphNode[head];
+    }
+
+    SPQRfreeBlockArray(dec->env, &graphNode);
+    SPQRfreeBlockArray(dec->env, &arcHeads);
+    SPQRfreeBlockArray(dec->env, &arcTails);
+    SPQRfreeBlockArray(dec->env, &representative);
+    return SPQR_OKAY;
+}
+
 typedef int path_arc_id;
 #define INVALID_PATH_ARC (-1)
 
@@ -2483,9 +3077,20 @@ static SPQR_ERROR createPathArcs(SPQRNetworkDecomposition *dec, SPQRNetworkColum
  * Saves the information of the current row and partitions it based on whether or not the given columns are
  * already part of the decomposition.
  */
+///The signs of the entries are given either as values, or (if values is NULL) as bits of negativeBits,
+///where entry i corresponds to bit firstBit + i
+static bool entryIsReversed(const double * values, const uint64_t * negativeBits, size_t firstBit, size_t i){
+    if(values){
+        return values[i] < 0.0;
+    }
+    size_t bit = firstBit + i;
+    return (negativeBits[bit / 64] >> (bit % 64)) & 1u;
+}
+
 static SPQR_ERROR
 newColUpdateColInformation(SPQRNetworkDecomposition *dec, SPQRNetworkColumnAddition *newCol, spqr_col column,
-                           const spqr_row * nonzeroRows, const double * nonzeroValues, size_t numNonzeros) {
+                           const spqr_row * nonzeroRows, const double * nonzeroValues,
+                           const uint64_t * negativeBits, size_t firstBit, size_t numNonzeros) {
     newCol->newColIndex = column;
 
     newCol->numDecompositionRowArcs = 0;
@@ -2493,7 +3098,7 @@ newColUpdateColInformation(SPQRNetworkDecomposition *dec, SPQRNetworkColumnAddit
 
     for (size_t i = 0; i < numNonzeros; ++i) {
         spqr_arc rowArc = getDecompositionRowArc(dec, nonzeroRows[i]);
-        bool reversed = nonzeroValues[i] < 0.0;
+        bool reversed = entryIsReversed(nonzeroValues, negativeBits, firstBit, i);
         if (SPQRarcIsValid(rowArc)) { //If the arc is the current decomposition: save it in the array
             if (newCol->numDecompositionRowArcs == newCol->memDecompositionRowArcs) {
                 int newNumArcs = newCol->memDecompositionRowArcs == 0 ? 8 : 2 *
@@ -3382,19 +3987,19 @@ static void determineComponentTypes(SPQRNetworkDecomposition * dec, SPQRNetworkC
     }
 }
 
-SPQR_ERROR
-SPQRNetworkColumnAdditionCheck(SPQRNetworkDecomposition *dec, SPQRNetworkColumnAddition *newCol, spqr_col column, const spqr_row * nonzeroRows,
-                               const double * nonzeroValues, size_t numNonzeros) {
+static SPQR_ERROR
+columnAdditionCheck(SPQRNetworkDecomposition *dec, SPQRNetworkColumnAddition *newCol, spqr_col column, const spqr_row * nonzeroRows,
+                    const double * nonzeroValues, const uint64_t * negativeBits, size_t firstBit, size_t numNonzeros) {
     assert(dec);
     assert(newCol);
-    assert(numNonzeros == 0 || (nonzeroRows && nonzeroValues));
+    assert(numNonzeros == 0 || (nonzeroRows && (nonzeroValues || negativeBits)));
 
     newCol->remainsNetwork = true;
     cleanupPreviousIteration(dec, newCol);
     //assert that previous iteration was cleaned up
 
     //Store call data
-    SPQR_CALL(newColUpdateColInformation(dec, newCol, column, nonzeroRows, nonzeroValues, numNonzeros));
+    SPQR_CALL(newColUpdateColInformation(dec, newCol, column, nonzeroRows, nonzeroValues, negativeBits, firstBit, numNonzeros));
 
     //compute reduced decomposition
     SPQR_CALL(constructReducedDecomposition(dec, newCol));
@@ -3414,6 +4019,19 @@ SPQRNetworkColumnAdditionCheck(SPQRNetworkDecomposition *dec, SPQRNetworkColumnA
     return SPQR_OKAY;
 }
 
+SPQR_ERROR
+SPQRNetworkColumnAdditionCheck(SPQRNetworkDecomposition *dec, SPQRNetworkColumnAddition *newCol, spqr_col column, const spqr_row * nonzeroRows,
+                               const double * nonzeroValues, size_t numNonzeros) {
+    return columnAdditionCheck(dec, newCol, column, nonzeroRows, nonzeroValues, NULL, 0, numNonzeros);
+}
+
+SPQR_ERROR
+SPQRNetworkColumnAdditionCheckSigns(SPQRNetworkDecomposition *dec, SPQRNetworkColumnAddition *newCol, spqr_col column,
+                                    const spqr_row * nonzeroRows, const uint64_t * negativeBits, size_t firstBit,
+                                    size_t numNonzeros) {
+    return columnAdditionCheck(dec, newCol, column, nonzeroRows, NULL, negativeBits, firstBit, numNonzeros);
+}
+
 ///Contains the data which tells us where to store the new column after the graph has been modified
 ///In case member is a parallel or series node, the respective new column and rows are placed in parallel (or series) with it
 ///Otherwise, the rigid member has a free spot between firstNode and secondNode
@@ -4186,6 +4804,7 @@ static SPQR_ERROR columnTransformSingleRigid(SPQRNetworkDecomposition *dec, SPQR
                                                  ,&duplicate,false));
                 }else{
                     SPQR_CALL(createChildMarker(dec,adjacentParallel,adjacentMember,arcIsTree(dec,existingArcWithPath),&duplicate,false));
+                    logMember(dec,adjacentMember);
                     dec->members[adjacentMember].parentMember = adjacentParallel;
                     dec->members[adjacentMember].markerOfParent = duplicate;
                 }
@@ -4202,14 +4821,18 @@ static SPQR_ERROR columnTransformSingleRigid(SPQRNetworkDecomposition *dec, SPQR
                 //Change the existing edge to a marker
                 if(isParent){
                     assert(markerToParent(dec,member) == existingArcWithPath);
+                    logArc(dec,markerOfParent(dec,member));
                     dec->arcs[markerOfParent(dec,member)].childMember = adjacentParallel;
+                    logMember(dec,member);
                     dec->members[member].parentMember = adjacentParallel;
                     dec->members[member].markerToParent = existingArcWithPath;
                     dec->members[member].markerOfParent = parallelMarker;
+                    logArc(dec,existingArcWithPath);
                     dec->arcs[existingArcWithPath].element =  arcIsTree(dec,existingArcWithPath) ? MARKER_ROW_ELEMENT : MARKER_COLUMN_ELEMENT;;
                     dec->arcs[existingArcWithPath].childMember = adjacentParallel;
 
                 }else{
+                    logArc(dec,existingArcWithPath);
                     dec->arcs[existingArcWithPath].element = arcIsTree(dec,existingArcWithPath) ? MARKER_ROW_ELEMENT : MARKER_COLUMN_ELEMENT;
                     dec->arcs[existingArcWithPath].childMember = adjacentParallel;
                 }
@@ -4340,6 +4963,35 @@ bool SPQRNetworkColumnAdditionRemainsNetwork(SPQRNetworkColumnAddition *newCol){
     return newCol->remainsNetwork;
 }
 
+SPQR_ERROR SPQRNetworkColumnAdditionBatch(SPQRNetworkDecomposition *dec, SPQRNetworkColumnAddition *newCol,
+                                          const spqr_col * candidates, size_t numCandidates,
+                                          const spqr_matrix_size * columnStart, const spqr_row * nonzeroRows,
+                                          const double * nonzeroValues, const uint64_t * negativeBits,
+                                          uint64_t * accepted){
+    assert(dec);
+    assert(newCol);
+    assert(numCandidates == 0 || (candidates && columnStart && accepted));
+    assert(nonzeroValues == NULL || negativeBits == NULL);
+
+    for (size_t i = 0; i < (numCandidates + 63) / 64; ++i) {
+        accepted[i] = 0;
+    }
+    //All candidates share the scratch memory of newCol, which only grows, so that no further allocations are needed
+    //once it has reached the size of the largest column
+    for (size_t i = 0; i < numCandidates; ++i) {
+        spqr_col column = candidates[i];
+        spqr_matrix_size start = columnStart[column];
+        SPQR_CALL(columnAdditionCheck(dec, newCol, column, nonzeroRows + start,
+                                      nonzeroValues ? nonzeroValues + start : NULL, negativeBits, start,
+                                      columnStart[column + 1] - start));
+        if (newCol->remainsNetwork) {
+            SPQR_CALL(SPQRNetworkColumnAdditionAdd(dec, newCol));
+            accepted[i / 64] |= UINT64_C(1) << (i % 64);
+        }
+    }
+    return SPQR_OKAY;
+}
+
 
 static int min(int a, int b){
     return a < b ? a : b;
@@ -4554,6 +5206,7 @@ static NewRowInformation emptyNewRowInformation(void){
  */
 static SPQR_ERROR newRowUpdateRowInformation(const SPQRNetworkDecomposition *dec, SPQRNetworkRowAddition *newRow,
                                              const spqr_row row, const spqr_col * columns, const double * columnValues,
+                                             const uint64_t * negativeBits, size_t firstBit,
                                              const size_t numColumns)
 {
     newRow->newRowIndex = row;
@@ -4563,7 +5216,7 @@ static SPQR_ERROR newRowUpdateRowInformation(const SPQRNetworkDecomposition *dec
 
     for (size_t i = 0; i < numColumns; ++i) {
         spqr_arc columnArc = getDecompositionColumnArc(dec, columns[i]);
-        bool reversed = columnValues[i] < 0.0;
+        bool reversed = entryIsReversed(columnValues, negativeBits, firstBit, i);
         if(SPQRarcIsValid(columnArc)){ //If the arc is the current decomposition: save it in the array
             if(newRow->numDecompositionColumnArcs == newRow->memDecompositionColumnArcs){
                 int newNumArcs = newRow->memDecompositionColumnArcs == 0 ? 8 : 2*newRow->memDecompositionColumnArcs; //TODO: make reallocation numbers more consistent with rest?
@@ -6846,6 +7499,7 @@ static SPQR_ERROR rigidTransformArcIntoCycle(SPQRNetworkDecomposition *dec,
     }else{
         //create child marker
         SPQR_CALL(createChildMarker(dec,newCycle,adjacentMember,arcIsTree(dec,arc),&duplicate,true));
+        logMember(dec,adjacentMember);
         dec->members[adjacentMember].parentMember = newCycle;
         dec->members[adjacentMember].markerOfParent = duplicate;
     }
@@ -6861,14 +7515,18 @@ static SPQR_ERROR rigidTransformArcIntoCycle(SPQRNetworkDecomposition *dec,
     //Change the existing edge to a marker
     if(isParent){
         assert(markerToParent(dec,member) == arc);
+        logArc(dec,markerOfParent(dec,member));
         dec->arcs[markerOfParent(dec,member)].childMember = newCycle;
+        logMember(dec,member);
         dec->members[member].parentMember = newCycle;
         dec->members[member].markerToParent = arc;
         dec->members[member].markerOfParent = cycleMarker;
+        logArc(dec,arc);
         dec->arcs[arc].element =  arcIsTree(dec,arc) ? MARKER_ROW_ELEMENT : MARKER_COLUMN_ELEMENT;;
         dec->arcs[arc].childMember = SPQR_INVALID_MEMBER;
 
     }else{
+        logArc(dec,arc);
         dec->arcs[arc].element = arcIsTree(dec,arc) ? MARKER_ROW_ELEMENT : MARKER_COLUMN_ELEMENT;
         dec->arcs[arc].childMember = newCycle;
     }
@@ -8739,17 +9397,17 @@ void SPQRfreeNetworkRowAddition(SPQR* env, SPQRNetworkRowAddition ** pNewRow){
     SPQRfreeBlock(env,pNewRow);
 }
 
-SPQR_ERROR SPQRNetworkRowAdditionCheck(SPQRNetworkDecomposition * dec, SPQRNetworkRowAddition * newRow,
-                                       const spqr_row row, const spqr_col * columns, const double * columnValues,
-                                       size_t numColumns){
+static SPQR_ERROR rowAdditionCheck(SPQRNetworkDecomposition * dec, SPQRNetworkRowAddition * newRow,
+                                   const spqr_row row, const spqr_col * columns, const double * columnValues,
+                                   const uint64_t * negativeBits, size_t firstBit, size_t numColumns){
     assert(dec);
     assert(newRow);
-    assert(numColumns == 0 || columns );
+    assert(numColumns == 0 || (columns && (columnValues || negativeBits)));
 
     newRow->remainsNetwork = true;
     cleanUpPreviousIteration(dec,newRow);
 
-    SPQR_CALL(newRowUpdateRowInformation(dec,newRow,row,columns,columnValues,numColumns));
+    SPQR_CALL(newRowUpdateRowInformation(dec,newRow,row,columns,columnValues,negativeBits,firstBit,numColumns));
     SPQR_CALL(constructRowReducedDecomposition(dec,newRow));
     SPQR_CALL(createReducedDecompositionCutArcs(dec,newRow));
 
@@ -8776,6 +9434,18 @@ SPQR_ERROR SPQRNetworkRowAdditionCheck(SPQRNetworkDecomposition * dec, SPQRNetwo
     return SPQR_OKAY;
 }
 
+SPQR_ERROR SPQRNetworkRowAdditionCheck(SPQRNetworkDecomposition * dec, SPQRNetworkRowAddition * newRow,
+                                       const spqr_row row, const spqr_col * columns, const double * columnValues,
+                                       size_t numColumns){
+    return rowAdditionCheck(dec,newRow,row,columns,columnValues,NULL,0,numColumns);
+}
+
+SPQR_ERROR SPQRNetworkRowAdditionCheckSigns(SPQRNetworkDecomposition * dec, SPQRNetworkRowAddition * newRow,
+                                            const spqr_row row, const spqr_col * columns,
+                                            const uint64_t * negativeBits, size_t firstBit, size_t numColumns){
+    return rowAdditionCheck(dec,newRow,row,columns,NULL,negativeBits,firstBit,numColumns);
+}
+
 SPQR_ERROR SPQRNetworkRowAdditionAdd(SPQRNetworkDecomposition *dec, SPQRNetworkRowAddition *newRow){
     assert(newRow->remainsNetwork);
     if(newRow->numReducedComponents == 0){
@@ -8851,3 +9521,30 @@ SPQR_ERROR SPQRNetworkRowAdditionAdd(SPQRNetworkDecomposition *dec, SPQRNetworkR
 bool SPQRNetworkRowAdditionRemainsNetwork(const SPQRNetworkRowAddition *newRow){
     return newRow->remainsNetwork;
 }
+
+SPQR_ERROR SPQRNetworkRowAdditionBatch(SPQRNetworkDecomposition *dec, SPQRNetworkRowAddition *newRow,
+                                       const spqr_row * candidates, size_t numCandidates,
+                                       const spqr_matrix_size * rowStart, const spqr_col * nonzeroCols,
+                                       const double * nonzeroValues, const uint64_t * negativeBits,
+                                       uint64_t * accepted){
+    assert(dec);
+    assert(newRow);
+    assert(numCandidates == 0 || (candidates && rowStart && accepted));
+    assert(nonzeroValues == NULL || negativeBits == NULL);
+
+    for (size_t i = 0; i < (numCandidates + 63) / 64; ++i) {
+        accepted[i] = 0;
+    }
+    for (size_t i = 0; i < numCandidates; ++i) {
+        spqr_row row = candidates[i];
+        spqr_matrix_size start = rowStart[row];
+        SPQR_CALL(rowAdditionCheck(dec, newRow, row, nonzeroCols + start,
+                                   nonzeroValues ? nonzeroValues + start : NULL, negativeBits, start,
+                                   rowStart[row + 1] - start));
+        if (newRow->remainsNetwork) {
+            SPQR_CALL(SPQRNetworkRowAdditionAdd(dec, newRow));
+            accepted[i / 64] |= UINT64_C(1) << (i % 64);
+        }
+    }
+    return SPQR_OKAY;
+}
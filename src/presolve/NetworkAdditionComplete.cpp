@@ -3,6 +3,7 @@
 //
 
 #include "mipworkshop2024/presolve/NetworkAdditionComplete.hpp"
+#include <bit>
 
 Submatrix NetworkAddition::createSubmatrix(index_t numRows, index_t numCols) const{
     Submatrix submatrix(numRows,numCols);
@@ -33,6 +34,62 @@ Submatrix NetworkAddition::createSubmatrix(index_t numRows, index_t numCols) con
     return submatrix;
 
 }
+NetworkRealization NetworkAddition::createRealization(index_t numRows, index_t numCols) const{
+    index_t numDecRows = transposed ? numCols : numRows;
+    index_t numDecCols = transposed ? numRows : numCols;
+    std::vector<spqr_node> decRowTails(numDecRows);
+    std::vector<spqr_node> decRowHeads(numDecRows);
+    std::vector<spqr_node> decColumnTails(numDecCols);
+    std::vector<spqr_node> decColumnHeads(numDecCols);
+    int numNodes = 0;
+    SPQR_CALL_THROW(SPQRNetworkDecompositionCreateRealization(dec,&numNodes,decRowTails.data(),decRowHeads.data(),
+                                                              decColumnTails.data(),decColumnHeads.data()));
+    auto toIndices = [](const std::vector<spqr_node>& nodes){
+        std::vector<index_t> indices(nodes.size());
+        for(std::size_t i = 0; i < nodes.size(); ++i){
+            indices[i] = SPQRnodeIsInvalid(nodes[i]) ? INVALID : static_cast<index_t>(nodes[i]);
+        }
+        return indices;
+    };
+    NetworkRealization realization;
+    realization.numNodes = numNodes;
+    realization.transposed = transposed;
+    realization.rowTails = toIndices(transposed ? decColumnTails : decRowTails);
+    realization.rowHeads = toIndices(transposed ? decColumnHeads : decRowHeads);
+    realization.columnTails = toIndices(transposed ? decRowTails : decColumnTails);
+    realization.columnHeads = toIndices(transposed ? decRowHeads : decColumnHeads);
+    return realization;
+}
+index_t NetworkAddition::tryAddCols(const SignPatternMatrix& columnMatrix, std::span<const index_t> candidates,
+                                    std::vector<std::uint64_t>& accepted) {
+    accepted.resize((candidates.size() + 63) / 64);
+    if(candidates.empty()){
+        return 0;
+    }
+#ifndef NDEBUG
+    for(index_t col : candidates){
+        assert(columnMatrix.getPrimaryVector(col).allUnit());
+    }
+#endif
+    //In the transposed decomposition, the columns of the matrix are the rows of the decomposition
+    if(transposed){
+        SPQR_CALL_THROW(SPQRNetworkRowAdditionBatch(dec,rowAddition,candidates.data(),candidates.size(),
+                                                    columnMatrix.getPrimaryStart().data(),
+                                                    columnMatrix.getSecondaryIndex().data(),
+                                                    nullptr,columnMatrix.getNegativeBits().data(),accepted.data()));
+    }else{
+        SPQR_CALL_THROW(SPQRNetworkColumnAdditionBatch(dec,colAddition,candidates.data(),candidates.size(),
+                                                       columnMatrix.getPrimaryStart().data(),
+                                                       columnMatrix.getSecondaryIndex().data(),
+                                                       nullptr,columnMatrix.getNegativeBits().data(),accepted.data()));
+    }
+    index_t numAdded = 0;
+    for(std::uint64_t word : accepted){
+        numAdded += std::popcount(word);
+    }
+    return numAdded;
+}
+
 bool NetworkAddition::containsColumn(index_t col) const {
     return transposed ? SPQRNetworkDecompositionContainsRow(dec,col) : SPQRNetworkDecompositionContainsColumn(dec,col);
 }
@@ -40,24 +97,43 @@ bool NetworkAddition::containsRow(index_t row) const {
     return transposed ? SPQRNetworkDecompositionContainsColumn(dec,row) : SPQRNetworkDecompositionContainsRow(dec,row);
 }
 
-void NetworkAddition::removeComponent(const std::vector<index_t> &rows, const std::vector<index_t> &columns) {
-    const auto& graphRows = transposed ? columns : rows;
-    const auto& graphCols = transposed ? rows : columns;
+void NetworkAddition::checkpoint() {
+    SPQRNetworkDecompositionCheckpoint(dec);
+}
+
+void NetworkAddition::commit() {
+    SPQRNetworkDecompositionCommit(dec);
+}
 
-    SPQRNetworkDecompositionRemoveComponents(dec,graphRows.data(),graphRows.size(),graphCols.data(),graphCols.size());
+void NetworkAddition::rollback() {
+    SPQR_CALL_THROW(SPQRNetworkDecompositionRollback(dec));
+}
+
+void NetworkAddition::merge(const NetworkAddition &other) {
+    assert(transposed == other.transposed);
+    SPQR_CALL_THROW(SPQRNetworkDecompositionMerge(dec,other.dec));
 }
 
 NetworkAddition::~NetworkAddition() {
     SPQRfreeNetworkColumnAddition(env,&colAddition);
     SPQRfreeNetworkRowAddition(env,&rowAddition);
     SPQRNetworkDecompositionFree(&dec);
-    SPQRfreeEnvironment(&env);
+    if(pool){
+        pool->release(env);
+    }else{
+        SPQRfreeEnvironment(&env);
+    }
 
 }
 
-NetworkAddition::NetworkAddition(index_t numRows, index_t numCols, Submatrix::Initialization init, bool transposed) :
-    transposed{transposed}{
-    SPQR_CALL_THROW(SPQRcreateEnvironment(&env));
+NetworkAddition::NetworkAddition(index_t numRows, index_t numCols, Submatrix::Initialization init, bool transposed,
+                                 SPQREnvironmentPool * pool) :
+    pool{pool}, transposed{transposed}{
+    if(pool){
+        env = pool->acquire();
+    }else{
+        SPQR_CALL_THROW(SPQRcreateEnvironment(&env));
+    }
     index_t numDecRows = transposed ? numCols : numRows;
     index_t numDecCols = transposed ? numRows : numCols;
     SPQR_CALL_THROW(SPQRNetworkDecompositionCreate(env,&dec,numDecRows,numDecCols));
@@ -66,6 +142,46 @@ NetworkAddition::NetworkAddition(index_t numRows, index_t numCols, Submatrix::In
 
 }
 
+void NetworkAddition::reserve(index_t numRows, index_t numCols) {
+    //Every row and column becomes an arc, and the estimate leaves room for as many virtual arcs. This suffices for
+    //most decompositions; in the rare worst case the arrays are still grown on demand
+    index_t numElements = numRows + numCols;
+    SPQR_CALL_THROW(SPQRNetworkDecompositionReserve(dec,(int) (2 * numElements),(int) numElements,
+                                                    (int) numElements));
+}
+
+SPQREnvironmentPool::~SPQREnvironmentPool() {
+    for(SPQR * env : environments){
+        SPQRfreeEnvironment(&env);
+    }
+}
+
+SPQR * SPQREnvironmentPool::acquire() {
+    {
+        std::lock_guard lock(mutex);
+        if(!environments.empty()){
+            SPQR * env = environments.back();
+            environments.pop_back();
+            return env;
+        }
+    }
+    SPQR * env = NULL;
+    SPQR_CALL_THROW(SPQRcreateEnvironment(&env));
+    return env;
+}
+
+void SPQREnvironmentPool::release(SPQR *env) {
+    std::lock_guard lock(mutex);
+    environments.push_back(env);
+}
+
+void SPQREnvironmentPool::releaseMemory() {
+    std::lock_guard lock(mutex);
+    for(SPQR * env : environments){
+        SPQRreleaseEnvironmentMemory(env);
+    }
+}
+
 SPQRNetworkDecompositionStatistics NetworkAddition::statistics() const {
     return SPQRNetworkDecompositionGetStatistics(dec);
 }
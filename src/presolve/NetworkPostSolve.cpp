@@ -0,0 +1,249 @@
+//
+// Created by rolf on 17-10-26.
+//
+
+#include "mipworkshop2024/presolve/NetworkPostSolve.h"
+#include "mipworkshop2024/presolve/NetworkAdditionComplete.hpp"
+#include "mipworkshop2024/presolve/NetworkSimplex.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+
+namespace {
+using IntegralSimplex = NetworkSimplex<std::int64_t>;
+using Bound = IntegralSimplex::Flow;
+constexpr Bound INFINITE_BOUND = IntegralSimplex::INFINITE_BOUND;
+
+/// Converts an integral bound to a flow bound, or returns std::nullopt if it is fractional or too large
+std::optional<Bound> convertBound(double bound){
+    if(isInfinite(bound)){
+        return INFINITE_BOUND;
+    }
+    if(isInfinite(-bound)){
+        return -INFINITE_BOUND;
+    }
+    if(!isFeasIntegral(bound) || std::abs(bound) > static_cast<double>(IntegralSimplex::MAX_BOUND)){
+        return std::nullopt;
+    }
+    return static_cast<Bound>(std::llround(bound));
+}
+
+/// Returns a realization of the columns of the matrix as a network matrix, or its transpose if transposed is true,
+/// or std::nullopt if the matrix is not network in that orientation
+std::optional<NetworkRealization> realizeNetworkMatrix(const SparseMatrix& matrix, index_t numRows, bool transposed){
+    const index_t numCols = matrix.numCols();
+    NetworkAddition addition(numRows,numCols,Submatrix::INIT_NONE,transposed);
+    for(index_t i = 0; i < numCols; ++i){
+        if(!addition.tryAddCol(i,matrix.getPrimaryVector(i))){
+            return std::nullopt;
+        }
+    }
+    return addition.createRealization(numRows,numCols);
+}
+
+struct NetworkLP{
+    std::vector<Bound> rowLower;
+    std::vector<Bound> rowUpper;
+    std::vector<Bound> colLower;
+    std::vector<Bound> colUpper;
+    std::vector<double> cost; //minimization costs of the columns
+};
+
+/// Every column is the arc from its head to its tail, so that together with the path in the forest from its tail to
+/// its head it forms a cycle. The flow on a row arc is then exactly the activity of the row, and the flow on a column
+/// arc its value.
+bool solveFlowProblem(const NetworkRealization& realization, const NetworkLP& lp, std::vector<double>& values){
+    IntegralSimplex simplex(realization.numNodes);
+    for(index_t i = 0; i < lp.rowLower.size(); ++i){
+        if(realization.rowTails[i] != INVALID){
+            simplex.addArc(realization.rowTails[i],realization.rowHeads[i],lp.rowLower[i],lp.rowUpper[i],0.0);
+        }
+    }
+    std::vector<index_t> columnArcs;
+    for(index_t i = 0; i < lp.colLower.size(); ++i){
+        columnArcs.push_back(simplex.addArc(realization.columnHeads[i],realization.columnTails[i],
+                                            lp.colLower[i],lp.colUpper[i],lp.cost[i]));
+    }
+    if(simplex.solve() != IntegralSimplex::Status::OPTIMAL){
+        return false;
+    }
+    for(index_t i = 0; i < columnArcs.size(); ++i){
+        values[i] = static_cast<double>(simplex.flow(columnArcs[i]));
+    }
+    return true;
+}
+
+/// In the transposed realization, the columns form a spanning forest, and the nonzeros of a row are the columns on the
+/// path from its tail to its head. If every column takes the value potential(head) - potential(tail) of some node
+/// potentials, the activity of every row is the potential difference over its arc. The LP is thus to find potentials
+/// with bounded differences over all arcs, which is the dual of an uncapacitated min cost flow problem: every finite
+/// bound gives an arc with the bound as its cost, and the objective gives the supplies. The optimal potentials of the
+/// flow problem are integral, as the bounds are.
+bool solvePotentialProblem(const NetworkRealization& realization, const NetworkLP& lp, std::vector<double>& values){
+    using FractionalSimplex = NetworkSimplex<double>;
+    FractionalSimplex simplex(realization.numNodes);
+    double maxCost = 0.0;
+    auto addDifferenceBounds = [&](index_t tail, index_t head, Bound lower, Bound upper){
+        if(upper != INFINITE_BOUND){
+            simplex.addArc(tail,head,0.0,FractionalSimplex::INFINITE_BOUND,static_cast<double>(upper));
+            maxCost = std::max(maxCost,std::abs(static_cast<double>(upper)));
+        }
+        if(lower != -INFINITE_BOUND){
+            simplex.addArc(head,tail,0.0,FractionalSimplex::INFINITE_BOUND,-static_cast<double>(lower));
+            maxCost = std::max(maxCost,std::abs(static_cast<double>(lower)));
+        }
+    };
+    for(index_t i = 0; i < lp.rowLower.size(); ++i){
+        if(realization.rowTails[i] != INVALID){
+            addDifferenceBounds(realization.rowTails[i],realization.rowHeads[i],lp.rowLower[i],lp.rowUpper[i]);
+        }
+    }
+    for(index_t i = 0; i < lp.colLower.size(); ++i){
+        addDifferenceBounds(realization.columnTails[i],realization.columnHeads[i],lp.colLower[i],lp.colUpper[i]);
+        simplex.addSupply(realization.columnHeads[i],lp.cost[i]);
+        simplex.addSupply(realization.columnTails[i],-lp.cost[i]);
+    }
+    //Otherwise, the potentials are not computed exactly
+    if(2.0 * (maxCost + 1.0) * (static_cast<double>(realization.numNodes) + 1.0) >= std::ldexp(1.0,53)){
+        return false;
+    }
+    if(simplex.solve() != FractionalSimplex::Status::OPTIMAL){
+        return false;
+    }
+    for(index_t i = 0; i < lp.colLower.size(); ++i){
+        values[i] = simplex.potential(realization.columnHeads[i]) - simplex.potential(realization.columnTails[i]);
+    }
+    return true;
+}
+
+bool isWithinBounds(double value, Bound lower, Bound upper){
+    return (lower == -INFINITE_BOUND || value >= static_cast<double>(lower)) &&
+           (upper == INFINITE_BOUND || value <= static_cast<double>(upper));
+}
+}
+
+bool solveNetworkTUSubmatrix(const Problem& problem,
+                             const TotallyUnimodularColumnSubmatrix& submatrix,
+                             Solution& currentSol){
+    const index_t numRows = submatrix.submatRows.size();
+    const index_t numCols = submatrix.submatColumns.size();
+    std::vector<index_t> rowMapping(problem.matrix.numRows(),INVALID);
+    for(index_t i = 0; i < numRows; ++i){
+        rowMapping[submatrix.submatRows[i]] = i;
+    }
+
+    //Copy the submatrix, and check that it or its transpose is a network matrix
+    SparseMatrix matrix;
+    matrix.setNumSecondary(numRows);
+    std::vector<std::pair<index_t,double>> entries;
+    for(index_t column : submatrix.submatColumns){
+        entries.clear();
+        for(const Nonzero& nonzero : problem.matrix.getPrimaryVector(column)){
+            index_t newRow = rowMapping[nonzero.index()];
+            if(newRow == INVALID){
+                return false;
+            }
+            entries.emplace_back(newRow,nonzero.value());
+        }
+        std::sort(entries.begin(),entries.end());
+        for(const auto& [row,value] : entries){
+            matrix.appendNonzero(row,value);
+        }
+        matrix.finishPrimaryVector();
+    }
+    std::optional<NetworkRealization> realization = realizeNetworkMatrix(matrix,numRows,false);
+    if(!realization.has_value()){
+        realization = realizeNetworkMatrix(matrix,numRows,true);
+        if(!realization.has_value()){
+            return false;
+        }
+    }
+    for(index_t i = 0; i < numCols; ++i){
+        if(realization->columnTails[i] == INVALID){
+            return false;
+        }
+    }
+
+    //Adjust the row bounds by the values of the implying columns. As the row activities are integral,
+    //fractional row bounds can be rounded.
+    std::vector<double> rowLHS;
+    std::vector<double> rowRHS;
+    for(index_t row : submatrix.submatRows){
+        rowLHS.push_back(problem.lhs[row]);
+        rowRHS.push_back(problem.rhs[row]);
+    }
+    for(index_t column : submatrix.implyingColumns){
+        double colVal = std::round(currentSol.values[column]);
+        for(const Nonzero& nonzero : problem.matrix.getPrimaryVector(column)){
+            index_t newRow = rowMapping[nonzero.index()];
+            if(newRow == INVALID) continue;
+            double total = nonzero.value() * colVal;
+            if(!isInfinite(-rowLHS[newRow])){
+                rowLHS[newRow] -= total;
+            }
+            if(!isInfinite(rowRHS[newRow])){
+                rowRHS[newRow] -= total;
+            }
+        }
+    }
+
+    NetworkLP lp;
+    for(index_t i = 0; i < numRows; ++i){
+        double lhs = isInfinite(-rowLHS[i]) ? rowLHS[i] : std::ceil(rowLHS[i] - 1e-6);
+        double rhs = isInfinite(rowRHS[i]) ? rowRHS[i] : std::floor(rowRHS[i] + 1e-6);
+        auto lower = convertBound(lhs);
+        auto upper = convertBound(rhs);
+        if(!lower.has_value() || !upper.has_value()){
+            return false;
+        }
+        if(realization->rowTails[i] == INVALID && (*lower > 0 || *upper < 0)){
+            //The row has no entries in the submatrix
+            return false;
+        }
+        lp.rowLower.push_back(*lower);
+        lp.rowUpper.push_back(*upper);
+    }
+    const double objSign = problem.sense == ObjSense::MINIMIZE ? 1.0 : -1.0;
+    for(index_t column : submatrix.submatColumns){
+        auto lower = convertBound(problem.lb[column]);
+        auto upper = convertBound(problem.ub[column]);
+        if(!lower.has_value() || !upper.has_value()){
+            return false;
+        }
+        lp.colLower.push_back(*lower);
+        lp.colUpper.push_back(*upper);
+        lp.cost.push_back(objSign * problem.obj[column]);
+    }
+
+    std::vector<double> values(numCols);
+    if(!realization->transposed){
+        if(!solveFlowProblem(*realization,lp,values)){
+            return false;
+        }
+    }else{
+        if(!solvePotentialProblem(*realization,lp,values)){
+            return false;
+        }
+        //The potentials are floating point numbers, so check that the solution is integral and feasible
+        std::vector<double> activities(numRows,0.0);
+        for(index_t i = 0; i < numCols; ++i){
+            if(!isFeasIntegral(values[i]) || !isWithinBounds(values[i],lp.colLower[i],lp.colUpper[i])){
+                return false;
+            }
+            values[i] = std::round(values[i]);
+            for(const Nonzero& nonzero : matrix.getPrimaryVector(i)){
+                activities[nonzero.index()] += nonzero.value() * values[i];
+            }
+        }
+        for(index_t i = 0; i < numRows; ++i){
+            if(!isWithinBounds(activities[i],lp.rowLower[i],lp.rowUpper[i])){
+                return false;
+            }
+        }
+    }
+    for(index_t i = 0; i < numCols; ++i){
+        currentSol.values[submatrix.submatColumns[i]] = values[i];
+    }
+    return true;
+}
@@ -0,0 +1,497 @@
+//
+// Created by rolf on 17-10-26.
+//
+// The spanning tree method of this class (the thread-based tree representation, the block search pivot rule and the
+// tree and potential updates) is adapted from the NetworkSimplex class of LEMON, a generic C++ optimization library
+// (https://lemon.cs.elte.hu), which is distributed under the following notice:
+//
+//  Copyright (C) 2003-2013
+//  Egervary Jeno Kombinatorikus Optimalizalasi Kutatocsoport
+//  (Egervary Research Group on Combinatorial Optimization, EGRES).
+//
+//  Permission to use, modify and distribute this software is granted
+//  provided that this copyright notice appears in all copies. For
+//  precise terms see the accompanying LICENSE file.
+//
+//  This software is provided "AS IS" with no warranty of any kind,
+//  express or implied, and with no claim as to its suitability for any
+//  purpose.
+//
+// The LICENSE file of LEMON is the Boost Software License, Version 1.0:
+//
+//  Boost Software License - Version 1.0 - August 17th, 2003
+//
+//  Permission is hereby granted, free of charge, to any person or organization
+//  obtaining a copy of the software and accompanying documentation covered by
+//  this license (the "Software") to use, reproduce, display, distribute,
+//  execute, and transmit the Software, and to prepare derivative works of the
+//  Software, and to permit third-parties to whom the Software is furnished to
+//  do so, all subject to the following:
+//
+//  The copyright notices in the Software and this entire statement, including
+//  the above license grant, this restriction and the following disclaimer,
+//  must be included in all copies of the Software, in whole or in part, and
+//  all derivative works of the Software, unless such copies or derivative
+//  works are solely in the form of machine-executable object code generated by
+//  a source language processor.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+//  SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+//  FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#include "mipworkshop2024/presolve/NetworkSimplex.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <type_traits>
+
+template<typename Value>
+NetworkSimplex<Value>::NetworkSimplex(index_t numNodes) : numNodes{numNodes}, inputSupply(numNodes,0){
+
+}
+
+template<typename Value>
+index_t NetworkSimplex<Value>::addArc(index_t tail, index_t head, Flow lower, Flow upper, double arcCost) {
+    assert(tail < numNodes && head < numNodes);
+    assert(!std::is_integral_v<Flow> || lower == -INFINITE_BOUND || std::abs(lower) <= MAX_BOUND);
+    assert(!std::is_integral_v<Flow> || upper == INFINITE_BOUND || std::abs(upper) <= MAX_BOUND);
+    inputArcs.push_back(InputArc{tail,head,lower,upper,arcCost});
+    return inputArcs.size() - 1;
+}
+
+template<typename Value>
+void NetworkSimplex<Value>::addSupply(index_t node, Flow amount) {
+    assert(node < numNodes);
+    inputSupply[node] += amount;
+    assert(!std::is_integral_v<Flow> || std::abs(inputSupply[node]) <= MAX_BOUND);
+}
+
+template<typename Value>
+auto NetworkSimplex<Value>::flow(index_t arc) const -> Flow {
+    assert(arc < inputFlows.size());
+    return inputFlows[arc];
+}
+
+template<typename Value>
+double NetworkSimplex<Value>::totalCost() const {
+    double total = 0.0;
+    for(index_t i = 0; i < inputFlows.size(); ++i){
+        total += static_cast<double>(inputFlows[i]) * inputArcs[i].cost;
+    }
+    return total;
+}
+
+template<typename Value>
+double NetworkSimplex<Value>::potential(index_t node) const {
+    assert(node < numNodes && node < potentials.size());
+    return potentials[node];
+}
+
+template<typename Value>
+void NetworkSimplex<Value>::addInternalArc(index_t tail, index_t head, Flow lower, Flow upper, double arcCost) {
+    assert(lower <= upper);
+    source.push_back(tail);
+    target.push_back(head);
+    lowerBound.push_back(lower);
+    capacity.push_back(upper - lower);
+    cost.push_back(arcCost);
+    supply[tail] -= lower;
+    supply[head] += lower;
+}
+
+template<typename Value>
+auto NetworkSimplex<Value>::solve() -> Status {
+    inputFlows.assign(inputArcs.size(),0);
+    potentials.assign(numNodes,0.0);
+    if(numNodes == 0){
+        return Status::OPTIMAL;
+    }
+    source.clear();
+    target.clear();
+    lowerBound.clear();
+    capacity.clear();
+    cost.clear();
+    supply = inputSupply;
+
+    //An optimal basic solution has flows of at most the sum of all finite bounds and supplies, so this is used as the
+    //bound of the infinite ones. If the flow on such an arc reaches it, the problem is unbounded.
+    double boundSum = 0.0;
+    for(Flow nodeSupply : inputSupply){
+        boundSum += std::abs(static_cast<double>(nodeSupply));
+    }
+    double numInfinite = 0.0;
+    double maxCost = 0.0;
+    for(const InputArc& arc : inputArcs){
+        if(arc.lower == -INFINITE_BOUND){
+            numInfinite += 1.0;
+        }else{
+            boundSum += std::abs(static_cast<double>(arc.lower));
+        }
+        if(arc.upper == INFINITE_BOUND){
+            numInfinite += 1.0;
+        }else{
+            boundSum += std::abs(static_cast<double>(arc.upper));
+        }
+        maxCost = std::max(maxCost,std::abs(arc.cost));
+    }
+    if(std::is_integral_v<Flow> && (numInfinite + 2.0) * (boundSum + 1.0) > std::ldexp(1.0,62)){
+        return Status::TOO_LARGE;
+    }
+    const Flow infiniteBound = static_cast<Flow>(boundSum) + 1;
+    flowTolerance = std::is_integral_v<Flow> ? Flow(0) : static_cast<Flow>(1e-9 * (boundSum + 1.0));
+
+    //Arcs with an infinite lower bound are reversed, and free arcs are split into a forward and a backward arc,
+    //so that all internal arcs have a finite lower bound
+    std::vector<index_t> firstInternalArc(inputArcs.size());
+    for(index_t i = 0; i < inputArcs.size(); ++i){
+        const InputArc& arc = inputArcs[i];
+        firstInternalArc[i] = source.size();
+        if(arc.lower == -INFINITE_BOUND && arc.upper == INFINITE_BOUND){
+            addInternalArc(arc.tail,arc.head,0,infiniteBound,arc.cost);
+            addInternalArc(arc.head,arc.tail,0,infiniteBound,-arc.cost);
+        }else if(arc.lower == -INFINITE_BOUND){
+            addInternalArc(arc.head,arc.tail,-arc.upper,infiniteBound,-arc.cost);
+        }else if(arc.lower > arc.upper){
+            return Status::INFEASIBLE;
+        }else{
+            addInternalArc(arc.tail,arc.head,arc.lower,arc.upper == INFINITE_BOUND ? infiniteBound : arc.upper,
+                           arc.cost);
+        }
+    }
+    numArcs = source.size();
+    tolerance = 1e-9 * std::max(1.0,maxCost);
+    initializeTree();
+
+    index_t blockSize = std::max<index_t>(10,static_cast<index_t>(std::sqrt(static_cast<double>(numArcs))));
+    nextSearchArc = 0;
+    while(findEnteringArc(blockSize)){
+        findJoinNode();
+        bool change = findLeavingArc();
+        if(delta == INFINITE_BOUND){
+            return Status::UNBOUNDED;
+        }
+        changeFlow(change);
+        if(change){
+            updateTreeStructure();
+            updatePotential();
+        }
+    }
+    for(index_t e = numArcs; e < numArcs + numNodes; ++e){
+        if(std::abs(flows[e]) > flowTolerance){
+            return Status::INFEASIBLE;
+        }
+    }
+
+    for(index_t i = 0; i < inputArcs.size(); ++i){
+        const InputArc& arc = inputArcs[i];
+        index_t e = firstInternalArc[i];
+        bool atInfiniteBound = false;
+        auto internalFlow = [&](index_t internal){
+            Flow value = lowerBound[internal] + flows[internal];
+            atInfiniteBound = atInfiniteBound || value >= infiniteBound - flowTolerance;
+            return value;
+        };
+        if(arc.lower == -INFINITE_BOUND && arc.upper == INFINITE_BOUND){
+            inputFlows[i] = internalFlow(e) - internalFlow(e + 1);
+        }else if(arc.lower == -INFINITE_BOUND){
+            inputFlows[i] = -internalFlow(e);
+        }else{
+            inputFlows[i] = internalFlow(e);
+            atInfiniteBound = atInfiniteBound && arc.upper == INFINITE_BOUND;
+        }
+        if(atInfiniteBound){
+            return Status::UNBOUNDED;
+        }
+    }
+    return Status::OPTIMAL;
+}
+
+template<typename Value>
+void NetworkSimplex<Value>::initializeTree() {
+    //Every node starts out connected to the root by an artificial arc, which carries its supply.
+    //The costs of the artificial arcs are large enough that they are only used if there is no feasible circulation.
+    const index_t numAllArcs = numArcs + numNodes;
+    root = numNodes;
+    source.resize(numAllArcs);
+    target.resize(numAllArcs);
+    capacity.resize(numAllArcs);
+    cost.resize(numAllArcs);
+    flows.assign(numAllArcs,0);
+    state.assign(numAllArcs,STATE_LOWER);
+
+    potentials.assign(numNodes + 1,0.0);
+    parent.assign(numNodes + 1,INVALID);
+    pred.assign(numNodes + 1,INVALID);
+    predDir.assign(numNodes + 1,DIR_UP);
+    thread.assign(numNodes + 1,INVALID);
+    revThread.assign(numNodes + 1,INVALID);
+    succNum.assign(numNodes + 1,0);
+    lastSucc.assign(numNodes + 1,INVALID);
+
+    double artificialCost = 0.0;
+    for(index_t e = 0; e < numArcs; ++e){
+        artificialCost = std::max(artificialCost,std::abs(cost[e]));
+    }
+    artificialCost = (artificialCost + 1.0) * static_cast<double>(numNodes + 1);
+
+    thread[root] = 0;
+    revThread[0] = root;
+    succNum[root] = numNodes + 1;
+    lastSucc[root] = root - 1;
+    for(index_t u = 0; u < numNodes; ++u){
+        index_t e = numArcs + u;
+        parent[u] = root;
+        pred[u] = e;
+        thread[u] = u + 1;
+        revThread[u + 1] = u;
+        succNum[u] = 1;
+        lastSucc[u] = u;
+        capacity[e] = INFINITE_BOUND;
+        state[e] = STATE_TREE;
+        if(supply[u] >= 0){
+            predDir[u] = DIR_UP;
+            potentials[u] = 0.0;
+            source[e] = u;
+            target[e] = root;
+            flows[e] = supply[u];
+            cost[e] = 0.0;
+        }else{
+            predDir[u] = DIR_DOWN;
+            potentials[u] = artificialCost;
+            source[e] = root;
+            target[e] = u;
+            flows[e] = -supply[u];
+            cost[e] = artificialCost;
+        }
+    }
+}
+
+template<typename Value>
+bool NetworkSimplex<Value>::findEnteringArc(index_t blockSize) {
+    //Block search: scan the arcs in blocks, starting where the previous search ended,
+    //and pick the arc with the most negative reduced cost of the first block that contains one
+    double minimum = -tolerance;
+    bool found = false;
+    index_t count = blockSize;
+    for(index_t i = 0; i < numArcs; ++i){
+        index_t e = nextSearchArc + i < numArcs ? nextSearchArc + i : nextSearchArc + i - numArcs;
+        double reducedCost = static_cast<double>(state[e]) * (cost[e] + potentials[source[e]] - potentials[target[e]]);
+        if(reducedCost < minimum){
+            minimum = reducedCost;
+            inArc = e;
+            found = true;
+        }
+        if(--count == 0){
+            if(found){
+                break;
+            }
+            count = blockSize;
+        }
+    }
+    if(found){
+        nextSearchArc = inArc;
+    }
+    return found;
+}
+
+template<typename Value>
+void NetworkSimplex<Value>::findJoinNode() {
+    index_t u = source[inArc];
+    index_t v = target[inArc];
+    while(u != v){
+        if(succNum[u] < succNum[v]){
+            u = parent[u];
+        }else{
+            v = parent[v];
+        }
+    }
+    joinNode = u;
+}
+
+template<typename Value>
+bool NetworkSimplex<Value>::findLeavingArc() {
+    //The flow is pushed along the cycle in the direction of the entering arc
+    index_t first = state[inArc] == STATE_LOWER ? source[inArc] : target[inArc];
+    index_t second = state[inArc] == STATE_LOWER ? target[inArc] : source[inArc];
+    delta = capacity[inArc];
+    int result = 0;
+
+    for(index_t u = first; u != joinNode; u = parent[u]){
+        index_t e = pred[u];
+        Flow d = flows[e];
+        if(predDir[u] == DIR_DOWN){
+            d = capacity[e] == INFINITE_BOUND ? INFINITE_BOUND : capacity[e] - d;
+        }
+        if(d < delta){
+            delta = d;
+            uOut = u;
+            result = 1;
+        }
+    }
+    //Using <= here keeps the spanning tree strongly feasible, which prevents cycling
+    for(index_t u = second; u != joinNode; u = parent[u]){
+        index_t e = pred[u];
+        Flow d = flows[e];
+        if(predDir[u] == DIR_UP){
+            d = capacity[e] == INFINITE_BOUND ? INFINITE_BOUND : capacity[e] - d;
+        }
+        if(d <= delta){
+            delta = d;
+            uOut = u;
+            result = 2;
+        }
+    }
+
+    if(result == 1){
+        uIn = first;
+        vIn = second;
+    }else{
+        uIn = second;
+        vIn = first;
+    }
+    return result != 0;
+}
+
+template<typename Value>
+void NetworkSimplex<Value>::changeFlow(bool change) {
+    if(delta > 0){
+        Flow value = static_cast<Flow>(state[inArc]) * delta;
+        flows[inArc] += value;
+        for(index_t u = source[inArc]; u != joinNode; u = parent[u]){
+            flows[pred[u]] -= static_cast<Flow>(predDir[u]) * value;
+        }
+        for(index_t u = target[inArc]; u != joinNode; u = parent[u]){
+            flows[pred[u]] += static_cast<Flow>(predDir[u]) * value;
+        }
+    }
+    if(change){
+        state[inArc] = STATE_TREE;
+        state[pred[uOut]] = flows[pred[uOut]] == 0 ? STATE_LOWER : STATE_UPPER;
+    }else{
+        state[inArc] = static_cast<ArcState>(-state[inArc]);
+    }
+}
+
+template<typename Value>
+void NetworkSimplex<Value>::updateTreeStructure() {
+    //The tree is stored by the parent of every node and a preorder thread through all nodes,
+    //with the size and the last node of the subtree of every node. The subtree hanging from uOut is reattached to vIn
+    //by the entering arc, which reverses the path from uIn to uOut.
+    const index_t oldRevThread = revThread[uOut];
+    const index_t oldSuccNum = succNum[uOut];
+    const index_t oldLastSucc = lastSucc[uOut];
+    const index_t vOut = parent[uOut];
+
+    if(uIn == uOut){
+        parent[uIn] = vIn;
+        pred[uIn] = inArc;
+        predDir[uIn] = uIn == source[inArc] ? DIR_UP : DIR_DOWN;
+
+        if(thread[vIn] != uOut){
+            index_t after = thread[oldLastSucc];
+            thread[oldRevThread] = after;
+            revThread[after] = oldRevThread;
+            after = thread[vIn];
+            thread[vIn] = uOut;
+            revThread[uOut] = vIn;
+            thread[oldLastSucc] = after;
+            revThread[after] = oldLastSucc;
+        }
+    }else{
+        //If oldRevThread equals vIn, then joinNode and vOut coincide
+        index_t threadContinue = oldRevThread == vIn ? thread[oldLastSucc] : thread[vIn];
+
+        //Update the thread and the parents along the stem, which are the nodes from uIn to uOut
+        index_t stem = uIn;
+        index_t parentStem = vIn;
+        index_t last = lastSucc[uIn];
+        index_t after = thread[last];
+        thread[vIn] = uIn;
+        dirtyRevs.clear();
+        dirtyRevs.push_back(vIn);
+        while(stem != uOut){
+            index_t nextStem = parent[stem];
+            thread[last] = nextStem;
+            dirtyRevs.push_back(last);
+
+            index_t before = revThread[stem];
+            thread[before] = after;
+            revThread[after] = before;
+
+            parent[stem] = parentStem;
+            parentStem = stem;
+            stem = nextStem;
+
+            last = lastSucc[stem] == lastSucc[parentStem] ? revThread[parentStem] : lastSucc[stem];
+            after = thread[last];
+        }
+        parent[uOut] = parentStem;
+        thread[last] = threadContinue;
+        revThread[threadContinue] = last;
+        lastSucc[uOut] = last;
+
+        if(oldRevThread != vIn){
+            thread[oldRevThread] = after;
+            revThread[after] = oldRevThread;
+        }
+        for(index_t u : dirtyRevs){
+            revThread[thread[u]] = u;
+        }
+
+        //Reverse the predecessor arcs along the stem, and recompute the subtree sizes
+        index_t stemSuccNum = 0;
+        index_t stemLastSucc = lastSucc[uOut];
+        for(index_t u = uOut, p = parent[u]; u != uIn; u = p, p = parent[u]){
+            pred[u] = pred[p];
+            predDir[u] = static_cast<Direction>(-predDir[p]);
+            stemSuccNum += succNum[u] - succNum[p];
+            succNum[u] = stemSuccNum;
+            lastSucc[p] = stemLastSucc;
+        }
+        pred[uIn] = inArc;
+        predDir[uIn] = uIn == source[inArc] ? DIR_UP : DIR_DOWN;
+        succNum[uIn] = oldSuccNum;
+    }
+
+    //Update the last successors from vIn and from vOut towards the root
+    index_t upLimitOut = lastSucc[joinNode] == vIn ? joinNode : INVALID;
+    index_t lastSuccOut = lastSucc[uOut];
+    for(index_t u = vIn; u != INVALID && lastSucc[u] == vIn; u = parent[u]){
+        lastSucc[u] = lastSuccOut;
+    }
+    if(joinNode != oldRevThread && vIn != oldRevThread){
+        for(index_t u = vOut; u != upLimitOut && lastSucc[u] == oldLastSucc; u = parent[u]){
+            lastSucc[u] = oldRevThread;
+        }
+    }else if(lastSuccOut != oldLastSucc){
+        for(index_t u = vOut; u != upLimitOut && lastSucc[u] == oldLastSucc; u = parent[u]){
+            lastSucc[u] = lastSuccOut;
+        }
+    }
+
+    //Update the subtree sizes from vIn and from vOut to the join node
+    for(index_t u = vIn; u != joinNode; u = parent[u]){
+        succNum[u] += oldSuccNum;
+    }
+    for(index_t u = vOut; u != joinNode; u = parent[u]){
+        succNum[u] -= oldSuccNum;
+    }
+}
+
+template<typename Value>
+void NetworkSimplex<Value>::updatePotential() {
+    //Shift the potentials of the subtree of uIn so that the entering arc gets reduced cost zero
+    double sigma = potentials[vIn] - potentials[uIn] - static_cast<double>(predDir[uIn]) * cost[inArc];
+    index_t end = thread[lastSucc[uIn]];
+    for(index_t u = uIn; u != end; u = thread[u]){
+        potentials[u] += sigma;
+    }
+}
+
+template class NetworkSimplex<std::int64_t>;
+template class NetworkSimplex<double>;
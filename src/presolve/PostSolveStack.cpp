@@ -3,6 +3,11 @@
 //
 
 #include "mipworkshop2024/presolve/PostSolveStack.h"
+#include <zlib.h>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <string>
 void PostSolveStack::totallyUnimodularColumnSubmatrix(const TotallyUnimodularColumnSubmatrix& submatrix)
 {
 	reductions.emplace_back(submatrix);
@@ -62,4 +67,145 @@ PostSolveStack postSolveFromJson(const nlohmann::json& json){
     stack.containsTUSubmatrix = json["containsTUSubmatrix"];
 
     return stack;
-}
\ No newline at end of file
+}
+
+namespace {
+constexpr std::uint32_t POSTSOLVE_CONTAINS_TU_SUBMATRIX = 1;
+constexpr std::size_t POSTSOLVE_HEADER_SIZE = 40;
+constexpr std::size_t POSTSOLVE_READ_CHUNK_SIZE = std::size_t(1) << 20;
+
+void putLittleEndian(std::string& out, std::uint64_t value, std::size_t numBytes){
+    for(std::size_t i = 0; i < numBytes; ++i){
+        out.push_back(static_cast<char>((value >> (8*i)) & 0xff));
+    }
+}
+std::uint64_t getLittleEndian(const char * data, std::size_t numBytes){
+    std::uint64_t value = 0;
+    for(std::size_t i = numBytes; i > 0; --i){
+        value = (value << 8) | static_cast<unsigned char>(data[i-1]);
+    }
+    return value;
+}
+
+void putVarint(std::string& out, std::uint64_t value){
+    while(value >= 0x80){
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+/// Decodes varints from the payload; any read past the end or overlong encoding marks the decoder as failed
+struct VarintDecoder{
+    std::string_view data;
+    bool failed = false;
+
+    std::uint64_t next(){
+        std::uint64_t value = 0;
+        for(unsigned shift = 0; shift < 64; shift += 7){
+            if(data.empty()){
+                failed = true;
+                return 0;
+            }
+            auto byte = static_cast<unsigned char>(data.front());
+            data.remove_prefix(1);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if(!(byte & 0x80)){
+                return value;
+            }
+        }
+        failed = true;
+        return 0;
+    }
+};
+
+void putIndexList(std::string& out, const std::vector<index_t>& list){
+    putVarint(out,list.size());
+    std::uint64_t previous = 0;
+    for(index_t index : list){
+        //zigzag encoding of the signed difference, so that unsorted lists are stored correctly as well
+        auto delta = static_cast<std::int64_t>(static_cast<std::uint64_t>(index) - previous);
+        putVarint(out,(static_cast<std::uint64_t>(delta) << 1) ^ static_cast<std::uint64_t>(delta >> 63));
+        previous = index;
+    }
+}
+
+bool getIndexList(VarintDecoder& decoder, std::vector<index_t>& list){
+    std::uint64_t size = decoder.next();
+    //Every index takes at least one byte, which bounds the size of a valid list
+    if(decoder.failed || size > decoder.data.size()){
+        return false;
+    }
+    list.resize(size);
+    std::uint64_t previous = 0;
+    for(auto& index : list){
+        std::uint64_t zigzag = decoder.next();
+        std::uint64_t delta = (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+        previous += delta;
+        index = static_cast<index_t>(previous);
+    }
+    return !decoder.failed;
+}
+}
+
+bool postSolveToBinary(const PostSolveStack& stack, std::ostream& stream){
+    std::string payload;
+    for(const auto& reduction : stack.reductions){
+        putIndexList(payload,reduction.submatRows);
+        putIndexList(payload,reduction.implyingColumns);
+        putIndexList(payload,reduction.submatColumns);
+    }
+    std::string header(POSTSOLVE_BINARY_MAGIC.begin(),POSTSOLVE_BINARY_MAGIC.end());
+    putLittleEndian(header,POSTSOLVE_BINARY_VERSION,4);
+    putLittleEndian(header,stack.containsTUSubmatrix ? POSTSOLVE_CONTAINS_TU_SUBMATRIX : 0,4);
+    putLittleEndian(header,stack.reductions.size(),8);
+    putLittleEndian(header,payload.size(),8);
+    putLittleEndian(header,crc32_z(0,reinterpret_cast<const Bytef*>(payload.data()),payload.size()),4);
+    putLittleEndian(header,0,4);
+    stream.write(header.data(),static_cast<std::streamsize>(header.size()));
+    stream.write(payload.data(),static_cast<std::streamsize>(payload.size()));
+    return stream.good();
+}
+
+std::optional<PostSolveStack> postSolveFromBinary(std::istream& stream){
+    std::array<char,POSTSOLVE_HEADER_SIZE> header{};
+    if(!stream.read(header.data(),header.size()) ||
+       !std::equal(POSTSOLVE_BINARY_MAGIC.begin(),POSTSOLVE_BINARY_MAGIC.end(),header.begin()) ||
+       getLittleEndian(header.data() + 8,4) != POSTSOLVE_BINARY_VERSION){
+        return std::nullopt;
+    }
+    std::uint64_t flags = getLittleEndian(header.data() + 12,4);
+    std::uint64_t numReductions = getLittleEndian(header.data() + 16,8);
+    std::uint64_t payloadSize = getLittleEndian(header.data() + 24,8);
+    std::uint64_t checksum = getLittleEndian(header.data() + 32,4);
+
+    //Read in chunks, so that a corrupted size can not cause a huge allocation
+    std::string payload;
+    while(payload.size() < payloadSize){
+        std::size_t offset = payload.size();
+        payload.resize(offset + std::min<std::uint64_t>(payloadSize - offset,POSTSOLVE_READ_CHUNK_SIZE));
+        if(!stream.read(payload.data() + offset,static_cast<std::streamsize>(payload.size() - offset))){
+            return std::nullopt;
+        }
+    }
+    if(crc32_z(0,reinterpret_cast<const Bytef*>(payload.data()),payload.size()) != checksum ||
+       numReductions > payload.size()){
+        return std::nullopt;
+    }
+
+    PostSolveStack stack;
+    stack.containsTUSubmatrix = (flags & POSTSOLVE_CONTAINS_TU_SUBMATRIX) != 0;
+    stack.reductions.resize(numReductions);
+    VarintDecoder decoder{payload};
+    for(auto& reduction : stack.reductions){
+        if(!getIndexList(decoder,reduction.submatRows) ||
+           !getIndexList(decoder,reduction.implyingColumns) ||
+           !getIndexList(decoder,reduction.submatColumns)){
+            return std::nullopt;
+        }
+    }
+    if(!decoder.data.empty()){
+        return std::nullopt;
+    }
+    return stack;
+}
@@ -1,4 +1,6 @@
 #include "mipworkshop2024/presolve/SPQRShared.h"
+#include <stddef.h>
+#include <string.h>
 
 #ifndef NDEBUG
 //Only necessary for overflow check assertions
@@ -12,6 +14,7 @@ SPQR_ERROR SPQRcreateEnvironment(SPQR** pSpqr){
         return SPQR_ERROR_MEMORY;
     }
     env->output = stdout;
+    env->numCachedBlocks = 0;
     return SPQR_OKAY;
 }
 SPQR_ERROR SPQRfreeEnvironment(SPQR** pSpqr){
@@ -22,38 +25,102 @@ SPQR_ERROR SPQRfreeEnvironment(SPQR** pSpqr){
     if(!env){
         return SPQR_ERROR_MEMORY;
     }
+    SPQRreleaseEnvironmentMemory(env);
 
     free(*pSpqr);
     *pSpqr = NULL;
     return SPQR_OKAY;
 }
 
+///Every block array is preceded by a header which stores its capacity in bytes
+typedef union {
+    size_t capacity;
+    max_align_t alignment;
+} SPQRBlockHeader;
 
-//TODO: implement other malloc-type functions such as reallocarray and calloc throughout the codebase?
+static SPQRBlockHeader * blockHeader(void * array){
+    return ((SPQRBlockHeader *) array) - 1;
+}
+
+void SPQRreleaseEnvironmentMemory(SPQR * env){
+    assert(env);
+    for (int i = 0; i < env->numCachedBlocks; ++i) {
+        free(env->cachedBlocks[i]);
+    }
+    env->numCachedBlocks = 0;
+}
+
+///Returns a block array of at least the given number of bytes, preferably the smallest cached one which fits
+static void * acquireBlock(SPQR * env, size_t bytes){
+    int best = -1;
+    for (int i = 0; i < env->numCachedBlocks; ++i) {
+        size_t capacity = ((SPQRBlockHeader *) env->cachedBlocks[i])->capacity;
+        if(capacity >= bytes && (best < 0 || capacity < ((SPQRBlockHeader *) env->cachedBlocks[best])->capacity)){
+            best = i;
+        }
+    }
+    SPQRBlockHeader * header;
+    if(best >= 0){
+        header = env->cachedBlocks[best];
+        env->cachedBlocks[best] = env->cachedBlocks[--env->numCachedBlocks];
+    }else{
+        header = malloc(sizeof(SPQRBlockHeader) + bytes);
+        if(!header){
+            return NULL;
+        }
+        header->capacity = bytes;
+    }
+    return header + 1;
+}
+
+static void releaseBlock(SPQR * env, void * array){
+    SPQRBlockHeader * header = blockHeader(array);
+    if(env->numCachedBlocks < SPQR_MAX_CACHED_BLOCKS){
+        env->cachedBlocks[env->numCachedBlocks++] = header;
+    }else{
+        free(header);
+    }
+}
 
-SPQR_ERROR implSPQRallocBlockArray(__attribute__((unused)) SPQR * env, void** ptr, size_t size, size_t length){
+SPQR_ERROR implSPQRallocBlockArray(SPQR * env, void** ptr, size_t size, size_t length){
     assert(env);
     assert(ptr);
     //assert(*ptr == NULL); //TODO: why is this check here, is it necessary?
     assert(!(size > 0 && length > UINT_MAX / size)); //overflow check
 
-    *ptr = malloc(size * length); //TODO check for overflows, possibly use realloc here?
+    *ptr = acquireBlock(env, size * length);
 
     return *ptr ? SPQR_OKAY : SPQR_ERROR_MEMORY;
 }
-SPQR_ERROR implSPQRreallocBlockArray(__attribute__((unused)) SPQR* env, void** ptr, size_t size, size_t length)
+SPQR_ERROR implSPQRreallocBlockArray(SPQR* env, void** ptr, size_t size, size_t length)
 {
     assert(env);
     assert(ptr);
     assert(!(size > 0 && length > UINT_MAX / size)); //overflow check
-    *ptr = realloc(*ptr, size * length);
-    //*ptr = reallocarray(*ptr,length,size); //reallocarray can also work and is a bit safer, but is non-standard...
-    return *ptr ? SPQR_OKAY : SPQR_ERROR_MEMORY;
+    size_t bytes = size * length;
+    if(!*ptr){
+        *ptr = acquireBlock(env, bytes);
+        return *ptr ? SPQR_OKAY : SPQR_ERROR_MEMORY;
+    }
+    size_t capacity = blockHeader(*ptr)->capacity;
+    if(bytes <= capacity){
+        return SPQR_OKAY;
+    }
+    void * newArray = acquireBlock(env, bytes);
+    if(!newArray){
+        return SPQR_ERROR_MEMORY;
+    }
+    memcpy(newArray, *ptr, capacity);
+    releaseBlock(env, *ptr);
+    *ptr = newArray;
+    return SPQR_OKAY;
 }
-void implSPQRfreeBlockArray(__attribute__((unused)) SPQR* env, void ** ptr){
+void implSPQRfreeBlockArray(SPQR* env, void ** ptr){
     assert(env);
     assert(ptr);
-    free(*ptr);
+    if(*ptr){
+        releaseBlock(env, *ptr);
+    }
     *ptr = NULL;
 }
 
@@ -3,26 +3,68 @@
 //
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
 #include "mipworkshop2024/presolve/TUColumnSubmatrix.h"
+#include "mipworkshop2024/ConcurrentUnionFind.h"
+#include "mipworkshop2024/Parallel.h"
 #include "mipworkshop2024/presolve/IncidenceAddition.h"
 #include "mipworkshop2024/presolve/NetworkAdditionComplete.hpp"
 
+namespace {
+/// Cooperative time budget for the detection loops. Reading the clock is expensive compared to most additions,
+/// so it is only read once every CHECK_INTERVAL additions. Once the deadline has passed, the budget stays exhausted.
+class DetectionBudget{
+public:
+	explicit DetectionBudget(std::chrono::steady_clock::time_point deadline) : deadline{deadline}{}
+
+	/// Registers a single addition, and returns false if there is no time left for it
+	bool spend(){
+		if(!exhausted && numAdditions++ % CHECK_INTERVAL == 0 && std::chrono::steady_clock::now() >= deadline){
+			exhausted = true;
+		}
+		return !exhausted;
+	}
+	/// Registers a batch of additions, and returns false if there is no time left for it.
+	/// The deadline is checked for every batch, so batches should not be much smaller than CHECK_INTERVAL.
+	bool spend(index_t batchSize){
+		numAdditions += batchSize;
+		if(!exhausted && std::chrono::steady_clock::now() >= deadline){
+			exhausted = true;
+		}
+		return !exhausted;
+	}
+	[[nodiscard]] bool isExhausted() const{
+		return exhausted;
+	}
+private:
+	static constexpr index_t CHECK_INTERVAL = 64;
+	std::chrono::steady_clock::time_point deadline;
+	index_t numAdditions = 0;
+	bool exhausted = false;
+};
+}
+
 struct TUColumnSubmatrixFinder;
 TUColumnSubmatrixFinder::TUColumnSubmatrixFinder(Problem& problem, const TUSettings& settings)
 :problem{problem},
-rowMatrix{problem.matrix.transposedFormat()},
+columnMatrix{problem.matrix},
+rowMatrix{*problem.rowMatrix(settings.numThreads)},
 settings{settings}
 {
 
 }
-MatrixSlice<CompressedSlice> TUColumnSubmatrixFinder::getRowVector(index_t index) const
+MatrixSlice<SignSlice> TUColumnSubmatrixFinder::getRowVector(index_t index) const
 {
 	return rowMatrix.getPrimaryVector(index);
 }
-MatrixSlice<CompressedSlice> TUColumnSubmatrixFinder::getColumnVector(index_t index) const
+MatrixSlice<SignSlice> TUColumnSubmatrixFinder::getColumnVector(index_t index) const
 {
-	return problem.matrix.getPrimaryVector(index);
+	return columnMatrix.getPrimaryVector(index);
 }
 void TUColumnSubmatrixFinder::computeRowAndColumnTypes()
 {
@@ -45,7 +87,8 @@ void TUColumnSubmatrixFinder::computeRowAndColumnTypes()
 	for(std::size_t i = 0; i < problem.numCols(); ++i){
         bool isPlusMinusOne = true;
 		bool occursInBadRow = false;
-        for(const Nonzero& nonzero : getColumnVector(i)){
+        //The sign pattern does not store the values, which are needed to find the fractional rows
+        for(const auto& nonzero : problem.matrix.getPrimaryVector(i)){
              if(fabs(nonzero.value()) != 1.0){
                 isPlusMinusOne = false;
             }
@@ -84,6 +127,14 @@ void TUColumnSubmatrixFinder::computeRowAndColumnTypes()
 }
 std::vector<TotallyUnimodularColumnSubmatrix> TUColumnSubmatrixFinder::computeTUSubmatrices() {
     detectionStatistics.clear();
+	//A time limit which does not fit in a time_point is as good as no time limit
+	auto now = std::chrono::steady_clock::now();
+	std::chrono::duration<double> timeLimit(settings.timeLimit);
+	if(timeLimit < std::chrono::steady_clock::time_point::max() - now){
+		deadline = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeLimit);
+	}else{
+		deadline = std::chrono::steady_clock::time_point::max();
+	}
 	//TODO: changing INTEGRAL_EITHER to INTEGRAL_FIXED can also be done only when we check to add INTEGRAL_EITHER
 	//This potentially saves a lot of row-wise iterations over the matrix
 
@@ -93,7 +144,9 @@ std::vector<TotallyUnimodularColumnSubmatrix> TUColumnSubmatrixFinder::computeTU
 //		//Continuous columns make things more difficult.
 //		return integralComputeTUSubmatrices();
 //	}
-	return mixedComputeTUSubmatrices();
+	auto submatrices = mixedComputeTUSubmatrices();
+	environmentPool.releaseMemory();
+	return submatrices;
 }
 
 struct ColumnInfo{
@@ -105,7 +158,7 @@ std::vector<TotallyUnimodularColumnSubmatrix> TUColumnSubmatrixFinder::integralC
 	assert(numContinuousRequired == 0 && numContinuousDisconnected == 0);
 	//First, we change all columns of INTEGRAL_EITHER with entries in non-integral rows to INTEGRAL_FIXED
 	for(index_t row : nonIntegralRows ){
-		for(const Nonzero& nonzero : getRowVector(row)){
+		for(const auto& nonzero : getRowVector(row)){
 			if(types[nonzero.index()] == TUColumnType::INTEGRAL_EITHER){
 				types[nonzero.index()] = TUColumnType::INTEGRAL_FIXED;
 				--numIntegralEither;
@@ -125,7 +178,7 @@ std::vector<TotallyUnimodularColumnSubmatrix> TUColumnSubmatrixFinder::integralC
 	for(index_t row = 0; row < problem.numRows(); ++row){
 		if(isNonIntegralRow[row]) continue;
 		index_t numNonzero = 0;
-		for(const Nonzero& nonzero : getRowVector(row)){
+		for(const auto& nonzero : getRowVector(row)){
 			if(types[nonzero.index()] == TUColumnType::INTEGRAL_EITHER){
 				++numNonzero;
 				if(numNonzero > 1){
@@ -153,7 +206,7 @@ std::vector<TotallyUnimodularColumnSubmatrix> TUColumnSubmatrixFinder::integralC
 	for(index_t i = 0; i < problem.numCols(); ++i){
 		if(types[i] == TUColumnType::INTEGRAL_EITHER){
 			index_t numColNonzeros = 0;
-			for(const Nonzero& nonzero : getColumnVector(i)){
+			for(const auto& nonzero : getColumnVector(i)){
 				assert(!isNonIntegralRow[nonzero.index()]);
 				if(!rowIsUnit[nonzero.index()]){ //TODO: we could also simply substract one from relevant columns when computing unit rows
 					++numColNonzeros;
@@ -213,81 +266,129 @@ std::vector<TotallyUnimodularColumnSubmatrix> TUColumnSubmatrixFinder::integralC
 	TotallyUnimodularColumnSubmatrix submatrix = computeImplyingColumns(*best);
 	return {submatrix};
 }
+std::vector<index_t> TUColumnSubmatrixFinder::findContinuousComponentStarts() const
+{
+	//Elements [0,numRows) are the rows, elements numRows + i are the columns
+	ConcurrentUnionFind unionFind(problem.numRows() + problem.numCols());
+	constexpr index_t COLUMNS_PER_TASK = 1024;
+	index_t numTasks = (problem.numCols() + COLUMNS_PER_TASK - 1) / COLUMNS_PER_TASK;
+	parallelFor(numTasks, settings.numThreads, [&](index_t task){
+		index_t end = std::min(problem.numCols(), (task + 1) * COLUMNS_PER_TASK);
+		for (index_t column = task * COLUMNS_PER_TASK; column < end; ++column)
+		{
+			if (problem.colType[column] != VariableType::CONTINUOUS) continue;
+			for (const auto& nonzero : getColumnVector(column))
+			{
+				unionFind.unite(problem.numRows() + column, nonzero.index());
+			}
+		}
+	});
+
+	std::vector<index_t> starts;
+	std::vector<bool> rootSeen(unionFind.size(), false);
+	for (index_t column = 0; column < problem.numCols(); ++column)
+	{
+		if (problem.colType[column] != VariableType::CONTINUOUS) continue;
+		index_t root = unionFind.find(problem.numRows() + column);
+		if (!rootSeen[root])
+		{
+			rootSeen[root] = true;
+			starts.push_back(column);
+		}
+	}
+	return starts;
+}
+void TUColumnSubmatrixFinder::traverseContinuousComponent(index_t startColumn, long componentLabel,
+		Component& component, std::vector<long>& rowComponent, std::vector<long>& colComponent,
+		std::vector<long>& nRowEntries, std::vector<long>& nColEntries) const
+{
+	std::vector<index_t> dfsStack;
+	dfsStack.push_back(problem.numRows() + startColumn);
+	colComponent[startColumn] = componentLabel;
+
+	//Do DFS
+	while (!dfsStack.empty())
+	{
+		index_t index = dfsStack.back();
+		dfsStack.pop_back();
+		if (index >= problem.numRows())
+		{
+
+			long nEntries = 0;
+
+			index_t column = index - problem.numRows();
+			component.cols.push_back(column);
+			for (const auto& nonzero : getColumnVector(column))
+			{
+				++nEntries;
+				assert(rowComponent[nonzero.index()] == 0
+						|| rowComponent[nonzero.index()] == componentLabel);
+				if (rowComponent[nonzero.index()] == 0)
+				{
+					dfsStack.push_back(nonzero.index());
+					rowComponent[nonzero.index()] = componentLabel;
+				}
+			}
+			nColEntries[column] = nEntries;
+		}
+		else
+		{
+			component.rows.push_back(index);
+
+			long nEntries = 0;
+			for (const auto& nonzero : getRowVector(index))
+			{
+				if (problem.colType[nonzero.index()] == VariableType::CONTINUOUS)
+				{
+					assert(colComponent[nonzero.index()] == 0
+							|| colComponent[nonzero.index()] == componentLabel);
+					if (colComponent[nonzero.index()] == 0)
+					{
+						dfsStack.push_back(problem.numRows() + nonzero.index());
+						colComponent[nonzero.index()] = componentLabel;
+					}
+					++nEntries;
+				}
+			}
+			nRowEntries[index] = nEntries;
+		}
+	}
+}
 std::vector<TotallyUnimodularColumnSubmatrix> TUColumnSubmatrixFinder::mixedComputeTUSubmatrices()
 {
 	//Find connected components of submatrix formed by continuous columns
 	//Iterate over the bad rows and bad columns and mark the component containing the row/column as bad if it contains a bad row or column
 	//For newly marked bad rows, change any columns intersecting it of INTEGRAL_EITHER to INTEGRAL_FIXED
 
-	long currentComponent = 0;
-
 	std::vector<Component> components;
 	std::vector<long> rowComponent(problem.numRows(), 0);
 	std::vector<long> colComponent(problem.numCols(), 0);
 
 	std::vector<long> cSubMatRowEntries(problem.numRows(),0);
 	std::vector<long> cSubMatColEntries(problem.numCols(),0);
+	if (resolveNumThreads(settings.numThreads) <= 1)
 	{
-		std::vector<index_t> dfsStack;
 		for (index_t i = 0; i < problem.numCols(); ++i)
 		{
 			if (problem.colType[i] == VariableType::CONTINUOUS && colComponent[i] == 0){
-				Component component;
-				++currentComponent;
-				dfsStack.push_back(problem.numRows() + i);
-				colComponent[i] = currentComponent;
-
-				//Do DFS
-				while (!dfsStack.empty())
-				{
-					index_t index = dfsStack.back();
-					dfsStack.pop_back();
-					if (index >= problem.numRows())
-					{
-
-						long nEntries = 0;
-
-						index_t column = index - problem.numRows();
-						component.cols.push_back(column);
-						for (const Nonzero& nonzero : getColumnVector(column))
-						{
-							++nEntries;
-							assert(rowComponent[nonzero.index()] == 0
-									|| rowComponent[nonzero.index()] == currentComponent);
-							if (rowComponent[nonzero.index()] == 0)
-							{
-								dfsStack.push_back(nonzero.index());
-								rowComponent[nonzero.index()] = currentComponent;
-							}
-						}
-						cSubMatColEntries[column] = nEntries;
-					}
-					else
-					{
-						component.rows.push_back(index);
-
-						long nEntries = 0;
-						for (const Nonzero& nonzero : getRowVector(index))
-						{
-							if (problem.colType[nonzero.index()] == VariableType::CONTINUOUS)
-							{
-								assert(colComponent[nonzero.index()] == 0
-										|| colComponent[nonzero.index()] == currentComponent);
-								if (colComponent[nonzero.index()] == 0)
-								{
-									dfsStack.push_back(problem.numRows() + nonzero.index());
-									colComponent[nonzero.index()] = currentComponent;
-								}
-								++nEntries;
-							}
-						}
-						cSubMatRowEntries[index] = nEntries;
-					}
-				}
-				components.push_back(component);
+				Component& component = components.emplace_back();
+				traverseContinuousComponent(i, long(components.size()), component, rowComponent, colComponent,
+						cSubMatRowEntries, cSubMatColEntries);
 			}
 		}
 	}
+	else
+	{
+		//Knowing where each component starts, the components can be traversed independently.
+		//Each traversal is identical to the serial one, so the result does not depend on the number of threads.
+		std::vector<index_t> componentStarts = findContinuousComponentStarts();
+		components.resize(componentStarts.size());
+		parallelFor(componentStarts.size(), settings.numThreads, [&](index_t component){
+			traverseContinuousComponent(componentStarts[component], long(component + 1), components[component],
+					rowComponent, colComponent, cSubMatRowEntries, cSubMatColEntries);
+		});
+	}
+	long currentComponent = long(components.size());
 
 	std::vector<bool> componentValid(currentComponent, true);
 
@@ -323,20 +424,40 @@ std::vector<TotallyUnimodularColumnSubmatrix> TUColumnSubmatrixFinder::mixedComp
 
 	//TODO: test if combining transposed/non-transposed makes any sense
 
-	std::vector<Submatrix> submatrices;
-	for(bool transposed : {true,false}){
-		Submatrix submatrix = computeIncidenceSubmatrix(transposed,components,componentValid,
-				cSubMatRowEntries,cSubMatColEntries,rowComponent);
-		submatrices.push_back(submatrix);
-		submatrices.push_back(computeNetworkSubmatrix(transposed,components,componentValid,rowComponent));
+	//The four strategies only read the shared data, so they can run concurrently, each with its own addition.
+	//Strategies are stored in a fixed order, so that ties are broken the same way regardless of the thread count.
+	constexpr index_t NUM_STRATEGIES = 4;
+	std::vector<std::optional<Submatrix>> submatrices(NUM_STRATEGIES);
+	std::vector<DetectionStatistics> strategyStatistics(NUM_STRATEGIES);
+	std::atomic<bool> cancelled{false};
+	//Threads which are not needed for the strategies themselves are used to test the network components
+	index_t componentThreads = std::max<index_t>(1, resolveNumThreads(settings.numThreads) / NUM_STRATEGIES);
+	parallelFor(NUM_STRATEGIES, settings.numThreads, [&](index_t strategy){
+		bool transposed = strategy < 2;
+		auto& submatrix = submatrices[strategy];
+		if(strategy % 2 == 0){
+			submatrix = computeIncidenceSubmatrix(transposed,components,componentValid,
+					cSubMatRowEntries,cSubMatColEntries,rowComponent,cancelled,strategyStatistics[strategy]);
+		}else{
+			submatrix = computeNetworkSubmatrix(transposed,components,componentValid,rowComponent,
+					componentThreads,cancelled,strategyStatistics[strategy]);
+		}
+		if(submatrix && settings.targetColumns != 0 && submatrix->columns.size() >= settings.targetColumns){
+			cancelled.store(true, std::memory_order_relaxed);
+		}
+	});
+	const Submatrix * best = nullptr;
+	for(index_t strategy = 0; strategy < NUM_STRATEGIES; ++strategy){
+		if(!submatrices[strategy]) continue; //cancelled
+		detectionStatistics.push_back(strategyStatistics[strategy]);
+		if(best == nullptr || best->columns.size() < submatrices[strategy]->columns.size()){
+			best = &submatrices[strategy].value();
+		}
 	}
-    auto best = std::max_element(submatrices.begin(),submatrices.end(),[](const auto& first, const auto& second){
-        return first.columns.size() < second.columns.size();
-    });
-	auto& bestSubmatrix = *best;
-	if(bestSubmatrix.columns.empty()){
+	if(best == nullptr || best->columns.empty()){
 		return {};
 	}
+	const Submatrix& bestSubmatrix = *best;
 //	std::cout<<"Selecting submatrix with: "<<bestSubmatrix.columns.size()<<" columns\n";
 	return {computeImplyingColumns(bestSubmatrix)};
 
@@ -370,14 +491,15 @@ TotallyUnimodularColumnSubmatrix TUColumnSubmatrixFinder::computeImplyingColumns
 			.submatColumns = submatrix.columns,
 	};
 }
-Submatrix TUColumnSubmatrixFinder::computeIncidenceSubmatrix(bool transposed,
+std::optional<Submatrix> TUColumnSubmatrixFinder::computeIncidenceSubmatrix(bool transposed,
 		const std::vector<Component>& components,
 		const std::vector<bool>& componentValid,
 		const std::vector<long>& nRowEntries,
 		const std::vector<long>& nColEntries,
-		const std::vector<long>& rowComponents)
+		const std::vector<long>& rowComponents,
+		const std::atomic<bool>& cancelled,
+		DetectionStatistics& stats) const
 {
-    DetectionStatistics stats;
     auto tStart = std::chrono::high_resolution_clock::now();
 
     IncidenceAddition addition(problem.numRows(),problem.numCols(),Submatrix::INIT_NONE,transposed);
@@ -391,9 +513,14 @@ Submatrix TUColumnSubmatrixFinder::computeIncidenceSubmatrix(bool transposed,
 	std::vector<index_t> unitColRows;
 
     index_t numErasedComponents = 0;
+	DetectionBudget budget(deadline);
 
 	for(std::size_t i = 0; i < components.size(); ++i){
-		if(!componentValid[i])
+		if(cancelled.load(std::memory_order_relaxed)){
+			return std::nullopt;
+		}
+		//Once the time is up, the remaining components are left out, which keeps the submatrix valid
+		if(!componentValid[i] || budget.isExhausted())
 		{
 			invalidComponents.push_back(i);
 			continue;
@@ -415,7 +542,7 @@ Submatrix TUColumnSubmatrixFinder::computeIncidenceSubmatrix(bool transposed,
 			{
 				componentUnitCols.push_back(col);
 			}else{
-				if (!addition.tryAddCol(col, getColumnVector(col)))
+				if (!budget.spend() || !addition.tryAddCol(col, getColumnVector(col)))
 				{
 					good = false;
 					break;
@@ -475,7 +602,7 @@ Submatrix TUColumnSubmatrixFinder::computeIncidenceSubmatrix(bool transposed,
 
     index_t expandedColumns = 0;
 
-    if(numIntegralEither > 0 && settings.doDowngrade){
+    if(numIntegralEither > 0 && settings.doDowngrade && !budget.isExhausted()){
 		// Clean up rows; If we removed any components because the continuous columns are not TU,
 		// integral_either entries need to become integral_fixed, and the row excluded from any further candidates
 		std::vector<bool> extendedInvalidRows = isNonIntegralRow;
@@ -531,7 +658,7 @@ Submatrix TUColumnSubmatrixFinder::computeIncidenceSubmatrix(bool transposed,
 			index_t nNonComponentEntries = colComponentEntries[-1];
 			ColCandidateData data{
 				.column = i,
-				.nContinuousComponents = colComponentEntries.size() -1,
+				.nContinuousComponents = static_cast<index_t>(colComponentEntries.size() - 1),
 				.nonComponentNonzeros = nNonComponentEntries,
 				.nonzeros = nonzeros,
 				.obj = problem.obj[i],
@@ -556,6 +683,12 @@ Submatrix TUColumnSubmatrixFinder::computeIncidenceSubmatrix(bool transposed,
 
 		}
 		for(const auto& candidate : candidates){
+			if(cancelled.load(std::memory_order_relaxed)){
+				return std::nullopt;
+			}
+			if(!budget.spend()){
+				break;
+			}
             assert(problem.colType[candidate.column] != VariableType::CONTINUOUS);
 			if(addition.tryAddCol(candidate.column, getColumnVector(candidate.column))){
 				++expandedColumns;
@@ -569,8 +702,12 @@ Submatrix TUColumnSubmatrixFinder::computeIncidenceSubmatrix(bool transposed,
 
     auto tEnd = std::chrono::high_resolution_clock::now();
 
-    std::cout<<"Incidence: Continuous columns: "<< contColumns  <<", expanded with "<<expandedColumns<<" integral columns, "
-             << unitCols.size()<< " unit columns, time: "<<(tEnd-tStart).count()/1e9<<" s"<<std::endl;
+    //Strategies may run concurrently, so the line is written at once to avoid interleaving
+    std::ostringstream message;
+    message<<"Incidence: Continuous columns: "<< contColumns  <<", expanded with "<<expandedColumns<<" integral columns, "
+             << unitCols.size()<< " unit columns, time: "<<(tEnd-tStart).count()/1e9<<" s"
+             << (budget.isExhausted() ? ", time limit reached" : "") << "\n";
+    std::cout<<message.str()<<std::flush;
 
 	Submatrix submatrix = addition.createSubmatrix();
 	if(!transposed){
@@ -610,51 +747,134 @@ Submatrix TUColumnSubmatrixFinder::computeIncidenceSubmatrix(bool transposed,
     stats.numRows = submatrix.rows.size();
     stats.numColumns = submatrix.columns.size();
 
-    detectionStatistics.push_back(stats);
-
 	return submatrix;
 }
 
-Submatrix TUColumnSubmatrixFinder::computeNetworkSubmatrix(bool transposed,
+std::optional<Submatrix> TUColumnSubmatrixFinder::computeNetworkSubmatrix(bool transposed,
                                                            const std::vector<Component> &components,
                                                            const std::vector<bool>& componentValid,
-                                                           const std::vector<long> &rowComponents) {
+                                                           const std::vector<long> &rowComponents,
+                                                           index_t numThreads,
+                                                           const std::atomic<bool>& cancelled,
+                                                           DetectionStatistics& stats) const {
     auto tStart = std::chrono::high_resolution_clock::now();
 
-    NetworkAddition addition(problem.numRows(),problem.numCols(),Submatrix::INIT_NONE,transposed);
+    NetworkAddition addition(problem.numRows(),problem.numCols(),Submatrix::INIT_NONE,transposed,&environmentPool);
+    //The decomposition can hold at most the rows and columns of the valid components, and usually holds most of them
+    auto reserveComponents = [&](NetworkAddition& componentAddition, index_t first, index_t last){
+        index_t numRows = 0;
+        index_t numCols = 0;
+        for(index_t i = first; i < last; ++i){
+            if(componentValid[i]){
+                numRows += components[i].rows.size();
+                numCols += components[i].cols.size();
+            }
+        }
+        componentAddition.reserve(numRows,numCols);
+    };
+    reserveComponents(addition,0,components.size());
 
     std::size_t numErasedComponents = 0;
 
+    //Components are independent, so whether a column can be added only depends on its own component.
+    //With multiple threads, groups of components are tested in separate decompositions which are merged afterwards,
+    //which gives the same submatrix as testing all components in one decomposition.
+    enum ComponentResult : char{
+        UNTESTED,
+        GOOD,
+        FAILED
+    };
+    std::vector<ComponentResult> componentResults(components.size(), UNTESTED);
+    std::atomic<bool> timeLimitReached{false};
+    auto testComponents = [&](NetworkAddition& componentAddition, index_t first, index_t last){
+        DetectionBudget componentBudget(deadline);
+        for(index_t i = first; i < last; ++i){
+            if(cancelled.load(std::memory_order_relaxed)){
+                return;
+            }
+            if(!componentValid[i]) continue;
+            const auto& component = components[i];
+            bool good = true;
+            componentAddition.checkpoint();
+            for (index_t col: component.cols) {
+                if (!componentBudget.spend()) {
+                    //Leave out the partially added component, and do not test any further components
+                    componentAddition.rollback();
+                    timeLimitReached.store(true, std::memory_order_relaxed);
+                    return;
+                }
+                if (!componentAddition.tryAddCol(col, getColumnVector(col))) {
+                    good = false;
+                    break;
+                }
+            }
+            if(good){
+                componentResults[i] = GOOD;
+                componentAddition.commit();
+            }else{
+                componentResults[i] = FAILED;
+                componentAddition.rollback();
+            }
+        }
+    };
+    if(numThreads <= 1){
+        testComponents(addition,0,components.size());
+    }else{
+        //Split the components into contiguous groups with roughly the same number of columns.
+        //Every group allocates a full decomposition, so there are only a few groups per thread.
+        index_t numTasks = std::min<index_t>(components.size(), 4 * numThreads);
+        std::size_t totalColumns = 0;
+        for(const auto& component : components){
+            totalColumns += component.cols.size();
+        }
+        std::vector<index_t> taskStarts{0};
+        std::size_t columns = 0;
+        for(index_t i = 0; i < components.size(); ++i){
+            columns += components[i].cols.size();
+            if(taskStarts.size() < numTasks && columns * numTasks >= totalColumns * taskStarts.size()){
+                taskStarts.push_back(i + 1);
+            }
+        }
+        if(taskStarts.back() != components.size()){
+            taskStarts.push_back(components.size());
+        }
+        std::vector<std::unique_ptr<NetworkAddition>> taskAdditions(taskStarts.size() - 1);
+        parallelFor(taskAdditions.size(), numThreads, [&](index_t task){
+            auto taskAddition = std::make_unique<NetworkAddition>(problem.numRows(),problem.numCols(),
+                                                                  Submatrix::INIT_NONE,transposed,
+                                                                  &environmentPool);
+            reserveComponents(*taskAddition,taskStarts[task],taskStarts[task+1]);
+            testComponents(*taskAddition,taskStarts[task],taskStarts[task+1]);
+            taskAdditions[task] = std::move(taskAddition);
+        });
+        for(auto& taskAddition : taskAdditions){
+            addition.merge(*taskAddition);
+            taskAddition.reset();
+        }
+    }
+    if(cancelled.load(std::memory_order_relaxed)){
+        return std::nullopt;
+    }
+
     std::vector<index_t> invalidComponents;
     std::vector<index_t> validComponents;
-	for(std::size_t i = 0; i < components.size(); ++i){
-		auto& component = components[i];
-        if(!componentValid[i]){
+    for(std::size_t i = 0; i < components.size(); ++i){
+        if(componentValid[i] && componentResults[i] == GOOD){
+            validComponents.push_back(i);
+        }else{
             invalidComponents.push_back(i);
-            continue;
-        }
-        bool good = true;
-
-        for (index_t col: component.cols) {
-            if (!addition.tryAddCol(col, getColumnVector(col))) {
-                good = false;
-                break;
+            if(componentValid[i] && componentResults[i] == FAILED){
+                ++numErasedComponents;
             }
         }
-
-		if(good){
-			validComponents.push_back(i);
-		}else{
-			invalidComponents.push_back(i);
-			addition.removeComponent(component.rows,component.cols);
-            ++numErasedComponents;
-		}
-	}
+    }
+    bool outOfTime = timeLimitReached.load(std::memory_order_relaxed);
     auto tMid = std::chrono::high_resolution_clock::now();
 
     index_t expandedColumns = 0;
 
-    if(numIntegralEither > 0 && settings.doDowngrade){
+    if(numIntegralEither > 0 && settings.doDowngrade && !outOfTime){
+        DetectionBudget budget(deadline);
         // Clean up rows; If we removed any components because the continuous columns are not TU,
         // integral_either entries need to become integral_fixed, and the row excluded from any further candidates
         std::vector<bool> extendedInvalidRows = isNonIntegralRow;
@@ -696,11 +916,12 @@ Submatrix TUColumnSubmatrixFinder::computeNetworkSubmatrix(bool transposed,
                     ++hashmapEntry->second;
                 }
             }
-            if(containsInvalidRow) continue;
+            //Columns with entries other than +1 or -1 can never be added
+            if(containsInvalidRow || !getColumnVector(i).allUnit()) continue;
             index_t nNonComponentEntries = colComponentEntries[-1];
             ColCandidateData data{
                     .column = i,
-                    .nContinuousComponents = colComponentEntries.size() -1,
+                    .nContinuousComponents = static_cast<index_t>(colComponentEntries.size() - 1),
                     .nonComponentNonzeros = nNonComponentEntries,
                     .nonzeros = nonzeros,
                     .obj = problem.obj[i],
@@ -724,12 +945,26 @@ Submatrix TUColumnSubmatrixFinder::computeNetworkSubmatrix(bool transposed,
             return first.nonzeros < second.nonzeros;
         });
 
-        std::size_t triedAdditions = candidates.size();
+        std::vector<index_t> candidateColumns;
+        candidateColumns.reserve(candidates.size());
         for(const auto& candidate : candidates){
             assert(problem.colType[candidate.column] != VariableType::CONTINUOUS);
-            if(addition.tryAddCol(candidate.column, getColumnVector(candidate.column))){
-                ++expandedColumns;
+            candidateColumns.push_back(candidate.column);
+        }
+        //The candidates are added in batches, so that the deadline and cancellation are still checked regularly
+        constexpr std::size_t BATCH_SIZE = 64;
+        std::vector<std::uint64_t> accepted;
+        for(std::size_t first = 0; first < candidateColumns.size(); first += BATCH_SIZE){
+            if(cancelled.load(std::memory_order_relaxed)){
+                return std::nullopt;
             }
+            std::size_t batchSize = std::min(BATCH_SIZE, candidateColumns.size() - first);
+            if(!budget.spend(batchSize)){
+                outOfTime = true;
+                break;
+            }
+            expandedColumns += addition.tryAddCols(columnMatrix,
+                                                   std::span(candidateColumns).subspan(first,batchSize),accepted);
         }
     }
 
@@ -740,13 +975,14 @@ Submatrix TUColumnSubmatrixFinder::computeNetworkSubmatrix(bool transposed,
         contColumns += components[component].cols.size();
     }
 
-    std::cout<<"Network: Continuous columns: "<< contColumns  <<", expanded with "<<expandedColumns<<" integral columns, total time: "
+    std::ostringstream message;
+    message<<"Network: Continuous columns: "<< contColumns  <<", expanded with "<<expandedColumns<<" integral columns, total time: "
     << (tEnd-tStart).count()/1e9<<" s, cont time: "<<(tMid-tStart).count()/1e9<<" s"
-    <<std::endl;
+    << (outOfTime ? ", time limit reached" : "") << "\n";
+    std::cout<<message.str()<<std::flush;
 
     Submatrix matrix = addition.createSubmatrix(problem.numRows(),problem.numCols());
 
-    DetectionStatistics stats;
     stats.method = transposed ? "transposed network addition" : "network addition";
     stats.timeTaken = (tEnd-tStart).count() /1e9;
     stats.numUpgraded = contColumns;
@@ -766,8 +1002,6 @@ Submatrix TUColumnSubmatrixFinder::computeNetworkSubmatrix(bool transposed,
     stats.numRows = matrix.rows.size();
     stats.numColumns = matrix.columns.size();
 
-    detectionStatistics.push_back(stats);
-
     return matrix;
 }
 
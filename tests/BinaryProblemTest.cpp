@@ -0,0 +1,160 @@
+//
+// Created by rolf on 17-10-26.
+//
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <mipworkshop2024/BinaryProblem.h>
+#include <mipworkshop2024/IO.h>
+
+namespace {
+std::filesystem::path binaryTestPath(const std::string& name){
+  return std::filesystem::temp_directory_path() / ("mipworkshop2024_" + name + BINARY_PROBLEM_EXTENSION.data());
+}
+}
+
+TEST(BinaryProblem,roundTrip){
+  std::size_t numRead = 0;
+  for(const auto& entry : std::filesystem::directory_iterator(MIPWORKSHOP2024_TEST_DATA_DIR)){
+    if(!entry.is_regular_file() || entry.path().extension() != ".mps"){
+      continue;
+    }
+    auto problem = readMPSFile(entry.path());
+    if(!problem.has_value()){
+      continue;
+    }
+    auto path = binaryTestPath(entry.path().stem().string());
+    ASSERT_TRUE(writeBinaryProblemFile(problem.value(),path));
+
+    auto view = BinaryProblemView::open(path);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->problemName(),problem->name);
+    ASSERT_EQ(view->numCols(),problem->numCols());
+    ASSERT_EQ(view->numRows(),problem->numRows());
+    for(index_t col = 0; col < problem->numCols(); ++col){
+      EXPECT_EQ(view->columnName(col),problem->colNames[col]);
+      EXPECT_EQ(view->columnType(col),problem->colType[col]);
+      auto expected = problem->matrix.getPrimaryVector(col);
+      auto slice = view->column(col);
+      EXPECT_TRUE(std::equal(expected.begin(),expected.end(),slice.begin(),slice.end(),
+                             [](const Nonzero& a, const Nonzero& b){
+        return a.index() == b.index() && a.value() == b.value();
+      }));
+    }
+    for(index_t row = 0; row < problem->numRows(); ++row){
+      EXPECT_EQ(view->rowName(row),problem->rowNames[row]);
+    }
+
+    auto loaded = readMPSFile(path);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->name,problem->name);
+    EXPECT_EQ(loaded->sense,problem->sense);
+    EXPECT_EQ(loaded->objectiveOffset,problem->objectiveOffset);
+    EXPECT_EQ(loaded->obj,problem->obj);
+    EXPECT_EQ(loaded->lb,problem->lb);
+    EXPECT_EQ(loaded->ub,problem->ub);
+    EXPECT_EQ(loaded->colType,problem->colType);
+    EXPECT_EQ(loaded->lhs,problem->lhs);
+    EXPECT_EQ(loaded->rhs,problem->rhs);
+    EXPECT_EQ(loaded->colNames,problem->colNames);
+    EXPECT_EQ(loaded->rowNames,problem->rowNames);
+    EXPECT_EQ(loaded->matrix.getPrimaryStart(),problem->matrix.getPrimaryStart());
+    EXPECT_EQ(loaded->matrix.getSecondaryIndex(),problem->matrix.getSecondaryIndex());
+    EXPECT_EQ(loaded->matrix.getValues(),problem->matrix.getValues());
+    std::filesystem::remove(path);
+    ++numRead;
+  }
+  EXPECT_GT(numRead,0);
+}
+
+TEST(BinaryProblem,rejectsInvalidFiles){
+  auto problem = readMPSFile(std::filesystem::path(MIPWORKSHOP2024_TEST_DATA_DIR) / "egout.mps");
+  ASSERT_TRUE(problem.has_value());
+  auto path = binaryTestPath("invalid");
+  ASSERT_TRUE(writeBinaryProblemFile(problem.value(),path));
+  std::string contents;
+  {
+    std::ifstream stream(path,std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(stream),std::istreambuf_iterator<char>());
+  }
+  auto writeModified = [&](const std::string& modified){
+    std::ofstream stream(path,std::ios::binary | std::ios::trunc);
+    stream << modified;
+  };
+
+  std::string wrongMagic = contents;
+  wrongMagic[0] = 'X';
+  writeModified(wrongMagic);
+  EXPECT_FALSE(BinaryProblemView::open(path).has_value());
+
+  std::string wrongVersion = contents;
+  wrongVersion[offsetof(BinaryProblemHeader,version)] += 1;
+  writeModified(wrongVersion);
+  EXPECT_FALSE(BinaryProblemView::open(path).has_value());
+
+  writeModified(contents.substr(0,contents.size()/2));
+  EXPECT_FALSE(BinaryProblemView::open(path).has_value());
+
+  writeModified(contents);
+  EXPECT_TRUE(BinaryProblemView::open(path).has_value());
+  std::filesystem::remove(path);
+}
+
+TEST(BinaryProblem,roundTripWithoutNames){
+  auto problem = readMPSFile(std::filesystem::path(MIPWORKSHOP2024_TEST_DATA_DIR) / "egout.mps");
+  ASSERT_TRUE(problem.has_value());
+  problem->releaseNames();
+  ASSERT_FALSE(problem->hasNames());
+  auto path = binaryTestPath("nameless");
+  ASSERT_TRUE(writeBinaryProblemFile(problem.value(),path));
+
+  auto view = BinaryProblemView::open(path);
+  ASSERT_TRUE(view.has_value());
+  ASSERT_EQ(view->numCols(),problem->numCols());
+  ASSERT_EQ(view->numRows(),problem->numRows());
+  for(index_t col = 0; col < problem->numCols(); ++col){
+    EXPECT_EQ(view->columnName(col),problem->columnName(col));
+  }
+  for(index_t row = 0; row < problem->numRows(); ++row){
+    EXPECT_EQ(view->rowName(row),problem->rowName(row));
+  }
+
+  Problem loaded = view->toProblem(true);
+  EXPECT_TRUE(loaded.hasNames());
+  EXPECT_EQ(loaded.numCols(),problem->numCols());
+  EXPECT_EQ(loaded.obj,problem->obj);
+  EXPECT_EQ(loaded.lhs,problem->lhs);
+  EXPECT_EQ(loaded.rhs,problem->rhs);
+  EXPECT_EQ(loaded.matrix.getValues(),problem->matrix.getValues());
+  for(index_t col = 0; col < problem->numCols(); ++col){
+    EXPECT_EQ(loaded.columnName(col),problem->columnName(col));
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(BinaryProblem,rejectsDuplicateNames){
+  Problem problem;
+  problem.addRow("r0",-infinity,1.0);
+  problem.addColumn("x",{0},{1.0},VariableType::BINARY,0.0,1.0);
+  problem.addColumn("y",{0},{1.0},VariableType::BINARY,0.0,1.0);
+  auto path = binaryTestPath("duplicate");
+  ASSERT_TRUE(writeBinaryProblemFile(problem,path));
+  EXPECT_TRUE(BinaryProblemView::open(path).has_value());
+
+  std::string contents;
+  {
+    std::ifstream stream(path,std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(stream),std::istreambuf_iterator<char>());
+  }
+  const std::string names("x\0y\0",4);
+  std::size_t position = contents.find(names);
+  ASSERT_NE(position,std::string::npos);
+  contents[position + 2] = 'x';
+  {
+    std::ofstream stream(path,std::ios::binary | std::ios::trunc);
+    stream << contents;
+  }
+  EXPECT_FALSE(BinaryProblemView::open(path).has_value());
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,166 @@
+//
+// Created by rolf on 17-10-26.
+//
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <mipworkshop2024/GzipReader.h>
+#include <mipworkshop2024/IO.h>
+#include <zlib.h>
+
+namespace {
+
+std::string readFile(const std::filesystem::path& path){
+  std::ifstream stream(path,std::ios::binary);
+  return {std::istreambuf_iterator<char>(stream),std::istreambuf_iterator<char>()};
+}
+
+/// Compresses data into a single gzip member. If bgzf is set, the member size is stored in a 'BC' extra subfield.
+std::string gzipMember(std::string_view data, bool bgzf){
+  z_stream stream{};
+  deflateInit2(&stream,Z_DEFAULT_COMPRESSION,Z_DEFLATED,-15,8,Z_DEFAULT_STRATEGY);
+  std::string deflated(deflateBound(&stream,data.size()),'\0');
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = data.size();
+  stream.next_out = reinterpret_cast<Bytef*>(deflated.data());
+  stream.avail_out = deflated.size();
+  EXPECT_EQ(deflate(&stream,Z_FINISH),Z_STREAM_END);
+  deflated.resize(stream.total_out);
+  deflateEnd(&stream);
+
+  auto putLittleEndian = [](std::string& out, std::uint32_t value, int numBytes){
+    for(int i = 0; i < numBytes; ++i){
+      out.push_back(static_cast<char>((value >> (8*i)) & 0xff));
+    }
+  };
+  std::string member = {'\x1f','\x8b','\x08',bgzf ? '\x04' : '\x00','\0','\0','\0','\0','\0','\xff'};
+  if(bgzf){
+    std::size_t totalSize = 12 + 6 + deflated.size() + 8;
+    putLittleEndian(member,6,2);
+    member += "BC";
+    putLittleEndian(member,2,2);
+    putLittleEndian(member,totalSize-1,2);
+  }
+  member += deflated;
+  putLittleEndian(member,crc32(0,reinterpret_cast<const Bytef*>(data.data()),data.size()),4);
+  putLittleEndian(member,data.size(),4);
+  return member;
+}
+
+std::string gzipMembers(std::string_view data, std::size_t memberSize, bool bgzf){
+  std::string result;
+  for(std::size_t offset = 0; offset < data.size(); offset += memberSize){
+    result += gzipMember(data.substr(offset,memberSize),bgzf);
+  }
+  if(bgzf){
+    result += gzipMember({},true); //end-of-file marker, as written by bgzip
+  }
+  return result;
+}
+
+std::string decompressAll(const std::filesystem::path& path, const GzipReadSettings& settings, bool& success){
+  std::string result;
+  success = readGzipFileBlocks(path,settings,[&](std::string_view block){
+    result += block;
+    return true;
+  });
+  return result;
+}
+
+class GzipReaderTest : public ::testing::Test{
+protected:
+  void SetUp() override{
+    directory = std::filesystem::temp_directory_path() /
+        ("mipworkshop2024_gzip_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    std::filesystem::create_directories(directory);
+  }
+  void TearDown() override{
+    std::filesystem::remove_all(directory);
+  }
+  std::filesystem::path write(const std::string& name, const std::string& contents){
+    auto path = directory / name;
+    std::ofstream stream(path,std::ios::binary);
+    stream << contents;
+    return path;
+  }
+  std::filesystem::path directory;
+};
+
+}
+
+TEST_F(GzipReaderTest,memberLayouts){
+  std::string data = readFile(std::filesystem::path(MIPWORKSHOP2024_TEST_DATA_DIR) / "p0548.mps");
+  ASSERT_FALSE(data.empty());
+  std::vector<std::filesystem::path> paths = {
+      write("single.gz",gzipMember(data,false)),
+      write("multi.gz",gzipMembers(data,1000,false)),
+      write("bgzf.gz",gzipMembers(data,1000,true))
+  };
+  for(const auto& path : paths){
+    for(index_t numThreads : {1,4}){
+      for(std::size_t blockSize : {std::size_t(1),std::size_t(777),std::size_t(1) << 20}){
+        bool success = false;
+        std::string result = decompressAll(path,{.blockSize = blockSize, .numBlocks = 3, .numThreads = numThreads},success);
+        EXPECT_TRUE(success) << path;
+        EXPECT_EQ(result,data) << path << " " << blockSize;
+      }
+    }
+  }
+}
+
+TEST_F(GzipReaderTest,truncatedAndInvalid){
+  std::string data = readFile(std::filesystem::path(MIPWORKSHOP2024_TEST_DATA_DIR) / "lseu.mps");
+  std::string compressed = gzipMember(data,false);
+  bool success = true;
+  decompressAll(write("truncated.gz",compressed.substr(0,compressed.size()/2)),{},success);
+  EXPECT_FALSE(success);
+  decompressAll(write("invalid.gz",data),{},success);
+  EXPECT_FALSE(success);
+  decompressAll(directory / "missing.gz",{},success);
+  EXPECT_FALSE(success);
+}
+
+TEST_F(GzipReaderTest,stopEarly){
+  std::string data = readFile(std::filesystem::path(MIPWORKSHOP2024_TEST_DATA_DIR) / "p0548.mps");
+  for(bool bgzf : {false,true}){
+    auto path = write("stop.gz",gzipMembers(data,500,bgzf));
+    index_t numCalls = 0;
+    bool success = readGzipFileBlocks(path,{.blockSize = 100, .numBlocks = 2, .numThreads = 2},[&](std::string_view){
+      ++numCalls;
+      return numCalls < 3;
+    });
+    EXPECT_TRUE(success);
+    EXPECT_EQ(numCalls,3);
+  }
+}
+
+TEST_F(GzipReaderTest,pipelinedMPSEqualsUncompressed){
+  std::size_t numRead = 0;
+  for(const auto& entry : std::filesystem::directory_iterator(MIPWORKSHOP2024_TEST_DATA_DIR)){
+    if(!entry.is_regular_file() || entry.path().extension() != ".mps"){
+      continue;
+    }
+    auto expected = readMPSFile(entry.path());
+    std::string data = readFile(entry.path());
+    auto path = write(entry.path().filename().string() + ".gz",gzipMembers(data,4096,true));
+    auto pipelined = readMPSFile(path,MPSReadSettings{.numThreads = 3, .decompressionBlockSize = 1000});
+    auto filtered = readMPSFile(path,MPSReadSettings{.pipelineDecompression = false});
+    ASSERT_EQ(expected.has_value(),pipelined.has_value()) << entry.path();
+    ASSERT_EQ(expected.has_value(),filtered.has_value()) << entry.path();
+    if(!expected.has_value()){
+      continue;
+    }
+    EXPECT_EQ(expected->colNames,pipelined->colNames);
+    EXPECT_EQ(expected->rowNames,pipelined->rowNames);
+    EXPECT_EQ(expected->obj,pipelined->obj);
+    EXPECT_EQ(expected->lb,pipelined->lb);
+    EXPECT_EQ(expected->ub,pipelined->ub);
+    EXPECT_EQ(expected->lhs,pipelined->lhs);
+    EXPECT_EQ(expected->rhs,pipelined->rhs);
+    EXPECT_EQ(expected->colType,pipelined->colType);
+    EXPECT_EQ(expected->matrix.numCols(),pipelined->matrix.numCols());
+    EXPECT_EQ(filtered->colNames,pipelined->colNames);
+    ++numRead;
+  }
+  EXPECT_GT(numRead,0);
+}
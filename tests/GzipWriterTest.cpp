@@ -0,0 +1,108 @@
+//
+// Created by rolf on 17-10-26.
+//
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <mipworkshop2024/GzipReader.h>
+#include <mipworkshop2024/GzipWriter.h>
+#include <mipworkshop2024/IO.h>
+
+namespace {
+
+std::filesystem::path writerTestPath(const std::string& name){
+  return std::filesystem::temp_directory_path() / ("mipworkshop2024_writer_" + name);
+}
+
+std::string testData(std::size_t size){
+  std::string data;
+  data.reserve(size);
+  for(std::size_t i = 0; data.size() < size; ++i){
+    data += "  x" + std::to_string(i % 1000) + "  c" + std::to_string(i * 7919 % 4099) + "  " + std::to_string(i % 13) + "\n";
+  }
+  data.resize(size);
+  return data;
+}
+
+std::optional<std::string> decompress(const std::filesystem::path& path, index_t numThreads){
+  std::string result;
+  bool good = readGzipFileBlocks(path,GzipReadSettings{.numThreads = numThreads},[&](std::string_view block){
+    result += block;
+    return true;
+  });
+  if(!good){
+    return std::nullopt;
+  }
+  return result;
+}
+
+}
+
+TEST(GzipWriter,roundTrip){
+  std::string data = testData(3'000'000);
+  auto path = writerTestPath("roundTrip.gz");
+  for(index_t numThreads : {1,3}){
+    GzipFileWriter writer(path,GzipWriteSettings{.numThreads = numThreads, .blockSize = 100'000, .numBlocks = 2});
+    //Write in uneven pieces so that the pieces do not line up with the blocks
+    for(std::size_t offset = 0; offset < data.size(); offset += 77'777){
+      ASSERT_TRUE(writer.write(std::string_view(data).substr(offset,77'777)));
+    }
+    ASSERT_TRUE(writer.close());
+    EXPECT_FALSE(writer.write("x"));
+
+    auto decompressed = decompress(path,2);
+    ASSERT_TRUE(decompressed.has_value());
+    EXPECT_EQ(decompressed.value(),data);
+
+    //Parallel compression writes BGZF members, which store their size in a 'BC' extra subfield
+    std::ifstream stream(path,std::ios::binary);
+    std::string header(14,'\0');
+    stream.read(header.data(),header.size());
+    EXPECT_EQ(header[3] == '\x04' && header.substr(12,2) == "BC",numThreads > 1);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(GzipWriter,emptyFile){
+  auto path = writerTestPath("empty.gz");
+  for(index_t numThreads : {1,2}){
+    {
+      GzipFileWriter writer(path,GzipWriteSettings{.numThreads = numThreads});
+      //The destructor finishes the file
+    }
+    auto decompressed = decompress(path,1);
+    ASSERT_TRUE(decompressed.has_value());
+    EXPECT_TRUE(decompressed->empty());
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(GzipWriter,writeMPSFileRoundTrip){
+  //Numbers are written in their shortest round-trip representation, so the values must be read back exactly
+  for(const auto& entry : std::filesystem::directory_iterator(MIPWORKSHOP2024_TEST_DATA_DIR)){
+    if(!entry.is_regular_file() || entry.path().extension() != ".mps"){
+      continue;
+    }
+    auto problem = readMPSFile(entry.path());
+    if(!problem.has_value()){
+      continue;
+    }
+    for(const auto& settings : {MPSWriteSettings{.compress = false},
+                                MPSWriteSettings{.compress = true, .numCompressionThreads = 1},
+                                MPSWriteSettings{.compress = true, .numCompressionThreads = 3}}){
+      auto path = writerTestPath(entry.path().stem().string() + (settings.compress ? ".mps.gz" : ".mps"));
+      ASSERT_TRUE(writeMPSFile(problem.value(),path,settings));
+      auto written = readMPSFile(path);
+      ASSERT_TRUE(written.has_value()) << entry.path();
+      EXPECT_EQ(written->colNames,problem->colNames);
+      EXPECT_EQ(written->rowNames,problem->rowNames);
+      EXPECT_EQ(written->obj,problem->obj);
+      EXPECT_EQ(written->lhs,problem->lhs);
+      EXPECT_EQ(written->rhs,problem->rhs);
+      EXPECT_EQ(written->matrix.getPrimaryStart(),problem->matrix.getPrimaryStart());
+      EXPECT_EQ(written->matrix.getSecondaryIndex(),problem->matrix.getSecondaryIndex());
+      EXPECT_EQ(written->matrix.getValues(),problem->matrix.getValues());
+      std::filesystem::remove(path);
+    }
+  }
+}
@@ -2,7 +2,9 @@
 // Created by rolf on 2-8-23.
 //
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <filesystem>
+#include <sstream>
 #include <mipworkshop2024/IO.h>
 
 TEST(MPSReader,parseMany){
@@ -22,4 +24,220 @@ TEST(MPSReader,parseMany){
 TEST(MPSReader,parseDifficultBounds){
   auto problem = readMPSFile("/home/rolf/math/mipworkshop2024/data/instances/leo1.mps.gz");
   EXPECT_TRUE(problem.has_value());
-}
\ No newline at end of file
+}
+void expectEqualProblems(const Problem& first, const Problem& second){
+  EXPECT_EQ(first.name,second.name);
+  EXPECT_EQ(first.sense,second.sense);
+  EXPECT_EQ(first.objectiveOffset,second.objectiveOffset);
+  EXPECT_EQ(first.colNames,second.colNames);
+  EXPECT_EQ(first.rowNames,second.rowNames);
+  EXPECT_EQ(first.obj,second.obj);
+  EXPECT_EQ(first.lb,second.lb);
+  EXPECT_EQ(first.ub,second.ub);
+  EXPECT_EQ(first.colType,second.colType);
+  EXPECT_EQ(first.lhs,second.lhs);
+  EXPECT_EQ(first.rhs,second.rhs);
+  ASSERT_EQ(first.matrix.numCols(),second.matrix.numCols());
+  ASSERT_EQ(first.matrix.numRows(),second.matrix.numRows());
+  for(index_t col = 0; col < first.matrix.numCols(); ++col){
+    auto firstSlice = first.matrix.getPrimaryVector(col);
+    auto secondSlice = second.matrix.getPrimaryVector(col);
+    ASSERT_EQ(first.matrix.numSecondarySliceEntries(col),second.matrix.numSecondarySliceEntries(col));
+    for(auto firstIt = firstSlice.begin(), secondIt = secondSlice.begin(); firstIt != firstSlice.end(); ++firstIt, ++secondIt){
+      EXPECT_EQ(firstIt->index(),secondIt->index());
+      EXPECT_EQ(firstIt->value(),secondIt->value());
+    }
+  }
+}
+
+TEST(MPSReader,memoryMappedEqualsStream){
+  //The memory-mapped reader should produce exactly the same problems as the stream based reader
+  std::size_t numRead = 0;
+  for(const auto& entry : std::filesystem::directory_iterator(MIPWORKSHOP2024_TEST_DATA_DIR)){
+    if(!entry.is_regular_file() || entry.path().extension() != ".mps"){
+      continue;
+    }
+    auto streamed = readMPSFile(entry.path(),MPSReadSettings{.memoryMap = false});
+    auto mapped = readMPSFile(entry.path(),MPSReadSettings{.memoryMap = true});
+    ASSERT_EQ(streamed.has_value(),mapped.has_value()) << entry.path();
+    if(!streamed.has_value()){
+      continue; //e.g. semi-continuous variables are not supported by either reader
+    }
+    expectEqualProblems(streamed.value(),mapped.value());
+    ++numRead;
+  }
+  EXPECT_GT(numRead,0);
+}
+
+TEST(MPSReader,memoryWithoutTrailingNewline){
+  std::string contents = "NAME test\nROWS\n N obj\n L c1\nCOLUMNS\n x obj 1.5 c1 2\nRHS\n rhs c1 4\nENDATA";
+  auto problem = problemFromMPSMemory(contents);
+  ASSERT_TRUE(problem.has_value());
+  EXPECT_EQ(problem->numCols(),1);
+  EXPECT_EQ(problem->numRows(),1);
+  EXPECT_EQ(problem->obj[0],1.5);
+  EXPECT_EQ(problem->rhs[0],4.0);
+}
+
+TEST(MPSReader,memoryInvalidNumber){
+  std::string contents = "NAME test\r\nROWS\r\n N obj\r\n L c1\r\nCOLUMNS\r\n x obj abc\r\nRHS\r\nENDATA\r\n";
+  auto problem = problemFromMPSMemory(contents);
+  EXPECT_FALSE(problem.has_value());
+}
+
+TEST(MPSReader,parallelColumnsEqualsSerial){
+  std::size_t numRead = 0;
+  for(const auto& entry : std::filesystem::directory_iterator(MIPWORKSHOP2024_TEST_DATA_DIR)){
+    if(!entry.is_regular_file() || entry.path().extension() != ".mps"){
+      continue;
+    }
+    auto serial = readMPSFile(entry.path(),MPSReadSettings{.memoryMap = false});
+    for(index_t numThreads : {2,3,8}){
+      auto parallel = readMPSFile(entry.path(),MPSReadSettings{.memoryMap = true, .numThreads = numThreads});
+      ASSERT_EQ(serial.has_value(),parallel.has_value()) << entry.path();
+      if(serial.has_value()){
+        expectEqualProblems(serial.value(),parallel.value());
+      }
+    }
+    ++numRead;
+  }
+  EXPECT_GT(numRead,0);
+}
+
+TEST(MPSReader,parallelColumnsMarkersAcrossChunks){
+  std::string contents = "NAME test\n"
+                         "ROWS\n N obj\n L c1\n"
+                         "COLUMNS\n"
+                         " x obj 1 c1 1\n"
+                         " MARKER 'MARKER' 'INTORG'\n"
+                         " y obj 2\n"
+                         " y c1 3\n"
+                         "* comment\n"
+                         " z c1 4\n"
+                         " MARKER 'MARKER' 'INTEND'\n"
+                         " w obj 5 c1 6\n"
+                         "RHS\n rhs c1 4\n"
+                         "ENDATA\n";
+  for(index_t numThreads : {1,2,3,4,16}){
+    auto problem = problemFromMPSMemory(contents,MPSReadSettings{.numThreads = numThreads});
+    ASSERT_TRUE(problem.has_value());
+    ASSERT_EQ(problem->numCols(),4);
+    EXPECT_EQ(problem->colType,(std::vector<VariableType>{VariableType::CONTINUOUS,VariableType::INTEGER,
+                                                           VariableType::INTEGER,VariableType::CONTINUOUS}));
+    EXPECT_EQ(problem->obj,(std::vector<double>{1,2,0,5}));
+    EXPECT_EQ(problem->matrix.numSecondarySliceEntries(1),1);
+    EXPECT_EQ(problem->colNames.find("z"),2);
+  }
+}
+
+TEST(MPSReader,parallelColumnsDuplicateColumn){
+  std::string contents = "NAME test\nROWS\n N obj\n L c1\nCOLUMNS\n x c1 1\n y c1 1\n x obj 1\nRHS\nENDATA\n";
+  for(index_t numThreads : {1,2,3}){
+    EXPECT_FALSE(problemFromMPSMemory(contents,MPSReadSettings{.numThreads = numThreads}).has_value());
+  }
+}
+
+TEST(MPSReader,namelessWithNameFile){
+  auto path = std::filesystem::path(MIPWORKSHOP2024_TEST_DATA_DIR) / "egout.mps";
+  auto nameFile = std::filesystem::temp_directory_path() / "mipworkshop2024_egout.names";
+  auto named = readMPSFile(path);
+  auto nameless = readMPSFile(path,MPSReadSettings{.keepNames = false, .nameFile = nameFile});
+  ASSERT_TRUE(named.has_value());
+  ASSERT_TRUE(nameless.has_value());
+  EXPECT_TRUE(named->hasNames());
+  EXPECT_FALSE(nameless->hasNames());
+  EXPECT_TRUE(nameless->colNames.empty());
+  EXPECT_EQ(nameless->columnName(3),"x3");
+  EXPECT_EQ(nameless->rowName(0),"c0");
+  EXPECT_EQ(nameless->findColumn("x3"),3);
+  EXPECT_EQ(nameless->findColumn("x03"),INVALID);
+  EXPECT_EQ(nameless->findColumn("c3"),INVALID);
+  EXPECT_EQ(nameless->findColumn("x" + std::to_string(nameless->numCols())),INVALID);
+
+  //Solutions of the nameless problem use the generated names, and can be translated using the name file
+  Solution solution(nameless->numCols());
+  solution.values[1] = 1.0;
+  auto external = nameless->convertSolution(solution);
+  auto converted = nameless->convertExternalSolution(external);
+  ASSERT_TRUE(converted.has_value());
+  EXPECT_EQ(converted->values,solution.values);
+
+  auto names = readNameFile(nameFile);
+  ASSERT_TRUE(names.has_value());
+  EXPECT_EQ(names->colNames,named->colNames);
+  EXPECT_EQ(names->rowNames,named->rowNames);
+  auto translated = nameless->convertSolution(solution,names->colNames);
+  EXPECT_EQ(translated.variableValues,named->convertSolution(solution).variableValues);
+
+  EXPECT_FALSE(nameless->setNames(ProblemNames{}));
+  ASSERT_TRUE(nameless->setNames(std::move(names.value())));
+  expectEqualProblems(named.value(),nameless.value());
+  std::filesystem::remove(nameFile);
+}
+
+TEST(MPSReader,writeNamelessProblem){
+  auto path = std::filesystem::path(MIPWORKSHOP2024_TEST_DATA_DIR) / "egout.mps";
+  auto nameless = readMPSFile(path,MPSReadSettings{.keepNames = false});
+  ASSERT_TRUE(nameless.has_value());
+  std::stringstream stream;
+  ASSERT_TRUE(problemToStream(nameless.value(),stream));
+  auto reread = problemFromMPSstream(stream);
+  ASSERT_TRUE(reread.has_value());
+  EXPECT_EQ(reread->colNames[3],"x3");
+  EXPECT_EQ(reread->rowNames[0],"c0");
+  EXPECT_EQ(reread->numCols(),nameless->numCols());
+  EXPECT_EQ(reread->numRows(),nameless->numRows());
+  EXPECT_EQ(reread->obj,nameless->obj);
+  EXPECT_EQ(reread->lhs,nameless->lhs);
+  EXPECT_EQ(reread->rhs,nameless->rhs);
+}
+
+TEST(MPSReader,parseDouble){
+  EXPECT_EQ(parseDouble("1.5"),1.5);
+  EXPECT_EQ(parseDouble("+2"),2.0);
+  EXPECT_EQ(parseDouble("-1e-3"),-1e-3);
+  EXPECT_EQ(parseDouble(".5"),0.5);
+  EXPECT_EQ(parseDouble("1E+30"),1e30);
+  EXPECT_EQ(parseDouble("1e400"),HUGE_VAL);
+  EXPECT_EQ(parseDouble("-inf"),-HUGE_VAL);
+  EXPECT_EQ(parseDouble("1e-400"),0.0);
+  EXPECT_FALSE(parseDouble("").has_value());
+  EXPECT_FALSE(parseDouble("abc").has_value());
+  EXPECT_FALSE(parseDouble("1.5x").has_value());
+  EXPECT_FALSE(parseDouble("+-1").has_value());
+}
+
+TEST(MPSReader,solutionFromStream){
+  std::stringstream stream("# comment\r\n=obj= 12.5\r\nx 1\r\ny  -2.5 \t(obj:3)\n\nz 1e-9");
+  auto solution = solFromStream(stream);
+  ASSERT_TRUE(solution.has_value());
+  EXPECT_EQ(solution->objectiveValue,12.5);
+  EXPECT_EQ(solution->variableValues.size(),3);
+  EXPECT_EQ(solution->variableValues.at("x"),1.0);
+  EXPECT_EQ(solution->variableValues.at("y"),-2.5);
+  EXPECT_EQ(solution->variableValues.at("z"),1e-9);
+
+  std::stringstream invalid("=obj= 1\nx one\n");
+  EXPECT_FALSE(solFromStream(invalid).has_value());
+}
+
+TEST(MPSReader,columnStorageIsSizedUpFront){
+  //The first pass over the COLUMNS section counts the columns and entries, so the storage never has to grow.
+  //Only the objective (and other free row) entries are counted but not stored in the matrix.
+  for(const auto& entry : std::filesystem::directory_iterator(MIPWORKSHOP2024_TEST_DATA_DIR)){
+    if(!entry.is_regular_file() || entry.path().extension() != ".mps"){
+      continue;
+    }
+    auto problem = readMPSFile(entry.path(),MPSReadSettings{.memoryMap = true, .numThreads = 1});
+    if(!problem.has_value()){
+      continue;
+    }
+    const auto& values = problem->matrix.getValues();
+    std::size_t numObjectiveEntries = std::count_if(problem->obj.begin(),problem->obj.end(),[](double value){
+      return value != 0.0;
+    });
+    EXPECT_EQ(problem->matrix.getPrimaryStart().capacity(),problem->numCols() + 1) << entry.path();
+    EXPECT_LE(values.capacity(),values.size() + numObjectiveEntries) << entry.path();
+    EXPECT_EQ(problem->lb.capacity(),problem->numCols()) << entry.path();
+  }
+}
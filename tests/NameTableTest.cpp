@@ -0,0 +1,91 @@
+//
+// Created by rolf on 17-10-26.
+//
+#include <gtest/gtest.h>
+#include <mipworkshop2024/NameTable.h>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST(NameTable,addAndFind){
+  NameTable table;
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(table.find("x"),INVALID);
+  constexpr index_t NUM_NAMES = 10000;
+  for(index_t i = 0; i < NUM_NAMES; ++i){
+    EXPECT_EQ(table.add("x" + std::to_string(i)),i);
+  }
+  EXPECT_EQ(table.size(),NUM_NAMES);
+  for(index_t i = 0; i < NUM_NAMES; ++i){
+    std::string name = "x" + std::to_string(i);
+    EXPECT_EQ(table.find(name),i);
+    EXPECT_EQ(table[i],name);
+    EXPECT_EQ(std::strcmp(table.c_str(i),name.c_str()),0);
+  }
+  EXPECT_EQ(table.find("y0"),INVALID);
+  EXPECT_EQ(table.add("x5"),INVALID);
+  EXPECT_EQ(table.size(),NUM_NAMES);
+}
+
+TEST(NameTable,emptyNameAndEquality){
+  NameTable first;
+  first.reserve(3,10);
+  EXPECT_EQ(first.add(""),0);
+  EXPECT_EQ(first.add("a"),1);
+  EXPECT_EQ(first.find(""),0);
+  EXPECT_EQ(first[0],"");
+
+  NameTable second;
+  second.add("");
+  EXPECT_FALSE(first == second);
+  second.add("a");
+  EXPECT_TRUE(first == second);
+
+  first.clear();
+  EXPECT_TRUE(first.empty());
+  EXPECT_EQ(first.find("a"),INVALID);
+  EXPECT_EQ(first.add("a"),0);
+}
+
+TEST(NameTable,serialization){
+  NameTable table;
+  table.add("first");
+  table.add("");
+  table.add("third");
+  std::stringstream stream;
+  ASSERT_TRUE(table.writeTo(stream));
+  auto read = NameTable::readFrom(stream);
+  ASSERT_TRUE(read.has_value());
+  EXPECT_TRUE(read.value() == table);
+  EXPECT_EQ(read->find("third"),2);
+  EXPECT_EQ(read->find(""),1);
+
+  std::string truncated = stream.str();
+  truncated.pop_back();
+  std::stringstream truncatedStream(truncated);
+  EXPECT_FALSE(NameTable::readFrom(truncatedStream).has_value());
+}
+
+TEST(NameTable,rejectsCorruptedSerialization){
+  auto serialize = [](std::vector<std::uint64_t> values, std::string_view chars){
+    std::string data(reinterpret_cast<const char*>(values.data()),values.size() * sizeof(std::uint64_t));
+    data.append(chars);
+    return data;
+  };
+  {
+    std::stringstream stream(serialize({2,4,0,2,4},std::string_view("a\0b\0",4)));
+    EXPECT_TRUE(NameTable::readFrom(stream).has_value());
+  }
+  {
+    std::stringstream stream(serialize({2,4,0,2,4},std::string_view("a\0a\0",4)));
+    EXPECT_FALSE(NameTable::readFrom(stream).has_value());
+  }
+  {
+    //Sizes which can not be allocated must not throw
+    std::stringstream stream(serialize({std::uint64_t(1) << 60,std::uint64_t(1) << 61,0},""));
+    EXPECT_FALSE(NameTable::readFrom(stream).has_value());
+  }
+}
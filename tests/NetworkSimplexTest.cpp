@@ -0,0 +1,346 @@
+//
+// Created by rolf on 17-10-26.
+//
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <random>
+#include <string>
+#include <mipworkshop2024/presolve/NetworkAdditionComplete.hpp>
+#include <mipworkshop2024/presolve/NetworkPostSolve.h>
+#include <mipworkshop2024/presolve/NetworkSimplex.h>
+
+namespace {
+using IntegralSimplex = NetworkSimplex<std::int64_t>;
+using Flow = IntegralSimplex::Flow;
+constexpr Flow INF = IntegralSimplex::INFINITE_BOUND;
+
+struct TestArc{
+  index_t tail;
+  index_t head;
+  Flow lower;
+  Flow upper;
+  double cost;
+};
+
+/// Returns the minimum cost of a circulation by enumerating all flows, or std::nullopt if there is none
+std::optional<double> bruteForceCost(index_t numNodes, const std::vector<TestArc>& arcs){
+  std::vector<Flow> flows(arcs.size());
+  for(index_t i = 0; i < arcs.size(); ++i){
+    flows[i] = arcs[i].lower;
+  }
+  std::optional<double> best;
+  while(true){
+    std::vector<Flow> excess(numNodes,0);
+    double cost = 0.0;
+    for(index_t i = 0; i < arcs.size(); ++i){
+      excess[arcs[i].tail] -= flows[i];
+      excess[arcs[i].head] += flows[i];
+      cost += static_cast<double>(flows[i]) * arcs[i].cost;
+    }
+    if(std::all_of(excess.begin(),excess.end(),[](Flow value){return value == 0;}) &&
+       (!best.has_value() || cost < *best)){
+      best = cost;
+    }
+    index_t i = 0;
+    while(i < arcs.size() && flows[i] == arcs[i].upper){
+      flows[i] = arcs[i].lower;
+      ++i;
+    }
+    if(i == arcs.size()){
+      break;
+    }
+    ++flows[i];
+  }
+  return best;
+}
+
+void expectCirculation(const IntegralSimplex& simplex, index_t numNodes, const std::vector<TestArc>& arcs){
+  std::vector<Flow> excess(numNodes,0);
+  for(index_t i = 0; i < arcs.size(); ++i){
+    Flow flow = simplex.flow(i);
+    EXPECT_TRUE(arcs[i].lower == -INF || flow >= arcs[i].lower);
+    EXPECT_TRUE(arcs[i].upper == INF || flow <= arcs[i].upper);
+    excess[arcs[i].tail] -= flow;
+    excess[arcs[i].head] += flow;
+  }
+  for(Flow value : excess){
+    EXPECT_EQ(value,0);
+  }
+}
+}
+
+TEST(NetworkSimplex,matchesBruteForce){
+  std::mt19937 generator(5);
+  for(int instance = 0; instance < 400; ++instance){
+    index_t numNodes = std::uniform_int_distribution<index_t>(1,4)(generator);
+    index_t numArcs = std::uniform_int_distribution<index_t>(1,6)(generator);
+    std::vector<TestArc> arcs;
+    IntegralSimplex simplex(numNodes);
+    for(index_t i = 0; i < numArcs; ++i){
+      TestArc arc;
+      arc.tail = std::uniform_int_distribution<index_t>(0,numNodes - 1)(generator);
+      arc.head = std::uniform_int_distribution<index_t>(0,numNodes - 1)(generator);
+      arc.lower = std::uniform_int_distribution<Flow>(-2,1)(generator);
+      arc.upper = std::uniform_int_distribution<Flow>(arc.lower,2)(generator);
+      arc.cost = std::uniform_int_distribution<int>(-3,3)(generator);
+      arcs.push_back(arc);
+      simplex.addArc(arc.tail,arc.head,arc.lower,arc.upper,arc.cost);
+    }
+    std::optional<double> expected = bruteForceCost(numNodes,arcs);
+    IntegralSimplex::Status status = simplex.solve();
+    if(!expected.has_value()){
+      EXPECT_EQ(status,IntegralSimplex::Status::INFEASIBLE) << instance;
+      continue;
+    }
+    ASSERT_EQ(status,IntegralSimplex::Status::OPTIMAL) << instance;
+    EXPECT_DOUBLE_EQ(simplex.totalCost(),*expected) << instance;
+    expectCirculation(simplex,numNodes,arcs);
+  }
+}
+
+TEST(NetworkSimplex,infiniteBounds){
+  {
+    //A free arc, which has to carry the flow of the bounded arc
+    std::vector<TestArc> arcs{{0,1,-INF,INF,-2.0},{1,0,3,5,1.0}};
+    IntegralSimplex simplex(2);
+    for(const TestArc& arc : arcs){
+      simplex.addArc(arc.tail,arc.head,arc.lower,arc.upper,arc.cost);
+    }
+    ASSERT_EQ(simplex.solve(),IntegralSimplex::Status::OPTIMAL);
+    EXPECT_EQ(simplex.flow(0),5);
+    EXPECT_EQ(simplex.flow(1),5);
+    EXPECT_DOUBLE_EQ(simplex.totalCost(),-5.0);
+    expectCirculation(simplex,2,arcs);
+  }
+  {
+    //An arc without lower bound
+    std::vector<TestArc> arcs{{0,1,-INF,4,1.0},{1,2,-10,10,0.0},{2,0,-7,INF,0.0}};
+    IntegralSimplex simplex(3);
+    for(const TestArc& arc : arcs){
+      simplex.addArc(arc.tail,arc.head,arc.lower,arc.upper,arc.cost);
+    }
+    ASSERT_EQ(simplex.solve(),IntegralSimplex::Status::OPTIMAL);
+    EXPECT_EQ(simplex.flow(0),-7);
+    expectCirculation(simplex,3,arcs);
+  }
+  {
+    //A cycle of negative cost without upper bounds
+    IntegralSimplex simplex(3);
+    simplex.addArc(0,1,0,INF,-1.0);
+    simplex.addArc(1,2,1,INF,0.0);
+    simplex.addArc(2,0,-INF,INF,0.0);
+    EXPECT_EQ(simplex.solve(),IntegralSimplex::Status::UNBOUNDED);
+  }
+  {
+    IntegralSimplex simplex(2);
+    simplex.addArc(0,1,1,INF,1.0);
+    simplex.addArc(1,0,-INF,0,1.0);
+    EXPECT_EQ(simplex.solve(),IntegralSimplex::Status::INFEASIBLE);
+  }
+}
+
+TEST(NetworkSimplex,postSolveNetworkSubmatrix){
+  Problem problem;
+  problem.sense = ObjSense::MAXIMIZE;
+  problem.addRow("r0",-infinity,1.5);
+  problem.addRow("r1",-infinity,2.0);
+  problem.addRow("r2",-1.0,infinity);
+  problem.addColumn("x0",{0,2},{1.0,1.0},VariableType::CONTINUOUS,0.0,1.0);
+  problem.addColumn("x1",{0,1},{1.0,1.0},VariableType::CONTINUOUS,0.0,1.0);
+  problem.addColumn("x2",{1,2},{1.0,-1.0},VariableType::CONTINUOUS,0.0,1.0);
+  problem.addColumn("x3",{1},{1.0},VariableType::BINARY,0.0,1.0);
+  problem.addColumn("x4",{},{},VariableType::CONTINUOUS,-1.0,2.0);
+  problem.obj = {1.0,1.0,1.0,0.0,-1.0};
+
+  TotallyUnimodularColumnSubmatrix submatrix;
+  submatrix.submatRows = {0,1,2};
+  submatrix.submatColumns = {0,1,2,4};
+  submatrix.implyingColumns = {3};
+
+  Solution solution;
+  solution.values = {0.5,0.5,0.5,1.0,0.5};
+  ASSERT_TRUE(solveNetworkTUSubmatrix(problem,submatrix,solution));
+  std::vector<double> expected{1.0,0.0,1.0,1.0,-1.0};
+  EXPECT_EQ(solution.values,expected);
+
+  //With x2 + x0 instead of x0 - x2 the submatrix is not totally unimodular, so it can not be a network matrix
+  Problem odd = problem;
+  odd.matrix = SparseMatrix();
+  odd.matrix.setNumSecondary(3);
+  odd.matrix.addPrimaryVector({0,2},{1.0,1.0});
+  odd.matrix.addPrimaryVector({0,1},{1.0,1.0});
+  odd.matrix.addPrimaryVector({1,2},{1.0,1.0});
+  odd.matrix.addPrimaryVector({1},{1.0});
+  odd.matrix.addPrimaryVector({},{});
+  Solution oddSolution;
+  oddSolution.values = {0.5,0.5,0.5,1.0,0.5};
+  EXPECT_FALSE(solveNetworkTUSubmatrix(odd,submatrix,oddSolution));
+  EXPECT_EQ(oddSolution.values,(std::vector<double>{0.5,0.5,0.5,1.0,0.5}));
+}
+
+TEST(NetworkSimplex,fractionalFlowsMatchIntegralFlows){
+  using FractionalSimplex = NetworkSimplex<double>;
+  std::mt19937 generator(11);
+  for(int instance = 0; instance < 400; ++instance){
+    index_t numNodes = std::uniform_int_distribution<index_t>(2,5)(generator);
+    index_t numArcs = std::uniform_int_distribution<index_t>(1,8)(generator);
+    IntegralSimplex integral(numNodes);
+    FractionalSimplex fractional(numNodes);
+    std::vector<TestArc> arcs;
+    for(index_t i = 0; i < numArcs; ++i){
+      TestArc arc;
+      arc.tail = std::uniform_int_distribution<index_t>(0,numNodes - 1)(generator);
+      arc.head = std::uniform_int_distribution<index_t>(0,numNodes - 1)(generator);
+      arc.lower = generator() % 4 == 0 ? -INF : std::uniform_int_distribution<Flow>(-2,1)(generator);
+      arc.upper = generator() % 4 == 0 ? INF : std::uniform_int_distribution<Flow>(std::max<Flow>(arc.lower,-2),2)(generator);
+      arc.cost = std::uniform_int_distribution<int>(-3,3)(generator);
+      arcs.push_back(arc);
+      integral.addArc(arc.tail,arc.head,arc.lower,arc.upper,arc.cost);
+      fractional.addArc(arc.tail,arc.head,
+                        arc.lower == -INF ? -FractionalSimplex::INFINITE_BOUND : static_cast<double>(arc.lower),
+                        arc.upper == INF ? FractionalSimplex::INFINITE_BOUND : static_cast<double>(arc.upper),
+                        arc.cost);
+    }
+    Flow supply = std::uniform_int_distribution<Flow>(0,3)(generator);
+    index_t source = std::uniform_int_distribution<index_t>(0,numNodes - 1)(generator);
+    index_t sink = std::uniform_int_distribution<index_t>(0,numNodes - 1)(generator);
+    integral.addSupply(source,supply);
+    integral.addSupply(sink,-supply);
+    fractional.addSupply(source,static_cast<double>(supply));
+    fractional.addSupply(sink,-static_cast<double>(supply));
+
+    IntegralSimplex::Status status = integral.solve();
+    FractionalSimplex::Status fractionalStatus = fractional.solve();
+    EXPECT_EQ(static_cast<int>(status),static_cast<int>(fractionalStatus)) << instance;
+    if(status != IntegralSimplex::Status::OPTIMAL || fractionalStatus != FractionalSimplex::Status::OPTIMAL){
+      continue;
+    }
+    EXPECT_DOUBLE_EQ(integral.totalCost(),fractional.totalCost()) << instance;
+    for(index_t i = 0; i < numArcs; ++i){
+      const TestArc& arc = arcs[i];
+      double reducedCost = arc.cost + fractional.potential(arc.tail) - fractional.potential(arc.head);
+      double flow = fractional.flow(i);
+      if(arc.upper == INF || flow < static_cast<double>(arc.upper) - 1e-9){
+        EXPECT_GE(reducedCost,-1e-9) << instance;
+      }
+      if(arc.lower == -INF || flow > static_cast<double>(arc.lower) + 1e-9){
+        EXPECT_LE(reducedCost,1e-9) << instance;
+      }
+    }
+  }
+}
+
+TEST(NetworkSimplex,postSolveTransposedNetworkSubmatrix){
+  //The rows are the potential differences over all edges of K5, for the potentials x1,...,x4 relative to node 0.
+  //The transpose is the network matrix of K5, which is not cographic, so the matrix itself is not a network matrix.
+  constexpr index_t NUM_COLUMNS = 4;
+  std::vector<std::pair<index_t,index_t>> edges;
+  for(index_t j = 1; j <= NUM_COLUMNS; ++j){
+    for(index_t i = 0; i < j; ++i){
+      edges.emplace_back(i,j);
+    }
+  }
+  std::vector<std::vector<index_t>> columnRows(NUM_COLUMNS);
+  std::vector<std::vector<double>> columnValues(NUM_COLUMNS);
+  for(index_t row = 0; row < edges.size(); ++row){
+    auto [tail,head] = edges[row];
+    if(tail != 0){
+      columnRows[tail - 1].push_back(row);
+      columnValues[tail - 1].push_back(-1.0);
+    }
+    columnRows[head - 1].push_back(row);
+    columnValues[head - 1].push_back(1.0);
+  }
+  {
+    SparseMatrix matrix;
+    matrix.setNumSecondary(edges.size());
+    for(index_t i = 0; i < NUM_COLUMNS; ++i){
+      matrix.addPrimaryVector(columnRows[i],columnValues[i]);
+    }
+    NetworkAddition addition(edges.size(),NUM_COLUMNS,Submatrix::INIT_NONE,false);
+    bool allAdded = true;
+    for(index_t i = 0; i < NUM_COLUMNS; ++i){
+      allAdded = allAdded && addition.tryAddCol(i,matrix.getPrimaryVector(i));
+    }
+    EXPECT_FALSE(allAdded);
+  }
+
+  std::mt19937 generator(3);
+  int numSolved = 0;
+  for(int instance = 0; instance < 200; ++instance){
+    Problem problem;
+    problem.sense = generator() % 2 == 0 ? ObjSense::MINIMIZE : ObjSense::MAXIMIZE;
+    std::vector<double> lhs;
+    std::vector<double> rhs;
+    for(index_t row = 0; row < edges.size(); ++row){
+      double lower = generator() % 3 == 0 ? -infinity : std::uniform_int_distribution<int>(-3,1)(generator) - 0.5;
+      double upper = generator() % 3 == 0 ? infinity : std::uniform_int_distribution<int>(-1,3)(generator);
+      lhs.push_back(lower);
+      rhs.push_back(upper);
+      problem.addRow("r" + std::to_string(row),lower,upper);
+    }
+    for(index_t i = 0; i < NUM_COLUMNS; ++i){
+      problem.addColumn("x" + std::to_string(i),columnRows[i],columnValues[i],VariableType::CONTINUOUS,-2.0,2.0);
+      problem.obj[i] = std::uniform_int_distribution<int>(-2,2)(generator);
+    }
+
+    std::optional<double> best;
+    std::vector<int> values(NUM_COLUMNS,-2);
+    while(true){
+      bool feasible = true;
+      for(index_t row = 0; row < edges.size(); ++row){
+        auto [tail,head] = edges[row];
+        int activity = values[head - 1] - (tail == 0 ? 0 : values[tail - 1]);
+        feasible = feasible && activity >= lhs[row] && activity <= rhs[row];
+      }
+      if(feasible){
+        double objective = 0.0;
+        for(index_t i = 0; i < NUM_COLUMNS; ++i){
+          objective += problem.obj[i] * values[i];
+        }
+        if(!best.has_value() || (problem.sense == ObjSense::MINIMIZE ? objective < *best : objective > *best)){
+          best = objective;
+        }
+      }
+      index_t i = 0;
+      while(i < NUM_COLUMNS && values[i] == 2){
+        values[i] = -2;
+        ++i;
+      }
+      if(i == NUM_COLUMNS){
+        break;
+      }
+      ++values[i];
+    }
+
+    TotallyUnimodularColumnSubmatrix submatrix;
+    for(index_t row = 0; row < edges.size(); ++row){
+      submatrix.submatRows.push_back(row);
+    }
+    for(index_t i = 0; i < NUM_COLUMNS; ++i){
+      submatrix.submatColumns.push_back(i);
+    }
+    Solution solution;
+    solution.values.assign(NUM_COLUMNS,0.5);
+    bool solved = solveNetworkTUSubmatrix(problem,submatrix,solution);
+    ASSERT_EQ(solved,best.has_value()) << instance;
+    if(!solved){
+      continue;
+    }
+    ++numSolved;
+    double objective = 0.0;
+    for(index_t i = 0; i < NUM_COLUMNS; ++i){
+      EXPECT_EQ(solution.values[i],std::round(solution.values[i])) << instance;
+      objective += problem.obj[i] * solution.values[i];
+    }
+    EXPECT_DOUBLE_EQ(objective,*best) << instance;
+    for(index_t row = 0; row < edges.size(); ++row){
+      auto [tail,head] = edges[row];
+      double activity = solution.values[head - 1] - (tail == 0 ? 0.0 : solution.values[tail - 1]);
+      EXPECT_TRUE(activity >= lhs[row] && activity <= rhs[row]) << instance;
+    }
+  }
+  EXPECT_GT(numSolved,0);
+}
@@ -0,0 +1,80 @@
+//
+// Created by rolf on 17-10-26.
+//
+#include <gtest/gtest.h>
+#include <sstream>
+#include <mipworkshop2024/IO.h>
+
+namespace {
+PostSolveStack testStack(){
+  PostSolveStack stack;
+  TotallyUnimodularColumnSubmatrix sorted;
+  for(index_t i = 0; i < 1000; ++i){
+    sorted.submatRows.push_back(3 * i);
+    sorted.submatColumns.push_back(1000 + 7 * i);
+  }
+  sorted.implyingColumns = {0, 5, 200000};
+  stack.totallyUnimodularColumnSubmatrix(sorted);
+
+  TotallyUnimodularColumnSubmatrix unsorted;
+  unsorted.submatRows = {10, 2, 2, 0, INVALID - 1, 1};
+  unsorted.submatColumns = {5};
+  stack.totallyUnimodularColumnSubmatrix(unsorted);
+  stack.totallyUnimodularColumnSubmatrix({});
+  return stack;
+}
+
+void expectEqualStacks(const PostSolveStack& first, const PostSolveStack& second){
+  EXPECT_EQ(first.containsTUSubmatrix,second.containsTUSubmatrix);
+  ASSERT_EQ(first.reductions.size(),second.reductions.size());
+  for(std::size_t i = 0; i < first.reductions.size(); ++i){
+    EXPECT_EQ(first.reductions[i].submatRows,second.reductions[i].submatRows);
+    EXPECT_EQ(first.reductions[i].implyingColumns,second.reductions[i].implyingColumns);
+    EXPECT_EQ(first.reductions[i].submatColumns,second.reductions[i].submatColumns);
+  }
+}
+}
+
+TEST(PostSolveStack,binaryRoundTrip){
+  auto stack = testStack();
+  std::stringstream binary;
+  ASSERT_TRUE(postSolveStackToStream(stack,binary,PostSolveStackFormat::BINARY));
+  auto read = postSolveStackFromStream(binary);
+  ASSERT_TRUE(read.has_value());
+  expectEqualStacks(stack,read.value());
+
+  std::stringstream json;
+  ASSERT_TRUE(postSolveStackToStream(stack,json,PostSolveStackFormat::JSON));
+  EXPECT_LT(binary.str().size(),json.str().size() / 3);
+}
+
+TEST(PostSolveStack,jsonStillReadable){
+  auto stack = testStack();
+  std::stringstream json;
+  ASSERT_TRUE(postSolveStackToStream(stack,json,PostSolveStackFormat::JSON));
+  auto read = postSolveStackFromStream(json);
+  ASSERT_TRUE(read.has_value());
+  expectEqualStacks(stack,read.value());
+
+  std::stringstream invalid("{\"reductions\": [");
+  EXPECT_FALSE(postSolveStackFromStream(invalid).has_value());
+}
+
+TEST(PostSolveStack,binaryRejectsCorruption){
+  std::stringstream stream;
+  ASSERT_TRUE(postSolveStackToStream(testStack(),stream));
+  std::string contents = stream.str();
+
+  std::string flipped = contents;
+  flipped[flipped.size() / 2] ^= 0x10;
+  std::stringstream flippedStream(flipped);
+  EXPECT_FALSE(postSolveStackFromStream(flippedStream).has_value());
+
+  std::stringstream truncated(contents.substr(0,contents.size() - 1));
+  EXPECT_FALSE(postSolveStackFromStream(truncated).has_value());
+
+  std::string wrongVersion = contents;
+  wrongVersion[8] += 1;
+  std::stringstream wrongVersionStream(wrongVersion);
+  EXPECT_FALSE(postSolveStackFromStream(wrongVersionStream).has_value());
+}
@@ -0,0 +1,80 @@
+//
+// Created by rolf on 17-10-26.
+//
+#include <gtest/gtest.h>
+#include <mipworkshop2024/IO.h>
+#include <mipworkshop2024/Problem.h>
+
+namespace {
+void expectRowMatrixOf(const SparseMatrix& rowMatrix, const Problem& problem){
+  SparseMatrix expected = problem.matrix.transposedFormat();
+  EXPECT_EQ(rowMatrix.numRows(),problem.numRows());
+  EXPECT_EQ(rowMatrix.numCols(),problem.numCols());
+  EXPECT_EQ(rowMatrix.getPrimaryStart(),expected.getPrimaryStart());
+  EXPECT_EQ(rowMatrix.getSecondaryIndex(),expected.getSecondaryIndex());
+  EXPECT_EQ(rowMatrix.getValues(),expected.getValues());
+}
+}
+
+TEST(Problem,rowMatrixIsCachedUntilModified){
+  auto problem = readMPSFile(std::filesystem::path(MIPWORKSHOP2024_TEST_DATA_DIR) / "egout.mps");
+  ASSERT_TRUE(problem.has_value());
+
+  auto rowMatrix = problem->rowMatrix();
+  expectRowMatrixOf(*rowMatrix,problem.value());
+  EXPECT_EQ(problem->rowMatrix(),rowMatrix);
+
+  //Copies share the row matrix, until one of them is modified
+  Problem copy = problem.value();
+  EXPECT_EQ(copy.rowMatrix(),rowMatrix);
+  copy.addRow("extraRow",0.0,1.0);
+  copy.addColumn("extraColumn",{0,copy.numRows()-1},{1.0,-1.0},VariableType::BINARY,0.0,1.0);
+  auto copyRowMatrix = copy.rowMatrix();
+  EXPECT_NE(copyRowMatrix,rowMatrix);
+  expectRowMatrixOf(*copyRowMatrix,copy);
+  EXPECT_EQ(problem->rowMatrix(),rowMatrix);
+
+  //Scaling changes the values, so the row matrix is rebuilt; the old one stays valid for its holders
+  std::vector<double> originalValues = rowMatrix->getValues();
+  std::vector<double> rowScale(problem->numRows(),2.0);
+  //Only continuous columns may be scaled
+  std::vector<double> colScale(problem->numCols(),1.0);
+  for(index_t i = 0; i < problem->numCols(); ++i){
+    if(problem->colType[i] == VariableType::CONTINUOUS){
+      colScale[i] = 0.5;
+    }
+  }
+  problem->scale(rowScale,colScale);
+  auto scaledRowMatrix = problem->rowMatrix();
+  EXPECT_NE(scaledRowMatrix,rowMatrix);
+  expectRowMatrixOf(*scaledRowMatrix,problem.value());
+  EXPECT_EQ(rowMatrix->getValues(),originalValues);
+
+  //Replacing the matrix as a whole is noticed as well
+  problem->matrix = copy.matrix;
+  EXPECT_NE(problem->rowMatrix(),scaledRowMatrix);
+  expectRowMatrixOf(*problem->rowMatrix(),copy);
+}
+
+TEST(Problem,duplicateNamesAreRejected){
+  Problem problem;
+  problem.addRow("row",0.0,1.0);
+  EXPECT_THROW(problem.addRow("row",0.0,2.0),std::invalid_argument);
+  EXPECT_EQ(problem.numRows(),1);
+
+  problem.addColumn("column",{0},{1.0},VariableType::BINARY,0.0,1.0);
+  EXPECT_THROW(problem.addColumn("column",{0},{2.0},VariableType::CONTINUOUS,0.0,2.0),std::invalid_argument);
+  EXPECT_EQ(problem.numCols(),1);
+  EXPECT_EQ(problem.lb.size(),1);
+
+  problem.appendColumnNonzero(0,3.0);
+  EXPECT_THROW(problem.finishColumn("column",VariableType::CONTINUOUS,0.0,1.0),std::invalid_argument);
+  EXPECT_EQ(problem.numCols(),1);
+
+  //Later names are still stored under the right index
+  problem.addRow("secondRow",0.0,1.0);
+  EXPECT_EQ(problem.finishColumn("secondColumn",VariableType::CONTINUOUS,0.0,1.0),1);
+  EXPECT_EQ(problem.rowName(1),"secondRow");
+  EXPECT_EQ(problem.columnName(1),"secondColumn");
+  EXPECT_EQ(problem.colNames.find("secondColumn"),1);
+}
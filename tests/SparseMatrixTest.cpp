@@ -0,0 +1,98 @@
+//
+// Created by rolf on 17-10-26.
+//
+#include <gtest/gtest.h>
+#include <random>
+#include <mipworkshop2024/SparseMatrix.h>
+
+namespace {
+/// Column-wise matrix with random sparsity; some rows and columns stay empty
+SparseMatrix randomMatrix(index_t numRows, index_t numCols, double density, unsigned int seed){
+  std::mt19937 generator(seed);
+  std::bernoulli_distribution nonzero(density);
+  std::uniform_real_distribution<double> value(-10.0,10.0);
+  SparseMatrix matrix;
+  matrix.setNumSecondary(numRows);
+  for(index_t col = 0; col < numCols; ++col){
+    if(col % 7 == 3){
+      matrix.finishPrimaryVector();
+      continue;
+    }
+    for(index_t row = 0; row < numRows; ++row){
+      if(row % 11 != 5 && nonzero(generator)){
+        matrix.appendNonzero(row,value(generator));
+      }
+    }
+    matrix.finishPrimaryVector();
+  }
+  return matrix;
+}
+
+void expectSameMatrix(const SparseMatrix& first, const SparseMatrix& second){
+  EXPECT_EQ(first.numRows(),second.numRows());
+  EXPECT_EQ(first.numCols(),second.numCols());
+  EXPECT_EQ(first.getPrimaryStart(),second.getPrimaryStart());
+  EXPECT_EQ(first.getSecondaryIndex(),second.getSecondaryIndex());
+  EXPECT_EQ(first.getValues(),second.getValues());
+}
+}
+
+TEST(SparseMatrix,parallelTransposeMatchesSerial){
+  for(const SparseMatrix& matrix : {randomMatrix(600,1500,0.2,1),randomMatrix(20,40'000,0.3,2),randomMatrix(3,5,0.5,3)}){
+    SparseMatrix serial = matrix.transposedFormat(1);
+    for(index_t numThreads : {2,3,8}){
+      expectSameMatrix(matrix.transposedFormat(numThreads),serial);
+    }
+    expectSameMatrix(serial.transposedFormat(4),matrix);
+  }
+}
+
+TEST(SparseMatrix,interleavedCopyHasSameSlices){
+  SparseMatrix matrix = randomMatrix(50,80,0.2,4);
+  InterleavedSparseMatrix interleaved(matrix);
+  ASSERT_EQ(interleaved.numRows(),matrix.numRows());
+  ASSERT_EQ(interleaved.numCols(),matrix.numCols());
+  for(index_t col = 0; col < matrix.numCols(); ++col){
+    EXPECT_EQ(interleaved.numSecondarySliceEntries(col),matrix.numSecondarySliceEntries(col));
+    auto entry = interleaved.getPrimaryVector(col).begin();
+    for(const Nonzero& nonzero : matrix.getPrimaryVector(col)){
+      EXPECT_EQ(entry->index(),nonzero.index());
+      EXPECT_EQ(entry->value(),nonzero.value());
+      ++entry;
+    }
+    EXPECT_EQ(entry,interleaved.getPrimaryVector(col).end());
+  }
+}
+
+TEST(SparseMatrix,signPatternMatchesValues){
+  SparseMatrix matrix;
+  matrix.setNumSecondary(5);
+  //Spread the entries over more than one word of the bitsets
+  for(index_t col = 0; col < 40; ++col){
+    for(index_t row = 0; row < 5; ++row){
+      if((row + col) % 3 != 0){
+        double value = (col % 7 == 0 && row == 2) ? 2.5 : (row + col) % 2 == 0 ? 1.0 : -1.0;
+        matrix.appendNonzero(row,value);
+      }
+    }
+    matrix.finishPrimaryVector();
+  }
+  SignPatternMatrix pattern(matrix);
+  ASSERT_EQ(pattern.numRows(),matrix.numRows());
+  ASSERT_EQ(pattern.numCols(),matrix.numCols());
+  for(index_t col = 0; col < matrix.numCols(); ++col){
+    auto slice = pattern.getPrimaryVector(col);
+    EXPECT_EQ(slice.size(),matrix.numSecondarySliceEntries(col));
+    bool allUnit = true;
+    auto entry = slice.begin();
+    for(const Nonzero& nonzero : matrix.getPrimaryVector(col)){
+      EXPECT_EQ((*entry).index(),nonzero.index());
+      EXPECT_EQ(isNegativeEntry(*entry),isNegativeEntry(nonzero));
+      EXPECT_EQ(isUnitEntry(*entry),isUnitEntry(nonzero));
+      allUnit = allUnit && isUnitEntry(nonzero);
+      ++entry;
+    }
+    EXPECT_EQ(entry,slice.end());
+    EXPECT_EQ(slice.allUnit(),allUnit);
+  }
+}
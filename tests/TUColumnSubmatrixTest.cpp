@@ -0,0 +1,430 @@
+//
+// Created by rolf on 17-10-26.
+//
+#include <gtest/gtest.h>
+#include <mipworkshop2024/ConcurrentUnionFind.h>
+#include <mipworkshop2024/IO.h>
+#include <mipworkshop2024/Parallel.h>
+#include <mipworkshop2024/SparseMatrix.h>
+#include <mipworkshop2024/presolve/NetworkAdditionComplete.hpp>
+#include <mipworkshop2024/presolve/TUColumnSubmatrix.h>
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <numeric>
+#include <random>
+
+TEST(ConcurrentUnionFind,representativeIsSmallestElement){
+  constexpr index_t SIZE = 100'000;
+  ConcurrentUnionFind unionFind(SIZE);
+  //Merge all elements with the same residue modulo 7, from the back, concurrently
+  parallelFor(SIZE - 7,4,[&](index_t task){
+    index_t element = SIZE - 1 - task;
+    unionFind.unite(element,element - 7);
+  });
+  for(index_t i = 0; i < SIZE; ++i){
+    EXPECT_EQ(unionFind.find(i),i % 7);
+  }
+}
+
+TEST(TUColumnSubmatrixFinder,threadsDoNotChangeResult){
+  for(const auto& entry : std::filesystem::directory_iterator(MIPWORKSHOP2024_TEST_DATA_DIR)){
+    if(!entry.is_regular_file() || entry.path().extension() != ".mps"){
+      continue;
+    }
+    auto original = readMPSFile(entry.path());
+    if(!original.has_value()){
+      continue;
+    }
+
+    std::vector<std::vector<TotallyUnimodularColumnSubmatrix>> results;
+    std::vector<std::vector<DetectionStatistics>> statistics;
+    //With 8 threads, the network strategies also test their components on multiple threads
+    for(index_t numThreads : {1,3,8}){
+      Problem problem = original.value();
+      TUColumnSubmatrixFinder finder(problem,TUSettings{
+          .doDowngrade = true,
+          .writeType = VariableType::CONTINUOUS,
+          .dynamic = false,
+          .numThreads = numThreads});
+      results.push_back(finder.computeTUSubmatrices());
+      statistics.push_back(finder.statistics());
+    }
+    for(std::size_t run = 1; run < statistics.size(); ++run){
+      ASSERT_EQ(statistics[0].size(),statistics[run].size());
+      for(std::size_t i = 0; i < statistics[0].size(); ++i){
+        EXPECT_EQ(statistics[0][i].method,statistics[run][i].method);
+        EXPECT_EQ(statistics[0][i].numRows,statistics[run][i].numRows) << entry.path();
+        EXPECT_EQ(statistics[0][i].numColumns,statistics[run][i].numColumns) << entry.path();
+        EXPECT_EQ(statistics[0][i].numErasedComponents,statistics[run][i].numErasedComponents) << entry.path();
+        EXPECT_EQ(statistics[0][i].numComponents,statistics[run][i].numComponents) << entry.path();
+      }
+    }
+    for(std::size_t run = 1; run < results.size(); ++run){
+      ASSERT_EQ(results[0].size(),results[run].size()) << entry.path();
+      for(std::size_t i = 0; i < results[0].size(); ++i){
+        EXPECT_EQ(results[0][i].submatRows,results[run][i].submatRows) << entry.path();
+        EXPECT_EQ(results[0][i].submatColumns,results[run][i].submatColumns) << entry.path();
+        EXPECT_EQ(results[0][i].implyingColumns,results[run][i].implyingColumns) << entry.path();
+      }
+    }
+  }
+}
+
+TEST(TUColumnSubmatrixFinder,targetColumnsCancelsRemainingStrategies){
+  for(const auto& entry : std::filesystem::directory_iterator(MIPWORKSHOP2024_TEST_DATA_DIR)){
+    if(!entry.is_regular_file() || entry.path().extension() != ".mps"){
+      continue;
+    }
+    auto original = readMPSFile(entry.path());
+    if(!original.has_value()){
+      continue;
+    }
+    Problem problem = original.value();
+    TUColumnSubmatrixFinder finder(problem,TUSettings{
+        .doDowngrade = true,
+        .writeType = VariableType::CONTINUOUS,
+        .dynamic = false,
+        .numThreads = 1,
+        .targetColumns = 1});
+    auto result = finder.computeTUSubmatrices();
+    //Serially, the strategies run in order, so any submatrix found by the first strategy cancels the other three
+    auto statistics = finder.statistics();
+    ASSERT_FALSE(statistics.empty());
+    EXPECT_EQ(statistics.size(),statistics.front().numColumns >= 1 ? 1 : 4) << entry.path();
+    EXPECT_EQ(result.empty(),statistics.front().numColumns == 0 && statistics.size() == 4 &&
+        std::all_of(statistics.begin(),statistics.end(),[](const auto& stats){ return stats.numColumns == 0;}))
+        << entry.path();
+  }
+}
+
+TEST(NetworkAddition,mergeDisjointDecompositions){
+  //Columns which are intervals of rows form a network matrix. The first columns stay within one of two blocks of rows,
+  //the later columns may connect the blocks or skip rows, so that some of them can not be added.
+  constexpr index_t BLOCK_ROWS = 20;
+  constexpr index_t NUM_ROWS = 2 * BLOCK_ROWS;
+  constexpr index_t BLOCK_COLUMNS = 30;
+  constexpr index_t NUM_COLUMNS = 2 * BLOCK_COLUMNS + 40;
+  std::mt19937 generator(42);
+  SparseMatrix matrix;
+  matrix.setNumSecondary(NUM_ROWS);
+  for(index_t column = 0; column < NUM_COLUMNS; ++column){
+    index_t first = 0;
+    index_t last = NUM_ROWS;
+    if(column < 2 * BLOCK_COLUMNS){
+      first = column < BLOCK_COLUMNS ? 0 : BLOCK_ROWS;
+      last = first + BLOCK_ROWS;
+    }
+    index_t start = std::uniform_int_distribution<index_t>(first,last - 2)(generator);
+    index_t end = std::uniform_int_distribution<index_t>(start + 1,last)(generator);
+    bool skipRow = column >= 2 * BLOCK_COLUMNS && end - start > 2 && generator() % 2 == 0;
+    for(index_t row = start; row < end; ++row){
+      if(skipRow && row == start + 1){
+        continue;
+      }
+      matrix.appendNonzero(row,row % 3 == 0 ? -1.0 : 1.0);
+    }
+    matrix.finishPrimaryVector();
+  }
+
+  for(bool transposed : {false,true}){
+    NetworkAddition serial(NUM_ROWS,NUM_COLUMNS,Submatrix::INIT_NONE,transposed);
+    NetworkAddition merged(NUM_ROWS,NUM_COLUMNS,Submatrix::INIT_NONE,transposed);
+    {
+      NetworkAddition second(NUM_ROWS,NUM_COLUMNS,Submatrix::INIT_NONE,transposed);
+      for(index_t column = 0; column < 2 * BLOCK_COLUMNS; ++column){
+        bool added = serial.tryAddCol(column,matrix.getPrimaryVector(column));
+        NetworkAddition& block = column < BLOCK_COLUMNS ? merged : second;
+        EXPECT_EQ(block.tryAddCol(column,matrix.getPrimaryVector(column)),added);
+      }
+      merged.merge(second);
+    }
+    EXPECT_EQ(merged.statistics().numComponents,serial.statistics().numComponents);
+    for(index_t column = 2 * BLOCK_COLUMNS; column < NUM_COLUMNS; ++column){
+      EXPECT_EQ(merged.tryAddCol(column,matrix.getPrimaryVector(column)),
+                serial.tryAddCol(column,matrix.getPrimaryVector(column))) << column;
+    }
+    Submatrix serialSubmatrix = serial.createSubmatrix(NUM_ROWS,NUM_COLUMNS);
+    Submatrix mergedSubmatrix = merged.createSubmatrix(NUM_ROWS,NUM_COLUMNS);
+    EXPECT_EQ(mergedSubmatrix.rows,serialSubmatrix.rows);
+    EXPECT_EQ(mergedSubmatrix.columns,serialSubmatrix.columns);
+  }
+}
+
+TEST(NetworkAddition,batchMatchesSingleAdditions){
+  //Random ±1 columns, which are mostly not network, so that the batch has to both accept and reject columns
+  constexpr index_t NUM_ROWS = 30;
+  constexpr index_t NUM_COLUMNS = 200;
+  std::mt19937 generator(7);
+  SparseMatrix matrix;
+  matrix.setNumSecondary(NUM_ROWS);
+  for(index_t column = 0; column < NUM_COLUMNS; ++column){
+    index_t start = std::uniform_int_distribution<index_t>(0,NUM_ROWS - 2)(generator);
+    index_t end = std::uniform_int_distribution<index_t>(start + 1,std::min(NUM_ROWS,start + 6))(generator);
+    for(index_t row = start; row < end; ++row){
+      if(row == start || generator() % 4 != 0){
+        matrix.appendNonzero(row,generator() % 2 == 0 ? -1.0 : 1.0);
+      }
+    }
+    matrix.finishPrimaryVector();
+  }
+  SignPatternMatrix signs(matrix);
+  std::vector<index_t> candidates(NUM_COLUMNS);
+  for(index_t column = 0; column < NUM_COLUMNS; ++column){
+    candidates[column] = column;
+  }
+  std::shuffle(candidates.begin(),candidates.end(),generator);
+
+  for(bool transposed : {false,true}){
+    NetworkAddition single(NUM_ROWS,NUM_COLUMNS,Submatrix::INIT_NONE,transposed);
+    NetworkAddition batch(NUM_ROWS,NUM_COLUMNS,Submatrix::INIT_NONE,transposed);
+    std::vector<std::uint64_t> accepted;
+    index_t numAdded = 0;
+    //Split into uneven batches, to check that later batches continue on the decomposition of the earlier ones
+    for(std::size_t first = 0; first < candidates.size(); first += 70){
+      auto candidateBatch = std::span<const index_t>(candidates).subspan(first,std::min<std::size_t>(70,candidates.size() - first));
+      index_t numBatchAdded = batch.tryAddCols(signs,candidateBatch,accepted);
+      ASSERT_EQ(accepted.size(),(candidateBatch.size() + 63) / 64);
+      index_t numSingleAdded = 0;
+      for(std::size_t i = 0; i < candidateBatch.size(); ++i){
+        bool added = single.tryAddCol(candidateBatch[i],matrix.getPrimaryVector(candidateBatch[i]));
+        EXPECT_EQ(((accepted[i / 64] >> (i % 64)) & 1) != 0,added) << candidateBatch[i];
+        numSingleAdded += added;
+      }
+      EXPECT_EQ(numBatchAdded,numSingleAdded);
+      numAdded += numBatchAdded;
+    }
+    EXPECT_GT(numAdded,0);
+    EXPECT_LT(numAdded,NUM_COLUMNS);
+    Submatrix singleSubmatrix = single.createSubmatrix(NUM_ROWS,NUM_COLUMNS);
+    Submatrix batchSubmatrix = batch.createSubmatrix(NUM_ROWS,NUM_COLUMNS);
+    EXPECT_EQ(batchSubmatrix.rows,singleSubmatrix.rows);
+    EXPECT_EQ(batchSubmatrix.columns,singleSubmatrix.columns);
+  }
+}
+
+TEST(NetworkAddition,rollbackRestoresCheckpoint){
+  //Interval columns on random rows, which are network, followed by random columns of which some are not
+  constexpr index_t NUM_ROWS = 25;
+  constexpr index_t NUM_COLUMNS = 120;
+  std::mt19937 generator(3);
+  SparseMatrix matrix;
+  matrix.setNumSecondary(NUM_ROWS);
+  for(index_t column = 0; column < NUM_COLUMNS; ++column){
+    index_t start = std::uniform_int_distribution<index_t>(0,NUM_ROWS - 2)(generator);
+    index_t end = std::uniform_int_distribution<index_t>(start + 1,std::min(NUM_ROWS,start + 8))(generator);
+    for(index_t row = start; row < end; ++row){
+      if(column < NUM_COLUMNS / 2 || row == start || generator() % 3 != 0){
+        matrix.appendNonzero(row,generator() % 2 == 0 ? -1.0 : 1.0);
+      }
+    }
+    matrix.finishPrimaryVector();
+  }
+
+  for(bool transposed : {false,true}){
+    NetworkAddition reference(NUM_ROWS,NUM_COLUMNS,Submatrix::INIT_NONE,transposed);
+    NetworkAddition addition(NUM_ROWS,NUM_COLUMNS,Submatrix::INIT_NONE,transposed);
+    for(index_t first = 0; first < NUM_COLUMNS; first += 10){
+      //Add every block of columns twice: the first attempt is rolled back, the second one is committed
+      for(bool keep : {false,true}){
+        addition.checkpoint();
+        for(index_t column = first; column < first + 10; ++column){
+          bool added = addition.tryAddCol(column,matrix.getPrimaryVector(column));
+          if(keep){
+            EXPECT_EQ(added,reference.tryAddCol(column,matrix.getPrimaryVector(column))) << column;
+          }
+        }
+        if(keep){
+          addition.commit();
+        }else{
+          addition.rollback();
+          for(index_t column = first; column < first + 10; ++column){
+            EXPECT_FALSE(addition.containsColumn(column));
+          }
+        }
+      }
+      auto statistics = addition.statistics();
+      auto referenceStatistics = reference.statistics();
+      EXPECT_EQ(statistics.numComponents,referenceStatistics.numComponents);
+      EXPECT_EQ(statistics.numSkeletonsTypeR,referenceStatistics.numSkeletonsTypeR);
+      EXPECT_EQ(statistics.numArcsTotalR,referenceStatistics.numArcsTotalR);
+    }
+    Submatrix referenceSubmatrix = reference.createSubmatrix(NUM_ROWS,NUM_COLUMNS);
+    Submatrix submatrix = addition.createSubmatrix(NUM_ROWS,NUM_COLUMNS);
+    EXPECT_EQ(submatrix.rows,referenceSubmatrix.rows);
+    EXPECT_EQ(submatrix.columns,referenceSubmatrix.columns);
+    EXPECT_LT(submatrix.columns.size(),NUM_COLUMNS);
+  }
+}
+
+TEST(NetworkAddition,pooledAndReservedMatchPlain){
+  constexpr index_t NUM_ROWS = 25;
+  constexpr index_t NUM_COLUMNS = 120;
+  std::mt19937 generator(5);
+  SparseMatrix matrix;
+  matrix.setNumSecondary(NUM_ROWS);
+  for(index_t column = 0; column < NUM_COLUMNS; ++column){
+    index_t start = std::uniform_int_distribution<index_t>(0,NUM_ROWS - 2)(generator);
+    index_t end = std::uniform_int_distribution<index_t>(start + 1,std::min(NUM_ROWS,start + 8))(generator);
+    for(index_t row = start; row < end; ++row){
+      if(row == start || generator() % 4 != 0){
+        matrix.appendNonzero(row,generator() % 2 == 0 ? -1.0 : 1.0);
+      }
+    }
+    matrix.finishPrimaryVector();
+  }
+
+  SPQREnvironmentPool pool;
+  for(bool transposed : {false,true}){
+    NetworkAddition reference(NUM_ROWS,NUM_COLUMNS,Submatrix::INIT_NONE,transposed);
+    for(index_t column = 0; column < NUM_COLUMNS; ++column){
+      reference.tryAddCol(column,matrix.getPrimaryVector(column));
+    }
+    Submatrix referenceSubmatrix = reference.createSubmatrix(NUM_ROWS,NUM_COLUMNS);
+    //Later rounds reuse the memory of the decompositions of earlier rounds
+    for(int round = 0; round < 3; ++round){
+      NetworkAddition addition(NUM_ROWS,NUM_COLUMNS,Submatrix::INIT_NONE,transposed,&pool);
+      addition.reserve(2,3);
+      for(index_t column = 0; column < NUM_COLUMNS; ++column){
+        if(column == NUM_COLUMNS / 2){
+          //Grows the decomposition while it already contains arcs
+          addition.reserve(NUM_ROWS,NUM_COLUMNS);
+        }
+        EXPECT_EQ(addition.tryAddCol(column,matrix.getPrimaryVector(column)),
+                  reference.containsColumn(column)) << column;
+      }
+      Submatrix submatrix = addition.createSubmatrix(NUM_ROWS,NUM_COLUMNS);
+      EXPECT_EQ(submatrix.rows,referenceSubmatrix.rows);
+      EXPECT_EQ(submatrix.columns,referenceSubmatrix.columns);
+    }
+    pool.releaseMemory();
+  }
+}
+
+TEST(NetworkAddition,realizationReproducesSubmatrix){
+  //Sparse random columns, of which only some can be added, so that the decomposition has members of all types
+  constexpr index_t NUM_ROWS = 30;
+  constexpr index_t NUM_COLUMNS = 150;
+  std::mt19937 generator(11);
+  SparseMatrix matrix;
+  matrix.setNumSecondary(NUM_ROWS);
+  std::vector<index_t> rows(NUM_ROWS);
+  for(index_t column = 0; column < NUM_COLUMNS; ++column){
+    std::iota(rows.begin(),rows.end(),0);
+    std::shuffle(rows.begin(),rows.end(),generator);
+    rows.resize(std::uniform_int_distribution<index_t>(1,4)(generator));
+    std::sort(rows.begin(),rows.end());
+    for(index_t row : rows){
+      matrix.appendNonzero(row,generator() % 2 == 0 ? -1.0 : 1.0);
+    }
+    matrix.finishPrimaryVector();
+    rows.resize(NUM_ROWS);
+  }
+  SparseMatrix rowMatrix = matrix.transposedFormat();
+
+  for(bool transposed : {false,true}){
+    NetworkAddition addition(NUM_ROWS,NUM_COLUMNS,Submatrix::INIT_NONE,transposed);
+    for(index_t column = 0; column < NUM_COLUMNS; ++column){
+      addition.tryAddCol(column,matrix.getPrimaryVector(column));
+    }
+    Submatrix submatrix = addition.createSubmatrix(NUM_ROWS,NUM_COLUMNS);
+    NetworkRealization realization = addition.createRealization(NUM_ROWS,NUM_COLUMNS);
+    ASSERT_EQ(realization.transposed,transposed);
+
+    //The tree arcs are the rows, or the columns if the realization is transposed
+    const auto& treeTails = transposed ? realization.columnTails : realization.rowTails;
+    const auto& treeHeads = transposed ? realization.columnHeads : realization.rowHeads;
+    const auto& pathTails = transposed ? realization.rowTails : realization.columnTails;
+    const auto& pathHeads = transposed ? realization.rowHeads : realization.columnHeads;
+    const auto& treeIndices = transposed ? submatrix.columns : submatrix.rows;
+    const auto& pathIndices = transposed ? submatrix.rows : submatrix.columns;
+    const SparseMatrix& pathMatrix = transposed ? rowMatrix : matrix;
+    for(index_t i = 0; i < treeTails.size(); ++i){
+      bool contained = std::find(treeIndices.begin(),treeIndices.end(),i) != treeIndices.end();
+      EXPECT_EQ(treeTails[i] != INVALID,contained);
+      EXPECT_EQ(treeHeads[i] != INVALID,contained);
+    }
+
+    //The tree arcs must form a forest
+    std::vector<std::vector<std::pair<index_t,index_t>>> neighbours(realization.numNodes); //node and tree arc
+    std::vector<index_t> representative(realization.numNodes);
+    std::iota(representative.begin(),representative.end(),0);
+    auto find = [&](index_t node){
+      while(representative[node] != node){
+        node = representative[node];
+      }
+      return node;
+    };
+    for(index_t tree : treeIndices){
+      ASSERT_LT(treeTails[tree],realization.numNodes);
+      ASSERT_LT(treeHeads[tree],realization.numNodes);
+      index_t tailRoot = find(treeTails[tree]);
+      index_t headRoot = find(treeHeads[tree]);
+      ASSERT_NE(tailRoot,headRoot) << tree;
+      representative[tailRoot] = headRoot;
+      neighbours[treeTails[tree]].emplace_back(treeHeads[tree],tree);
+      neighbours[treeHeads[tree]].emplace_back(treeTails[tree],tree);
+    }
+
+    for(index_t path : pathIndices){
+      //Find the path from the tail to the head of the arc in the forest by a depth-first search
+      std::vector<index_t> parentArc(realization.numNodes,INVALID);
+      std::vector<bool> visited(realization.numNodes,false);
+      std::vector<index_t> stack{pathTails[path]};
+      visited[pathTails[path]] = true;
+      while(!stack.empty()){
+        index_t node = stack.back();
+        stack.pop_back();
+        for(const auto& [other,tree] : neighbours[node]){
+          if(!visited[other]){
+            visited[other] = true;
+            parentArc[other] = tree;
+            stack.push_back(other);
+          }
+        }
+      }
+      ASSERT_TRUE(visited[pathHeads[path]]) << path;
+      std::vector<std::pair<index_t,double>> expected;
+      for(index_t node = pathHeads[path]; node != pathTails[path];){
+        index_t tree = parentArc[node];
+        bool forwards = treeHeads[tree] == node;
+        expected.emplace_back(tree,forwards ? 1.0 : -1.0);
+        node = forwards ? treeTails[tree] : treeHeads[tree];
+      }
+      std::sort(expected.begin(),expected.end());
+      std::vector<std::pair<index_t,double>> entries;
+      for(const auto& nonzero : pathMatrix.getPrimaryVector(path)){
+        if(treeTails[nonzero.index()] != INVALID){
+          entries.emplace_back(nonzero.index(),nonzero.value());
+        }
+      }
+      EXPECT_EQ(entries,expected) << path;
+    }
+  }
+}
+
+TEST(TUColumnSubmatrixFinder,timeLimitKeepsValidSubmatrix){
+  for(const auto& entry : std::filesystem::directory_iterator(MIPWORKSHOP2024_TEST_DATA_DIR)){
+    if(!entry.is_regular_file() || entry.path().extension() != ".mps"){
+      continue;
+    }
+    auto original = readMPSFile(entry.path());
+    if(!original.has_value()){
+      continue;
+    }
+    std::vector<std::size_t> numColumns;
+    for(double timeLimit : {std::numeric_limits<double>::infinity(),0.0}){
+      Problem problem = original.value();
+      TUColumnSubmatrixFinder finder(problem,TUSettings{
+          .doDowngrade = true,
+          .writeType = VariableType::CONTINUOUS,
+          .dynamic = false,
+          .timeLimit = timeLimit});
+      auto result = finder.computeTUSubmatrices();
+      EXPECT_EQ(finder.statistics().size(),4);
+      numColumns.push_back(result.empty() ? 0 : result.front().submatColumns.size());
+    }
+    //Every strategy stops early and keeps a part of the submatrix it would otherwise find
+    EXPECT_LE(numColumns[1],numColumns[0]) << entry.path();
+  }
+}